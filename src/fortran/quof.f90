@@ -47,6 +47,7 @@ module quo
       integer(c_int) QUO_OBJ_SOCKET
       integer(c_int) QUO_OBJ_CORE
       integer(c_int) QUO_OBJ_PU
+      integer(c_int) QUO_OBJ_L3CACHE
 
       parameter (QUO_OBJ_MACHINE = 0)
       parameter (QUO_OBJ_NUMANODE = 1)
@@ -54,15 +55,27 @@ module quo
       parameter (QUO_OBJ_SOCKET = 3)
       parameter (QUO_OBJ_CORE = 4)
       parameter (QUO_OBJ_PU = 5)
+      parameter (QUO_OBJ_L3CACHE = 6)
 
       !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       ! push policies
       !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       integer(c_int) QUO_BIND_PUSH_PROVIDED
       integer(c_int) QUO_BIND_PUSH_OBJ
+      integer(c_int) QUO_BIND_PUSH_CPUSET
 
       parameter (QUO_BIND_PUSH_PROVIDED = 0)
       parameter (QUO_BIND_PUSH_OBJ = 1)
+      parameter (QUO_BIND_PUSH_CPUSET = 2)
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      ! leader policies
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      integer(c_int) QUO_LEADER_LOWEST_QID
+      integer(c_int) QUO_LEADER_NIC_CLOSEST
+
+      parameter (QUO_LEADER_LOWEST_QID = 0)
+      parameter (QUO_LEADER_NIC_CLOSEST = 1)
 
       !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       ! context create flags
@@ -73,6 +86,15 @@ module quo
       parameter (QUO_CREATE_NO_FLAGS = 0)
       parameter (QUO_CREATE_NO_MT = 1)
 
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      ! auto distrib flags
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      integer(c_int) QUO_AUTO_DISTRIB_NO_FLAGS
+      integer(c_int) QUO_AUTO_DISTRIB_BIND_PUSH
+
+      parameter (QUO_AUTO_DISTRIB_NO_FLAGS = 0)
+      parameter (QUO_AUTO_DISTRIB_BIND_PUSH = 1)
+
 interface
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       integer(c_int) &
@@ -294,6 +316,30 @@ interface
       end function quo_bind_push_c
 end interface
 
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_bind_push_cpuset_c(q, cpuset) &
+          bind(c, name='QUO_bind_push_cpuset')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int, c_char
+          implicit none
+          type(c_ptr), value :: q
+          character(kind=c_char), dimension(*), intent(in) :: cpuset
+      end function quo_bind_push_cpuset_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_bind_push_split_c(q, nparts, part, granularity) &
+          bind(c, name='QUO_bind_push_split')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: nparts, part, granularity
+      end function quo_bind_push_split_c
+end interface
+
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 interface
       integer(c_int) &
@@ -316,6 +362,113 @@ interface
       end function quo_barrier_c
 end interface
 
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_quiesce_c(q, parking_pu) &
+          bind(c, name='QUO_quiesce')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: parking_pu
+      end function quo_quiesce_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_lend_c(q) &
+          bind(c, name='QUO_lend')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+      end function quo_lend_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_lend_reclaim_c(q) &
+          bind(c, name='QUO_lend_reclaim')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+      end function quo_lend_reclaim_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_borrow_c(q, within, max_lenders, out_nborrowed, &
+                            out_npus) &
+          bind(c, name='QUO_borrow')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: within
+          integer(c_int), value :: max_lenders
+          integer(c_int), intent(out) :: out_nborrowed
+          integer(c_int), intent(out) :: out_npus
+      end function quo_borrow_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_borrow_recalled_c(q, out_recalled) &
+          bind(c, name='QUO_borrow_recalled')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: out_recalled
+      end function quo_borrow_recalled_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_borrow_return_c(q) &
+          bind(c, name='QUO_borrow_return')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+      end function quo_borrow_return_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_barrier_arrive_c(q) &
+          bind(c, name='QUO_barrier_arrive')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+      end function quo_barrier_arrive_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_barrier_test_c(q, out_done) &
+          bind(c, name='QUO_barrier_test')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: out_done
+      end function quo_barrier_test_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_barrier_wait_c(q) &
+          bind(c, name='QUO_barrier_wait')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+      end function quo_barrier_wait_c
+end interface
+
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 interface
       integer(c_int) &
@@ -331,6 +484,60 @@ interface
       end function quo_auto_distrib_c
 end interface
 
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_auto_distrib_weighted_c(q, distrib_over_this, &
+                                           max_qids_per_res_type, &
+                                           weight, oselected) &
+          bind(c, name='QUO_auto_distrib_weighted')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int, c_double
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: distrib_over_this
+          integer(c_int), value :: max_qids_per_res_type
+          real(c_double), value :: weight
+          integer(c_int), intent(out) :: oselected
+      end function quo_auto_distrib_weighted_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_auto_distrib_assign_c(q, distrib_over_this, &
+                                         max_qids_per_res_type, &
+                                         flags, ores, oassign) &
+          bind(c, name='QUO_auto_distrib_assign')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: distrib_over_this
+          integer(c_int), value :: max_qids_per_res_type
+          integer(c_int), value :: flags
+          integer(c_int), intent(out) :: ores
+          integer(c_int), intent(out) :: oassign(*)
+      end function quo_auto_distrib_assign_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_global_place_c(q, distrib_over_this, &
+                                  max_qids_per_res_type, nworkers, &
+                                  flags, ores, oworker_id) &
+          bind(c, name='QUO_global_place')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: distrib_over_this
+          integer(c_int), value :: max_qids_per_res_type
+          integer(c_int), value :: nworkers
+          integer(c_int), value :: flags
+          integer(c_int), intent(out) :: ores
+          integer(c_int), intent(out) :: oworker_id
+      end function quo_global_place_c
+end interface
+
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 interface
       integer(c_int) &
@@ -344,6 +551,59 @@ interface
       end function quo_get_mpi_comm_by_type_c
 end interface
 
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_get_mpi_leader_comm_by_type_c(q, target_type, policy, &
+                                                 comm) &
+          bind(c, name='QUO_get_mpi_leader_comm_by_type_f2c')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: target_type, policy
+          integer(c_int), intent(out):: comm
+      end function quo_get_mpi_leader_comm_by_type_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_borrow_mpi_comm_by_type_c(q, target_type, comm) &
+          bind(c, name='QUO_borrow_mpi_comm_by_type_f2c')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: target_type
+          integer(c_int), intent(out):: comm
+      end function quo_borrow_mpi_comm_by_type_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_borrow_mpi_leader_comm_by_type_c(q, target_type, &
+                                                    policy, comm) &
+          bind(c, name='QUO_borrow_mpi_leader_comm_by_type_f2c')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: target_type, policy
+          integer(c_int), intent(out):: comm
+      end function quo_borrow_mpi_leader_comm_by_type_c
+end interface
+
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+interface
+      integer(c_int) &
+      function quo_return_mpi_comm_c(q, comm) &
+          bind(c, name='QUO_return_mpi_comm_f2c')
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(inout):: comm
+      end function quo_return_mpi_comm_c
+end interface
+
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 !interface
 !      integer(c_int) &
@@ -546,6 +806,28 @@ contains
           ierr = quo_bind_push_c(q, policy, obj_type, obj_index)
       end subroutine quo_bind_push
 
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      ! Fortran is case-insensitive, so quo_bind_push_cpuset would clash with
+      ! the QUO_BIND_PUSH_CPUSET policy constant.
+      subroutine quo_bind_push_cpuset_str(q, cpuset, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int, c_null_char
+          implicit none
+          type(c_ptr), value :: q
+          character(len=*), intent(in) :: cpuset
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_bind_push_cpuset_c(q, trim(cpuset) // c_null_char)
+      end subroutine quo_bind_push_cpuset_str
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_bind_push_split(q, nparts, part, granularity, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: nparts, part, granularity
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_bind_push_split_c(q, nparts, part, granularity)
+      end subroutine quo_bind_push_split
+
       !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       subroutine quo_bind_pop(q, ierr)
           use, intrinsic :: iso_c_binding, only: c_ptr, c_int
@@ -564,6 +846,98 @@ contains
           ierr = quo_barrier_c(q)
       end subroutine quo_barrier
 
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_quiesce(q, parking_pu, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(in) :: parking_pu
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_quiesce_c(q, parking_pu)
+      end subroutine quo_quiesce
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_lend(q, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_lend_c(q)
+      end subroutine quo_lend
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_lend_reclaim(q, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_lend_reclaim_c(q)
+      end subroutine quo_lend_reclaim
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_borrow(q, within, max_lenders, out_nborrowed, &
+                            out_npus, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: within
+          integer(c_int), value :: max_lenders
+          integer(c_int), intent(out) :: out_nborrowed
+          integer(c_int), intent(out) :: out_npus
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_borrow_c(q, within, max_lenders, out_nborrowed, &
+                              out_npus)
+      end subroutine quo_borrow
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_borrow_recalled(q, out_recalled, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          logical, intent(out) :: out_recalled
+          integer(c_int), intent(out) :: ierr
+          integer(c_int) :: irecalled
+          ierr = quo_borrow_recalled_c(q, irecalled)
+          out_recalled = (irecalled == 1)
+      end subroutine quo_borrow_recalled
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_borrow_return(q, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_borrow_return_c(q)
+      end subroutine quo_borrow_return
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_barrier_arrive(q, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_barrier_arrive_c(q)
+      end subroutine quo_barrier_arrive
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_barrier_test(q, out_done, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: out_done
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_barrier_test_c(q, out_done)
+      end subroutine quo_barrier_test
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_barrier_wait(q, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_barrier_wait_c(q)
+      end subroutine quo_barrier_wait
+
       !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       subroutine quo_auto_distrib(q, distrib_over_this, &
                                   max_qids_per_res_type, oselected, &
@@ -581,6 +955,63 @@ contains
           oselected = (iselected == 1)
       end subroutine quo_auto_distrib
 
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_auto_distrib_weighted(q, distrib_over_this, &
+                                           max_qids_per_res_type, &
+                                           weight, oselected, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int, c_double
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: distrib_over_this
+          integer(c_int), value :: max_qids_per_res_type
+          real(c_double), value :: weight
+          integer(c_int) :: iselected
+          logical, intent(out) :: oselected
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_auto_distrib_weighted_c(q, distrib_over_this, &
+                                             max_qids_per_res_type, &
+                                             weight, iselected)
+          oselected = (iselected == 1)
+      end subroutine quo_auto_distrib_weighted
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      ! oassign must be large enough to hold quo_nqids elements.
+      subroutine quo_auto_distrib_assign(q, distrib_over_this, &
+                                         max_qids_per_res_type, &
+                                         flags, ores, oassign, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: distrib_over_this
+          integer(c_int), value :: max_qids_per_res_type
+          integer(c_int), value :: flags
+          integer(c_int), intent(out) :: ores
+          integer(c_int), intent(out) :: oassign(*)
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_auto_distrib_assign_c(q, distrib_over_this, &
+                                           max_qids_per_res_type, &
+                                           flags, ores, oassign)
+      end subroutine quo_auto_distrib_assign
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_global_place(q, distrib_over_this, &
+                                  max_qids_per_res_type, nworkers, &
+                                  flags, ores, oworker_id, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: distrib_over_this
+          integer(c_int), value :: max_qids_per_res_type
+          integer(c_int), value :: nworkers
+          integer(c_int), value :: flags
+          integer(c_int), intent(out) :: ores
+          integer(c_int), intent(out) :: oworker_id
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_global_place_c(q, distrib_over_this, &
+                                    max_qids_per_res_type, nworkers, &
+                                    flags, ores, oworker_id)
+      end subroutine quo_global_place
+
       !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       subroutine quo_get_mpi_comm_by_type(q, target_type, comm, ierr)
           use, intrinsic :: iso_c_binding, only: c_ptr, c_int
@@ -592,6 +1023,53 @@ contains
           ierr = quo_get_mpi_comm_by_type_c(q, target_type, comm)
       end subroutine quo_get_mpi_comm_by_type
 
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_get_mpi_leader_comm_by_type(q, target_type, policy, &
+                                                 comm, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: target_type, policy
+          integer, intent(out) :: comm
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_get_mpi_leader_comm_by_type_c(q, target_type, policy, &
+                                                   comm)
+      end subroutine quo_get_mpi_leader_comm_by_type
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_borrow_mpi_comm_by_type(q, target_type, comm, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: target_type
+          integer, intent(out) :: comm
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_borrow_mpi_comm_by_type_c(q, target_type, comm)
+      end subroutine quo_borrow_mpi_comm_by_type
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_borrow_mpi_leader_comm_by_type(q, target_type, &
+                                                    policy, comm, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer(c_int), value :: target_type, policy
+          integer, intent(out) :: comm
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_borrow_mpi_leader_comm_by_type_c(q, target_type, &
+                                                      policy, comm)
+      end subroutine quo_borrow_mpi_leader_comm_by_type
+
+      !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      subroutine quo_return_mpi_comm(q, comm, ierr)
+          use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+          implicit none
+          type(c_ptr), value :: q
+          integer, intent(inout) :: comm
+          integer(c_int), intent(out) :: ierr
+          ierr = quo_return_mpi_comm_c(q, comm)
+      end subroutine quo_return_mpi_comm
+
       !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       !subroutine quo_bind_threads(q, type, index, ierr)
       !    use, intrinsic :: iso_c_binding, only: c_int
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-atomic.h Atomics used on data living in shared-memory segments.
+ */
+
+#ifndef QUO_ATOMIC_H_INCLUDED
+#define QUO_ATOMIC_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+#if defined(HAVE_LINUX_FUTEX_H) && defined(HAVE_SYS_SYSCALL_H)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define QUO_HAVE_FUTEX 1
+#endif
+#ifdef HAVE_SCHED_H
+#include <sched.h>
+#endif
+
+/* We use the __atomic builtins (GCC, Clang, and Intel all have them) instead
+ * of C11 atomics because the objects in question live in shared-memory
+ * segments that are mapped by different processes, and we don't want to force
+ * _Atomic types into structures that are also touched by plain memmove. */
+
+/** Cache line size used for padding shared structures. */
+#define QUO_CACHE_LINE_SIZE 64
+
+/** Rounds x up to the next multiple of a cache line. */
+#define QUO_CACHE_LINE_ROUNDUP(x)                                              \
+    ((((x) + QUO_CACHE_LINE_SIZE - 1) / QUO_CACHE_LINE_SIZE) *                 \
+     QUO_CACHE_LINE_SIZE)
+
+static inline uint64_t
+quo_atomic_load_u64(const uint64_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void
+quo_atomic_store_u64(uint64_t *p,
+                     uint64_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static inline uint64_t
+quo_atomic_fetch_add_u64(uint64_t *p,
+                         uint64_t v)
+{
+    return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+
+static inline uint32_t
+quo_atomic_load_u32(const uint32_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void
+quo_atomic_store_u32(uint32_t *p,
+                     uint32_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t
+quo_atomic_fetch_add_u32(uint32_t *p,
+                         uint32_t v)
+{
+    return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+
+static inline bool
+quo_atomic_cas_u32(uint32_t *p,
+                   uint32_t expected,
+                   uint32_t desired)
+{
+    return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline bool
+quo_atomic_cas_u64(uint64_t *p,
+                   uint64_t expected,
+                   uint64_t desired)
+{
+    return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline void
+quo_atomic_fence(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/** Tells the CPU that we are spinning. */
+static inline void
+quo_atomic_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __asm__ __volatile__("pause" ::: "memory");
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * Sleeps while *p is equal to expected (or until woken up, so callers must
+ * recheck). Without futexes, just yields the CPU. The futex operations are not
+ * the private ones because the word lives in memory that other processes map.
+ */
+static inline void
+quo_futex_wait(uint32_t *p,
+               uint32_t expected)
+{
+#ifdef QUO_HAVE_FUTEX
+    (void)syscall(SYS_futex, p, FUTEX_WAIT, expected, NULL, NULL, 0);
+#else
+    if (quo_atomic_load_u32(p) == expected) (void)sched_yield();
+#endif
+}
+
+/** Wakes up at most n processes sleeping on p. */
+static inline void
+quo_futex_wake(uint32_t *p,
+               int n)
+{
+#ifdef QUO_HAVE_FUTEX
+    (void)syscall(SYS_futex, p, FUTEX_WAKE, n, NULL, NULL, 0);
+#else
+    (void)p; (void)n;
+#endif
+}
+
+/** Wakes up everyone sleeping on p. */
+static inline void
+quo_futex_wake_all(uint32_t *p)
+{
+    quo_futex_wake(p, INT32_MAX);
+}
+
+#endif
@@ -16,9 +16,10 @@
 
 #include "quo.h"
 #include "quo-private.h"
-#include "quo-set.h"
+#include "quo-distrib.h"
+#include "quo-hwloc.h"
 #include "quo-mpi.h"
-#include "quo-sm.h"
+#include "quo-ctrl.h"
 
 #ifdef HAVE_STDLIB_H
 #include <stdlib.h>
@@ -33,8 +34,126 @@
 #include <string.h>
 #endif
 
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Frees resources returned by get_qids_in_target_type.
+ */
+static void
+free_qids_in_target_type(int *nranks_in_res,
+                         int **rank_ids_in_res)
+{
+    if (rank_ids_in_res) {
+        /* the table is a single flat allocation (see below) */
+        if (rank_ids_in_res[0]) free(rank_ids_in_res[0]);
+        free(rank_ids_in_res);
+    }
+    if (nranks_in_res) free(nranks_in_res);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
 /**
- * \note Caller is responsible for freeing returned resources.
+ * Returns my current binding as an array of unsigned longs. Bindings only
+ * change when the node binding epoch does, so reuse what we got last time if we
+ * can.
+ */
+static int
+get_my_masks(QUO_t *q,
+             int nulongs,
+             uint64_t epoch,
+             const unsigned long **out_masks)
+{
+    int rc = QUO_SUCCESS;
+    quo_auto_distrib_memo_t *memo = &q->ad_memo;
+    hwloc_cpuset_t cur_bind = NULL;
+
+    if (memo->my_masks_valid && epoch == memo->my_masks_epoch) {
+        *out_masks = memo->my_masks;
+        return QUO_SUCCESS;
+    }
+    memo->my_masks_valid = false;
+    if (!memo->my_masks) {
+        if (NULL == (memo->my_masks = calloc(nulongs, sizeof(unsigned long)))) {
+            QUO_OOR_COMPLAIN();
+            return QUO_ERR_OOR;
+        }
+    }
+    if (QUO_SUCCESS != (rc = quo_hwloc_get_cur_bind(q->hwloc, &cur_bind))) {
+        return rc;
+    }
+    (void)hwloc_bitmap_to_ulongs(cur_bind, (unsigned)nulongs, memo->my_masks);
+    hwloc_bitmap_free(cur_bind);
+    memo->my_masks_epoch = epoch;
+    memo->my_masks_valid = true;
+    *out_masks = memo->my_masks;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Collective routine that publishes every node process' binding to the node
+ * control region. Along with its binding, each process publishes the node
+ * binding epoch it observed, whether or not its cached result for these
+ * arguments is still valid, and its work weight. After the (single) barrier,
+ * everyone agrees on whether the cache can be used (*out_cache_hit) and on the
+ * newest epoch that anyone observed (*out_epoch). Callers that can't use the
+ * cache pass use_cache = false.
+ */
+static int
+xchange_bindings(QUO_t *q,
+                 QUO_obj_type_t target,
+                 int max_qids_per_res_type,
+                 bool use_cache,
+                 double weight,
+                 bool *out_cache_hit,
+                 uint64_t *out_epoch)
+{
+    int rc = QUO_SUCCESS, nulongs = 0;
+    const unsigned long *my_masks = NULL;
+    const quo_auto_distrib_memo_t *memo = &q->ad_memo;
+
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
+        return rc;
+    }
+    const uint64_t epoch = quo_ctrl_bind_epoch(q->ctrl);
+    const bool cache_valid = use_cache &&
+                             memo->valid &&
+                             (int)target == memo->type &&
+                             max_qids_per_res_type ==
+                                 memo->max_qids_per_res_type &&
+                             epoch == memo->epoch;
+    if (QUO_SUCCESS != (rc = get_my_masks(q, nulongs, epoch, &my_masks))) {
+        return rc;
+    }
+    rc = quo_ctrl_bind_publish(q->ctrl, epoch, cache_valid, weight, my_masks);
+    if (QUO_SUCCESS != rc) return rc;
+    /* This is the only synchronization that we need. It also prevents races
+     * between this call and others (e.g., QUO_bind_push() or QUO_bind_pop())
+     * that change binding, since everyone published after their changes. */
+    if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
+        QUO_ERR_MSGRC("quo_mpi_sm_barrier", rc);
+        return rc;
+    }
+    *out_cache_hit = true;
+    *out_epoch = 0;
+    for (int qid = 0; qid < q->nqid; ++qid) {
+        const quo_ctrl_bind_pub_t *pub = NULL;
+        if (QUO_SUCCESS != (rc = quo_ctrl_bind_published(q->ctrl, qid,
+                                                         &pub))) {
+            return rc;
+        }
+        if (!pub->cache_valid) *out_cache_hit = false;
+        if (pub->epoch > *out_epoch) *out_epoch = pub->epoch;
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Determines which node processes cover each target resource from the bindings
+ * published by xchange_bindings.
+ *
+ * \note Caller is responsible for freeing returned resources by calling
+ * free_qids_in_target_type.
  */
 static int
 get_qids_in_target_type(QUO_t *q,
@@ -52,183 +171,112 @@ get_qids_in_target_type(QUO_t *q,
 
     int *nranks_in_res = NULL;
     int **rank_ids_in_res = NULL;
-    int rc = QUO_ERR;
-    /* Communication structures. */
-    MPI_Comm node_comm;
-    /* Points to a unique (node-local) path name for inter-process affinity
-     * info. */
-    char *sm_seg_path = NULL;
-    quo_sm_t *smseg = NULL;
+    int rc = QUO_ERR, nulongs = 0;
+    hwloc_cpuset_t *cpusets = NULL;
 
-    /* Get node communicator so we can chat with our friends. */
-    if (QUO_SUCCESS != (rc = quo_mpi_get_node_comm(q->mpi, &node_comm))) {
-        QUO_ERR_MSGRC("quo_mpi_get_node_comm", rc);
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
         goto out;
     }
-    /* Generate and agree upon a unique (node-local) path name. */
-    if (QUO_SUCCESS != (rc = quo_mpi_xchange_uniq_path(q->mpi,
-                                                       "qaff",
-                                                       &sm_seg_path))) {
-        QUO_ERR_MSGRC("quo_mpi_xchange_uniq_path", rc);
-        goto out;
-    }
-    /* Build the shared-memory instance. */
-    if (QUO_SUCCESS != (rc = quo_sm_construct(&smseg))) {
-        QUO_ERR_MSGRC("quo_sm_construct", rc);
-        goto out;
-    }
-    /* Allocate some memory for our arrays. */
     nranks_in_res = calloc(n_target, sizeof(*nranks_in_res));
-    if (!nranks_in_res) {
+    rank_ids_in_res = calloc(n_target, sizeof(*rank_ids_in_res));
+    cpusets = calloc(q->nqid, sizeof(*cpusets));
+    if (!nranks_in_res || !rank_ids_in_res || !cpusets) {
         QUO_OOR_COMPLAIN();
         rc = QUO_ERR_OOR;
         goto out;
     }
-    /* Allocate pointer array. */
-    rank_ids_in_res = calloc(n_target, sizeof(*rank_ids_in_res));
-    if (!rank_ids_in_res) {
+    /* A resource is covered by at most every node process, so one flat
+     * n_target x nqid table is plenty. rank_ids_in_res[0] owns the memory. */
+    rank_ids_in_res[0] = calloc((size_t)n_target * q->nqid, sizeof(int));
+    if (!rank_ids_in_res[0]) {
         QUO_OOR_COMPLAIN();
         rc = QUO_ERR_OOR;
         goto out;
     }
-    /* Let one process query for QUO_qids_in_type info that will then be shared
-     * via shared-memory. */
-    if (0 == q->qid) {
-        /* Query for the smp ranks (node ranks) that cover each resource. */
-        for (int rid = 0; rid < n_target; ++rid) {
-            rc = QUO_qids_in_type(q, target, rid,
-                                  &(nranks_in_res[rid]),
-                                  &(rank_ids_in_res[rid]));
-            if (QUO_SUCCESS != rc) goto out;
-        }
-        /* Now that we have that info, now calculate how large of a
-         * shared-memory segment is needed (in bytes). */
-        int sm_seg_len = 0;
-        const int header_len = (n_target * sizeof(*nranks_in_res));
-        /* The first bit will be the "header" info. */
-        sm_seg_len += header_len;
-        /* The next bit will be dedicated to the rank_ids_in_res table. We have
-         * enough information in the header to reconstruct the table, which we
-         * are going to store as a flatten 1D array in the shared-memory
-         * segment. */
-        int num_entries = 0;
-        for (int i = 0; i < n_target; ++i) {
-            num_entries += nranks_in_res[i];
-        }
-        sm_seg_len += (num_entries * sizeof(*nranks_in_res));
-        /* Now that we know the size of the buffer, share that info. */
-        if (QUO_SUCCESS != (rc = quo_mpi_bcast(&sm_seg_len, 1,
-                                               MPI_INT, 0, node_comm))) {
-            QUO_ERR_MSGRC("quo_mpi_bcast", rc);
-            goto out;
-        }
-        /* Create the shared-memory segment. */
-        if (QUO_SUCCESS != (rc = quo_sm_segment_create(smseg,
-                                                       sm_seg_path,
-                                                       sm_seg_len))) {
-            QUO_ERR_MSGRC("quo_sm_segment_create", rc);
-            goto out;
-        }
-        /* Get base of the shared-memory segment (starting point for header). */
-        char *headerp = (char *)quo_sm_get_basep(smseg);
-        /* Fill in the header. */
-        (void)memmove(headerp, nranks_in_res, header_len);
-        /* Copy a flattened version of the rank_ids_in_res table into the
-         * shared-memory segment. Note that the tabular data starting point is
-         * offset by header_len bytes. */
-        char *tabp = (headerp + header_len);
-        for (int i = 0; i < n_target; ++i) {
-            const size_t nbytes = nranks_in_res[i] * sizeof(*nranks_in_res);
-            (void)memmove(tabp, rank_ids_in_res[i], nbytes);
-            tabp += nbytes;
-        }
-        /* Signal completion. */
-        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
-            QUO_ERR_MSGRC("quo_mpi_sm_barrier", rc);
-            goto out;
-        }
-        /* Wait for attach completion. */
-        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
-            QUO_ERR_MSGRC("quo_mpi_sm_barrier", rc);
-            goto out;
-        }
-        /* Cleanup after everyone is done. */
-        (void)quo_sm_unlink(smseg);
+    for (int rid = 1; rid < n_target; ++rid) {
+        rank_ids_in_res[rid] = rank_ids_in_res[0] + (size_t)rid * q->nqid;
     }
-    else {
-        int sm_seg_len = 0;
-        /* Get shared-memory segment size. */
-        if (QUO_SUCCESS != (rc = quo_mpi_bcast(&sm_seg_len, 1,
-                                               MPI_INT, 0, node_comm))) {
-            QUO_ERR_MSGRC("quo_mpi_bcast", rc);
+    for (int qid = 0; qid < q->nqid; ++qid) {
+        const quo_ctrl_bind_pub_t *pub = NULL;
+        if (QUO_SUCCESS != (rc = quo_ctrl_bind_published(q->ctrl, qid,
+                                                         &pub))) {
             goto out;
         }
-        /* Wait for the data to be published. */
-        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
-            QUO_ERR_MSGRC("quo_mpi_sm_barrier", rc);
-            goto out;
-        }
-        if (QUO_SUCCESS!= (rc = quo_sm_segment_attach(smseg,
-                                                      sm_seg_path,
-                                                      sm_seg_len))) {
-            QUO_ERR_MSGRC("quo_sm_segment_attach", rc);
-            goto out;
-        }
-        /* Signal attach attach completion. */
-        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
-            QUO_ERR_MSGRC("quo_mpi_sm_barrier", rc);
+        if (NULL == (cpusets[qid] = hwloc_bitmap_alloc())) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
             goto out;
         }
-        /* Reconstruct structures to pass to caller. */
-        /* Get base of the shared-memory segment (starting point for header). */
-        char *headerp = (char *)quo_sm_get_basep(smseg);
-        /* Get first bit of info from the header. */
-        const int header_len = (n_target * sizeof(*nranks_in_res));
-        (void)memmove(nranks_in_res, headerp, header_len);
-        /* Copy from a flattened version of the rank_ids_in_res table into the
-         * "real" 2D table that will be passed to the caller. */
-        char *tabp = (headerp + header_len);
-        for (int i = 0; i < n_target; ++i) {
-            const size_t nranks = nranks_in_res[i];
-            const size_t nbytes = nranks * sizeof(*nranks_in_res);
-            rank_ids_in_res[i] = calloc(nranks, sizeof(*nranks_in_res));
-            if (NULL == rank_ids_in_res[i]) {
-                QUO_OOR_COMPLAIN();
-                rc = QUO_ERR_OOR;
-                goto out;
+        (void)hwloc_bitmap_from_ulongs(cpusets[qid], (unsigned)nulongs,
+                                       pub->masks);
+    }
+    /* Same semantics as QUO_qids_in_type: a process covers a resource if its
+     * binding intersects the resource's cpuset. Walking QIDs in order keeps
+     * every list sorted. */
+    for (int rid = 0; rid < n_target; ++rid) {
+        hwloc_const_cpuset_t res_cpuset = NULL;
+        rc = quo_hwloc_get_obj_cpuset(q->hwloc, target, (unsigned)rid,
+                                      &res_cpuset);
+        if (QUO_SUCCESS != rc) goto out;
+        for (int qid = 0; qid < q->nqid; ++qid) {
+            if (hwloc_bitmap_intersects(cpusets[qid], res_cpuset)) {
+                rank_ids_in_res[rid][nranks_in_res[rid]++] = qid;
             }
-            /* Copy out. */
-            (void)memmove(rank_ids_in_res[i], tabp, nbytes);
-            tabp += nbytes;
         }
     }
 out:
     if (QUO_SUCCESS != rc) {
-        if (rank_ids_in_res) {
-            for (int i = 0; i < n_target; ++i) {
-                if (rank_ids_in_res[i]) free(rank_ids_in_res[i]);
-            }
-            free(rank_ids_in_res);
-        }
-        if (nranks_in_res) free(nranks_in_res);
+        free_qids_in_target_type(nranks_in_res, rank_ids_in_res);
     }
     else {
         *out_nranks_in_res = nranks_in_res;
         *out_rank_ids_in_res = rank_ids_in_res;
     }
     /* General cleanup. */
-    if (sm_seg_path) free(sm_seg_path);
-    (void)quo_sm_destruct(smseg);
+    if (cpusets) {
+        for (int qid = 0; qid < q->nqid; ++qid) {
+            if (cpusets[qid]) hwloc_bitmap_free(cpusets[qid]);
+        }
+        free(cpusets);
+    }
 
     return rc;
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
-int
-QUO_auto_distrib(QUO_t *q,
-                 QUO_obj_type_t distrib_over_this,
-                 int max_qids_per_res_type,
-                 int *out_selected)
+/**
+ * Gathers the weights published by xchange_bindings (indexed by QID).
+ */
+static int
+get_published_weights(QUO_t *q,
+                       double *weights)
+{
+    int rc = QUO_SUCCESS;
+
+    for (int qid = 0; qid < q->nqid; ++qid) {
+        const quo_ctrl_bind_pub_t *pub = NULL;
+        if (QUO_SUCCESS != (rc = quo_ctrl_bind_published(q->ctrl, qid,
+                                                         &pub))) {
+            return rc;
+        }
+        weights[qid] = pub->weight;
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Common QUO_auto_distrib* code. If weight is NULL, then the classic heuristic
+ * is used and results are memoized. Otherwise, weight is my work weight. On
+ * success, *out_assign points to the node-wide assignment table (owned by the
+ * context and valid until the next call).
+ */
+static int
+auto_distrib(QUO_t *q,
+             QUO_obj_type_t distrib_over_this,
+             int max_qids_per_res_type,
+             const double *weight,
+             const int **out_assign)
 {
     /* total number of target resources. */
     int nres = 0;
@@ -241,26 +289,14 @@ QUO_auto_distrib(QUO_t *q,
      */
     int **rank_ids_in_res = NULL;
     int rc = QUO_ERR;
-    /* my node (smp) rank */
-    int my_smp_rank = 0, nsmp_ranks = 0;
-    /* holds k set intersection info */
-    int *k_set_intersection = NULL, k_set_intersection_len = 0;
+    /* every node process' weight (weighted distribution only) */
+    double *weights = NULL;
+    /* whether or not we can use our cached result */
+    bool cache_hit = false;
+    /* newest node binding epoch observed by anyone */
+    uint64_t epoch = 0;
+    quo_auto_distrib_memo_t *memo = &q->ad_memo;
 
-    if (!q || !out_selected || max_qids_per_res_type <= 0) {
-        return QUO_ERR_INVLD_ARG;
-    }
-    QUO_NO_INIT_ACTION(q);
-    *out_selected = 0; /* set default */
-    /* First barrier to avoid race conditions between this call and others
-     * (e.g., QUO_bind_push() or QUO_bind_pop()) that change binding. */
-    if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
-        QUO_ERR_MSGRC("quo_mpi_sm_barrier", rc);
-        return rc;
-    }
-    /* get total number of processes that share a node with me (includes me). */
-    nsmp_ranks = q->nqid;
-    /* what is my node rank? */
-    my_smp_rank = q->qid;
     /* figure out how many target things are on the system. */
     if (QUO_SUCCESS != (rc = QUO_nobjs_by_type(q, distrib_over_this,
                                                &nres))) {
@@ -268,98 +304,155 @@ QUO_auto_distrib(QUO_t *q,
     }
     /* if there are no resources, then return not found */
     if (0 == nres) return QUO_ERR_NOT_FOUND;
-    /* Populate arrays with data required to perform the intersection
-     * calculation. */
+    if (!memo->assign) {
+        if (NULL == (memo->assign = calloc(q->nqid, sizeof(*memo->assign)))) {
+            QUO_OOR_COMPLAIN();
+            return QUO_ERR_OOR;
+        }
+    }
+    /* Share bindings. If nobody's binding changed since the last call with the
+     * same arguments, then the answer can't have changed either. Weights can
+     * change from call to call, so weighted results are never reused. */
+    rc = xchange_bindings(q, distrib_over_this, max_qids_per_res_type,
+                          NULL == weight, weight ? *weight : 0.0,
+                          &cache_hit, &epoch);
+    if (QUO_SUCCESS != rc) {
+        QUO_ERR_MSGRC("xchange_bindings", rc);
+        goto out;
+    }
+    if (cache_hit) {
+        *out_assign = memo->assign;
+        return QUO_SUCCESS;
+    }
+    /* a weighted call also invalidates the memo: it did not publish a valid
+     * vote, so nobody will trust theirs next time anyway. */
+    memo->valid = false;
+    /* Populate arrays with data required to perform the distribution. */
     if (QUO_SUCCESS != (rc = get_qids_in_target_type(q, distrib_over_this, nres,
                                                      &nranks_in_res,
                                                      &rank_ids_in_res))) {
         QUO_ERR_MSGRC("get_qids_in_target_type", rc);
         goto out;
     }
-    /* calculate the k set intersection of ranks on resources. the returned
-     * array will be the set of ranks that currently share a particular
-     * resource. */
-    rc = quo_set_get_k_set_intersection(nres, nranks_in_res,
-                                        rank_ids_in_res,
-                                        &k_set_intersection,
-                                        &k_set_intersection_len);
-    if (QUO_SUCCESS != rc) goto out;
     /* ////////////////////////////////////////////////////////////////////// */
-    /* distribute workers over target resources. */
+    /* distribute workers over target resources. every node process computes
+     * the same table from the same published data, so no more communication
+     * is necessary. */
     /* ////////////////////////////////////////////////////////////////////// */
-
-    /* !!! remember: always maintain "max workers per resource" invariant !!! */
-
-    /* completely disjoint sets, so making a local decision is easy */
-    if (0 == k_set_intersection_len) {
-        for (int rid = 0; rid < nres; ++rid) {
-            /* if already a member, stop search */
-            if (1 == *out_selected) break;
-            for (int rank = 0; rank < nranks_in_res[rid]; ++rank) {
-                /* if my current cpuset covers the resource in question and
-                 * someone won't be assigned to that particular resource */
-                if (my_smp_rank == rank_ids_in_res[rid][rank] &&
-                    rank < max_qids_per_res_type) {
-                    *out_selected = 1;
-                }
-            }
-        }
-    }
-    /* all processes overlap - really no hope of doing anything sane. we
-     * typically see this in the "no one is bound case." */
-    else if (nsmp_ranks == k_set_intersection_len) {
-        if (my_smp_rank < max_qids_per_res_type * nres) *out_selected = 1;
-    }
-    /* only a few ranks share a resource. i don't know if this case will ever
-     * happen in practice, but i've seen stranger things... in any case, favor
-     * unshared resources. */
-    else {
-        /* construct a "hash table" large enough to accommodate all possible
-         * values up to nnoderanks - 1. note: these arrays are typically small,
-         * so who cares. if this ever changes, then update the code to use a
-         * proper hash table. */
-        int *big_htab = NULL, rmapped = 0;
-        size_t bhts = nsmp_ranks * sizeof(*big_htab);
-        if (NULL == (big_htab = malloc(bhts))) {
+    if (weight) {
+        if (NULL == (weights = calloc(q->nqid, sizeof(*weights)))) {
             QUO_OOR_COMPLAIN();
             rc = QUO_ERR_OOR;
             goto out;
         }
-        /* -1 = spot not taken */
-        (void)memset(big_htab, -1, bhts);
-        /* populate the hash table */
-        for (int i = 0; i < k_set_intersection_len; ++i) {
-            big_htab[k_set_intersection[i]] = k_set_intersection[i];
-        }
-        /* first only consider ranks that aren't sharing resources */
-        for (int rid = 0; rid < nres; ++rid) {
-            /* if already a member, stop search */
-            if (1 == *out_selected) break;
-            rmapped = 0;
-            for (int rank = 0; rank < nranks_in_res[rid]; ++rank) {
-                /* this thing is shared - skip */
-                if (-1 != big_htab[rank_ids_in_res[rid][rank]]) continue;
-                /* if my current cpuset covers the resource in question */
-                if (my_smp_rank == rank_ids_in_res[rid][rank] &&
-                    rmapped < max_qids_per_res_type) {
-                        *out_selected = 1;
-                        break;
-                }
-                ++rmapped;
-            }
-        }
-        if (big_htab) free(big_htab);
+        if (QUO_SUCCESS != (rc = get_published_weights(q, weights))) goto out;
+        rc = quo_distrib_assign_weighted(nres, q->nqid, nranks_in_res,
+                                         rank_ids_in_res, max_qids_per_res_type,
+                                         weights, memo->assign);
+    }
+    else {
+        rc = quo_distrib_assign(nres, q->nqid, nranks_in_res, rank_ids_in_res,
+                                max_qids_per_res_type, memo->assign);
+    }
+    if (QUO_SUCCESS != rc) goto out;
+    *out_assign = memo->assign;
+    /* remember the answer */
+    if (!weight) {
+        memo->type = (int)distrib_over_this;
+        memo->max_qids_per_res_type = max_qids_per_res_type;
+        memo->epoch = epoch;
+        memo->valid = true;
     }
 out:
     /* the resources returned by get_qids_in_target_type must be freed by us */
-    if (rank_ids_in_res) {
-        for (int i = 0; i < nres; ++i) {
-            if (rank_ids_in_res[i]) free(rank_ids_in_res[i]);
-        }
-        free(rank_ids_in_res);
-    }
-    if (nranks_in_res) free(nranks_in_res);
-    if (k_set_intersection) free(k_set_intersection);
+    free_qids_in_target_type(nranks_in_res, rank_ids_in_res);
+    if (weights) free(weights);
 
     return rc;
 }
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_auto_distrib(QUO_t *q,
+                 QUO_obj_type_t distrib_over_this,
+                 int max_qids_per_res_type,
+                 int *out_selected)
+{
+    int rc = QUO_ERR;
+    const int *assign = NULL;
+
+    if (!q || !out_selected || max_qids_per_res_type <= 0) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    QUO_NO_INIT_ACTION(q);
+    *out_selected = 0; /* set default */
+    rc = auto_distrib(q, distrib_over_this, max_qids_per_res_type, NULL,
+                      &assign);
+    if (QUO_SUCCESS != rc) return rc;
+    *out_selected = (-1 != assign[q->qid]);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_auto_distrib_weighted(QUO_t *q,
+                          QUO_obj_type_t distrib_over_this,
+                          int max_qids_per_res_type,
+                          double weight,
+                          int *out_selected)
+{
+    int rc = QUO_ERR;
+    const int *assign = NULL;
+
+    if (!q || !out_selected || max_qids_per_res_type <= 0) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    /* bad weights are caught by everyone in quo_distrib_assign_weighted, so
+     * this doesn't leave anyone stuck in the exchange. */
+    QUO_NO_INIT_ACTION(q);
+    *out_selected = 0; /* set default */
+    rc = auto_distrib(q, distrib_over_this, max_qids_per_res_type, &weight,
+                      &assign);
+    if (QUO_SUCCESS != rc) return rc;
+    *out_selected = (-1 != assign[q->qid]);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_auto_distrib_assign(QUO_t *q,
+                        QUO_obj_type_t distrib_over_this,
+                        int max_qids_per_res_type,
+                        int flags,
+                        int *out_res,
+                        int *out_assign)
+{
+    int rc = QUO_ERR;
+    const int *assign = NULL;
+
+    if (!q || !out_res || max_qids_per_res_type <= 0) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    if (0 != (flags & ~QUO_AUTO_DISTRIB_BIND_PUSH)) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *out_res = -1; /* set default */
+    rc = auto_distrib(q, distrib_over_this, max_qids_per_res_type, NULL,
+                      &assign);
+    if (QUO_SUCCESS != rc) return rc;
+    if (out_assign) {
+        (void)memmove(out_assign, assign, q->nqid * sizeof(*out_assign));
+    }
+    /* bind to exactly the resource that the table says, so that selection and
+     * binding can't disagree. */
+    if ((flags & QUO_AUTO_DISTRIB_BIND_PUSH) && -1 != assign[q->qid]) {
+        hwloc_const_cpuset_t res_cpuset = NULL;
+        rc = quo_hwloc_get_obj_cpuset(q->hwloc, distrib_over_this,
+                                      (unsigned)assign[q->qid], &res_cpuset);
+        if (QUO_SUCCESS != rc) return rc;
+        if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
+        rc = quo_hwloc_bind_push_cpuset(q->hwloc, res_cpuset);
+        if (QUO_SUCCESS != rc) return rc;
+    }
+    *out_res = assign[q->qid];
+    return QUO_SUCCESS;
+}
@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-coll.c Node-local collectives over shared memory.
+ */
+
+/* The collectives segment is created the first time that a node collective is
+ * called. It starts with a data flag, a release flag, and one arrival flag per
+ * node process (each on its own cache line), followed by two data buffers per
+ * node process. Every collective operation works on chunks that fit in a
+ * buffer, and every chunk is a round: arrivals are combined up a
+ * QUO_COLL_ARITY-ary tree rooted at the operation's root, and then the root
+ * releases everyone. Buffers alternate between rounds, so a process can fill
+ * its buffer for round r + 1 while others still read round r. Nobody can get to
+ * round r + 2 before everyone has arrived at round r + 1, and so is done with
+ * round r. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo-coll.h"
+#include "quo-atomic.h"
+#include "quo-mpi.h"
+#include "quo-sm.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_SCHED_H
+#include <sched.h>
+#endif
+
+/** Fan-in of the collective tree. */
+#define QUO_COLL_ARITY 4
+/** Size of a data buffer in bytes. */
+#define QUO_COLL_BUF_SIZE 4096
+/** Number of times we spin before yielding the CPU while waiting on a flag. */
+#define QUO_COLL_SPINS 4096
+
+/** Round flag. Every flag has a cache line to itself. */
+typedef struct quo_coll_flag_t {
+    /** Last round that the flag's owner signaled. */
+    uint64_t round;
+} quo_coll_flag_t;
+
+/** Collectives instance. */
+struct quo_coll_t {
+    /** Shared-memory instance backing the segment. */
+    quo_sm_t *sm;
+    /** Whether or not sm is mapped. */
+    bool mapped;
+    /** My node ID. */
+    int qid;
+    /** Number of node processes. */
+    int nqid;
+    /** Number of times we spin on a flag before yielding. */
+    int spins;
+    /** Base of the mapped segment. */
+    char *basep;
+    /** Round number. Collective, so the same everywhere. */
+    uint64_t round;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns qid's arrival flag. qid -1 is the release flag and -2 the data flag
+ * (broadcast data is ready).
+ */
+static quo_coll_flag_t *
+get_flag(const quo_coll_t *coll,
+         int qid)
+{
+    return (quo_coll_flag_t *)(coll->basep +
+                               (size_t)(qid + 2) * QUO_CACHE_LINE_SIZE);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns qid's data buffer for the given round.
+ */
+static void *
+get_buf(const quo_coll_t *coll,
+        int qid,
+        uint64_t round)
+{
+    return coll->basep + (size_t)(coll->nqid + 2) * QUO_CACHE_LINE_SIZE +
+           ((size_t)qid * 2 + (round & 1)) * QUO_COLL_BUF_SIZE;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static size_t
+datatype_size(QUO_datatype_t datatype)
+{
+    switch (datatype) {
+        case QUO_INT: return sizeof(int);
+        case QUO_LONG: return sizeof(long);
+        case QUO_UNSIGNED_LONG: return sizeof(unsigned long);
+        case QUO_INT64: return sizeof(int64_t);
+        case QUO_UINT64: return sizeof(uint64_t);
+        case QUO_FLOAT: return sizeof(float);
+        case QUO_DOUBLE: return sizeof(double);
+        default: return 0;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+#define QUO_COLL_COMBINE(type, op, inout, in, n)                               \
+do {                                                                           \
+    type *io_ = (type *)(inout);                                               \
+    const type *i_ = (const type *)(in);                                       \
+    switch (op) {                                                              \
+        case QUO_SUM:                                                          \
+            for (int k_ = 0; k_ < (n); ++k_) io_[k_] += i_[k_];                \
+            break;                                                             \
+        case QUO_PROD:                                                         \
+            for (int k_ = 0; k_ < (n); ++k_) io_[k_] *= i_[k_];                \
+            break;                                                             \
+        case QUO_MIN:                                                          \
+            for (int k_ = 0; k_ < (n); ++k_) {                                 \
+                if (i_[k_] < io_[k_]) io_[k_] = i_[k_];                        \
+            }                                                                  \
+            break;                                                             \
+        case QUO_MAX:                                                          \
+            for (int k_ = 0; k_ < (n); ++k_) {                                 \
+                if (i_[k_] > io_[k_]) io_[k_] = i_[k_];                        \
+            }                                                                  \
+            break;                                                             \
+        default:                                                               \
+            break;                                                             \
+    }                                                                          \
+} while (0)
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * inout[i] = inout[i] op in[i] for n elements.
+ */
+static void
+combine(void *inout,
+        const void *in,
+        int n,
+        QUO_datatype_t datatype,
+        QUO_op_t op)
+{
+    switch (datatype) {
+        case QUO_INT:
+            QUO_COLL_COMBINE(int, op, inout, in, n);
+            break;
+        case QUO_LONG:
+            QUO_COLL_COMBINE(long, op, inout, in, n);
+            break;
+        case QUO_UNSIGNED_LONG:
+            QUO_COLL_COMBINE(unsigned long, op, inout, in, n);
+            break;
+        case QUO_INT64:
+            QUO_COLL_COMBINE(int64_t, op, inout, in, n);
+            break;
+        case QUO_UINT64:
+            QUO_COLL_COMBINE(uint64_t, op, inout, in, n);
+            break;
+        case QUO_FLOAT:
+            QUO_COLL_COMBINE(float, op, inout, in, n);
+            break;
+        case QUO_DOUBLE:
+            QUO_COLL_COMBINE(double, op, inout, in, n);
+            break;
+        default:
+            break;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Waits until flag reaches round.
+ */
+static void
+wait_for(const quo_coll_t *coll,
+         const quo_coll_flag_t *flag,
+         uint64_t round)
+{
+    int spins = 0;
+    while (quo_atomic_load_u64(&flag->round) < round) {
+        if (spins < coll->spins) {
+            quo_atomic_cpu_relax();
+            spins++;
+        }
+        else {
+            (void)sched_yield();
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/** Maps a QID to its position in a tree rooted at root and back. */
+static int
+to_vid(const quo_coll_t *coll,
+       int qid,
+       int root)
+{
+    return (qid - root + coll->nqid) % coll->nqid;
+}
+
+static int
+to_qid(const quo_coll_t *coll,
+       int vid,
+       int root)
+{
+    return (vid + root) % coll->nqid;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Waits for all my children in the tree rooted at root to signal round and, if
+ * reducing, combines their buffers into mine. Then signals my parent (unless I
+ * am the root).
+ */
+static void
+fan_in(const quo_coll_t *coll,
+       int root,
+       uint64_t round,
+       bool reduce,
+       int n,
+       QUO_datatype_t datatype,
+       QUO_op_t op)
+{
+    const int vid = to_vid(coll, coll->qid, root);
+    for (int c = 1; c <= QUO_COLL_ARITY; ++c) {
+        const int cvid = vid * QUO_COLL_ARITY + c;
+        if (cvid >= coll->nqid) break;
+        const int cqid = to_qid(coll, cvid, root);
+        wait_for(coll, get_flag(coll, cqid), round);
+        if (reduce) {
+            combine(get_buf(coll, coll->qid, round),
+                    get_buf(coll, cqid, round), n, datatype, op);
+        }
+    }
+    if (0 != vid) {
+        quo_atomic_store_u64(&get_flag(coll, coll->qid)->round, round);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_coll_construct(quo_coll_t **ncoll)
+{
+    int rc = QUO_SUCCESS;
+    quo_coll_t *coll = NULL;
+
+    if (!ncoll) return QUO_ERR_INVLD_ARG;
+    if (NULL == (coll = calloc(1, sizeof(*coll)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = quo_sm_construct(&coll->sm))) {
+        QUO_ERR_MSGRC("quo_sm_construct", rc);
+        free(coll);
+        return rc;
+    }
+    *ncoll = coll;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Creates and maps the collectives segment. Collective over the node. If
+ * oversubscribed, waiters yield right away instead of spinning.
+ */
+int
+quo_coll_init(quo_coll_t *coll,
+              quo_mpi_t *mpi,
+              bool oversubscribed)
+{
+    int rc = QUO_SUCCESS;
+    char *seg_path = NULL;
+
+    if (!coll || !mpi) return QUO_ERR_INVLD_ARG;
+
+    if (QUO_SUCCESS != (rc = quo_mpi_noderank(mpi, &coll->qid))) goto out;
+    if (QUO_SUCCESS != (rc = quo_mpi_nnoderanks(mpi, &coll->nqid))) goto out;
+    coll->spins = oversubscribed ? 0 : QUO_COLL_SPINS;
+    const size_t seg_size = (size_t)(coll->nqid + 2) * QUO_CACHE_LINE_SIZE +
+                            (size_t)coll->nqid * 2 * QUO_COLL_BUF_SIZE;
+    /* Generate and agree upon a unique (node-local) path name. */
+    if (QUO_SUCCESS != (rc = quo_mpi_xchange_uniq_path(mpi, "coll",
+                                                       &seg_path))) {
+        QUO_ERR_MSGRC("quo_mpi_xchange_uniq_path", rc);
+        goto out;
+    }
+    if (0 == coll->qid) {
+        /* ftruncate zero-fills, so all flags start out at round 0. */
+        rc = quo_sm_segment_create(coll->sm, seg_path, seg_size);
+        if (QUO_SUCCESS != rc) {
+            QUO_ERR_MSGRC("quo_sm_segment_create", rc);
+            goto out;
+        }
+        coll->mapped = true;
+        /* Signal completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        /* Wait for attach completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        /* Cleanup after everyone is done. */
+        (void)quo_sm_unlink(coll->sm);
+    }
+    else {
+        /* Wait for the segment to be created. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        rc = quo_sm_segment_attach(coll->sm, seg_path, seg_size);
+        if (QUO_SUCCESS != rc) {
+            QUO_ERR_MSGRC("quo_sm_segment_attach", rc);
+            goto out;
+        }
+        coll->mapped = true;
+        /* Signal attach completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+    }
+    coll->basep = quo_sm_get_basep(coll->sm);
+out:
+    if (seg_path) free(seg_path);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+bool
+quo_coll_initialized(const quo_coll_t *coll)
+{
+    return coll && coll->basep;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_coll_destruct(quo_coll_t *coll)
+{
+    if (!coll) return QUO_ERR_INVLD_ARG;
+    /* quo_sm_destruct unmaps, so only call it when there is a mapping. */
+    if (coll->mapped) {
+        (void)quo_sm_destruct(coll->sm);
+    }
+    else {
+        free(coll->sm);
+    }
+    free(coll);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Broadcasts count elements from root's buffer. The root publishes every chunk
+ * through the data flag; readers signal up the tree once they have it.
+ */
+int
+quo_coll_bcast(quo_coll_t *coll,
+               void *buffer,
+               int count,
+               QUO_datatype_t datatype,
+               int root)
+{
+    const size_t esize = datatype_size(datatype);
+
+    if (!coll || (!buffer && count > 0) || count < 0 || 0 == esize ||
+        root < 0 || root >= coll->nqid) return QUO_ERR_INVLD_ARG;
+
+    if (1 == coll->nqid) return QUO_SUCCESS;
+    const int chunk = (int)(QUO_COLL_BUF_SIZE / esize);
+    for (int off = 0; off < count; off += chunk) {
+        const int n = (count - off < chunk) ? count - off : chunk;
+        char *data = (char *)buffer + (size_t)off * esize;
+        const uint64_t round = ++coll->round;
+        if (root == coll->qid) {
+            (void)memmove(get_buf(coll, root, round), data, n * esize);
+            quo_atomic_store_u64(&get_flag(coll, -2)->round, round);
+        }
+        else {
+            wait_for(coll, get_flag(coll, -2), round);
+            (void)memmove(data, get_buf(coll, root, round), n * esize);
+        }
+        fan_in(coll, root, round, false, 0, datatype, QUO_SUM);
+        if (root == coll->qid) {
+            quo_atomic_store_u64(&get_flag(coll, -1)->round, round);
+        }
+        else {
+            wait_for(coll, get_flag(coll, -1), round);
+        }
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Reduces count elements to root (to everyone if all is true). Every chunk is
+ * combined up the tree in the processes' buffers and root releases everyone
+ * once its buffer holds the result.
+ */
+int
+quo_coll_reduce(quo_coll_t *coll,
+                const void *sendbuf,
+                void *recvbuf,
+                int count,
+                QUO_datatype_t datatype,
+                QUO_op_t op,
+                int root,
+                bool all)
+{
+    const size_t esize = datatype_size(datatype);
+
+    if (!coll || count < 0 || 0 == esize || root < 0 || root >= coll->nqid ||
+        op < QUO_SUM || op > QUO_MAX) return QUO_ERR_INVLD_ARG;
+    if (count > 0 && !sendbuf) return QUO_ERR_INVLD_ARG;
+    if (count > 0 && !recvbuf && (all || root == coll->qid)) {
+        return QUO_ERR_INVLD_ARG;
+    }
+
+    /* nobody to talk to */
+    if (1 == coll->nqid) {
+        if (count > 0) (void)memmove(recvbuf, sendbuf, count * esize);
+        return QUO_SUCCESS;
+    }
+    const int chunk = (int)(QUO_COLL_BUF_SIZE / esize);
+    for (int off = 0; off < count; off += chunk) {
+        const int n = (count - off < chunk) ? count - off : chunk;
+        const size_t boff = (size_t)off * esize;
+        const uint64_t round = ++coll->round;
+        void *mybuf = get_buf(coll, coll->qid, round);
+        (void)memmove(mybuf, (const char *)sendbuf + boff, n * esize);
+        fan_in(coll, root, round, true, n, datatype, op);
+        if (root == coll->qid) {
+            (void)memmove((char *)recvbuf + boff, mybuf, n * esize);
+            quo_atomic_store_u64(&get_flag(coll, -1)->round, round);
+        }
+        else {
+            /* even if I don't need the result, my parent may still be
+             * reading my buffer: wait until it's done */
+            wait_for(coll, get_flag(coll, -1), round);
+            if (all) {
+                (void)memmove((char *)recvbuf + boff,
+                              get_buf(coll, root, round), n * esize);
+            }
+        }
+    }
+    return QUO_SUCCESS;
+}
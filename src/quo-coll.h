@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-coll.h
+ */
+
+#ifndef QUO_COLL_H_INCLUDED
+#define QUO_COLL_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo-private.h"
+#include "quo.h"
+
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+
+int
+quo_coll_construct(quo_coll_t **ncoll);
+
+int
+quo_coll_init(quo_coll_t *coll,
+              quo_mpi_t *mpi,
+              bool oversubscribed);
+
+bool
+quo_coll_initialized(const quo_coll_t *coll);
+
+int
+quo_coll_destruct(quo_coll_t *coll);
+
+int
+quo_coll_bcast(quo_coll_t *coll,
+               void *buffer,
+               int count,
+               QUO_datatype_t datatype,
+               int root);
+
+int
+quo_coll_reduce(quo_coll_t *coll,
+                const void *sendbuf,
+                void *recvbuf,
+                int count,
+                QUO_datatype_t datatype,
+                QUO_op_t op,
+                int root,
+                bool all);
+
+#endif
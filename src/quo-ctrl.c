@@ -0,0 +1,1332 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-ctrl.c Persistent node-wide control region.
+ */
+
+/* The control region is a shared-memory segment that is created once per
+ * context (in QUO_create) and stays mapped until QUO_free. It starts with a
+ * header, followed by synchronization state, each piece on its own cache
+ * line: the quiescent and split-phase barriers, the tree barrier's flags (a
+ * release flag and one arrival flag per node process), every node process'
+ * subset barriers (a failure record and QUO_CTRL_SUBSETS_PER_QID barriers), and
+ * QUO_CTRL_NOBJS synchronization objects (see quo_ctrl_obj_alloc). Then comes
+ * one cache-line-aligned slot per node process. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo-ctrl.h"
+#include "quo-atomic.h"
+#include "quo-mpi.h"
+#include "quo-sm.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_SCHED_H
+#include <sched.h>
+#endif
+
+/** Fan-in of the barrier tree. */
+#define QUO_CTRL_BARRIER_ARITY 4
+/** Number of times we spin before yielding the CPU while waiting on a flag. */
+#define QUO_CTRL_BARRIER_SPINS 4096
+/** Number of subset barriers that a node process can lead at once. */
+#define QUO_CTRL_SUBSETS_PER_QID 8
+/** Number of synchronization objects (one cache line each). */
+#define QUO_CTRL_NOBJS 256
+
+/** Control region header. */
+typedef struct quo_ctrl_header_t {
+    /** Number of node processes the region was sized for. */
+    int nqid;
+    /** Number of unsigned longs in every cpuset mask. */
+    int nulongs;
+    /** Node-wide binding epoch. Bumped by every binding change. */
+    uint64_t bind_epoch;
+} quo_ctrl_header_t;
+
+/**
+ * Per-process slot. Followed by the cpuset that the process lends (see
+ * quo_ctrl_lend) and two binding publication buffers.
+ */
+typedef struct quo_ctrl_slot_t {
+    /** Rebind request sequence number. Odd while a request is being written. */
+    uint64_t rebind_seq;
+    /** Lending state: a QUO_CTRL_LEND_* value in the low bits, and a lending
+     * generation in the rest. The lender sleeps on it while reclaiming. */
+    uint32_t lend_state;
+    /** Requested cpuset (nulongs long). */
+    unsigned long rebind_masks[];
+} quo_ctrl_slot_t;
+
+/** Lending states. */
+enum {
+    /** Nothing lent. */
+    QUO_CTRL_LEND_NONE = 0,
+    /** Lent, but nobody borrowed it yet. */
+    QUO_CTRL_LEND_AVAILABLE,
+    /** Borrowed. */
+    QUO_CTRL_LEND_BORROWED,
+    /** Borrowed, and the lender wants it back. */
+    QUO_CTRL_LEND_RECALLED
+};
+
+/** Lending state bits that hold a QUO_CTRL_LEND_* value. */
+#define QUO_CTRL_LEND_STATE_MASK 3u
+
+/** Tree barrier flag. Every flag has a cache line to itself. */
+typedef struct quo_ctrl_barrier_flag_t {
+    /** Last barrier epoch that the flag's owner signaled. */
+    uint64_t epoch;
+    /** The owner's barrier group. Only used during setup. */
+    int64_t group;
+} quo_ctrl_barrier_flag_t;
+
+/** Quiescent barrier state (see quo_ctrl_quiesce). */
+typedef struct quo_ctrl_quiesce_t {
+    /** Number of processes that arrived in the current round. */
+    uint32_t narrived;
+    /** Round number. Waiters sleep on it. */
+    uint32_t seq;
+} quo_ctrl_quiesce_t;
+
+/**
+ * Counting barrier state, used by the split-phase and subset barriers. Counters
+ * only grow, so there is nothing to reset between phases.
+ */
+typedef struct quo_ctrl_counter_barrier_t {
+    /** Total number of arrivals. */
+    uint64_t narrived;
+    /** Last completed phase (truncated). Waiters sleep on it. */
+    uint32_t phase;
+    /** Number of processes sleeping on phase. */
+    uint32_t nsleepers;
+} quo_ctrl_counter_barrier_t;
+
+/**
+ * Subset barrier. Owned by its leader (lowest member QID), which publishes it
+ * seqlock style: gen is zero while the other fields are being written.
+ */
+typedef struct quo_ctrl_subset_line_t {
+    /** The barrier. Keeps counting across owners. */
+    quo_ctrl_counter_barrier_t cb;
+    /** Generation (unique per leader), or 0 if not published. */
+    uint64_t gen;
+    /** Hash of the member list. */
+    uint64_t key;
+    /** Number of members. */
+    uint64_t nmembers;
+    /** cb.narrived when this generation was published. */
+    uint64_t base;
+    /** cb.phase when this generation was published. */
+    uint64_t pbase;
+} quo_ctrl_subset_line_t;
+
+/** Number of cache lines that every node process' subset barriers take. */
+#define QUO_CTRL_SUBSET_NLINES (1 + QUO_CTRL_SUBSETS_PER_QID)
+
+/** Number of cache lines between the header and the first slot. */
+#define QUO_CTRL_NSYNC_LINES(nqid)                                             \
+    ((nqid) + 3 + (nqid) * QUO_CTRL_SUBSET_NLINES + QUO_CTRL_NOBJS)
+
+/** A subset that I joined. */
+typedef struct quo_ctrl_subset_seen_t {
+    /** Leader QID. */
+    int leader;
+    /** Hash of the member list. */
+    uint64_t key;
+    /** Last generation that I joined (or failed to). */
+    uint64_t gen;
+    /** Number of live subsets with this leader and key that I'm in. */
+    int nlive;
+} quo_ctrl_subset_seen_t;
+
+/** Rounds x up to the next multiple of 8 (so 64-bit fields stay aligned). */
+#define QUO_CTRL_ROUNDUP8(x) ((((x) + 7) / 8) * 8)
+
+/** Control region instance. */
+struct quo_ctrl_t {
+    /** Shared-memory instance backing the region. */
+    quo_sm_t *sm;
+    /** Whether or not sm is mapped. */
+    bool mapped;
+    /** My node ID. */
+    int qid;
+    /** Number of node processes. */
+    int nqid;
+    /** Number of unsigned longs in every cpuset mask. */
+    int nulongs;
+    /** Size of a slot in bytes (a multiple of the cache line size). */
+    size_t slot_size;
+    /** Offset of the lent cpuset in a slot. */
+    size_t lend_off;
+    /** Offset of the first publication buffer in a slot. */
+    size_t pub_off;
+    /** Size of a publication buffer in bytes. */
+    size_t pub_size;
+    /** Base of the mapped region. */
+    char *basep;
+    /** Last rebind sequence number that I consumed. */
+    uint64_t rebind_seen;
+    /** Binding publication generation. Collective, so the same everywhere. */
+    uint64_t bind_gen;
+    /** Barrier epoch. Collective, so the same everywhere. */
+    uint64_t bar_epoch;
+    /** My parent in the barrier tree (-1 if I am the root). */
+    int bar_parent;
+    /** Number of my children in the barrier tree. */
+    int bar_nchildren;
+    /** My children in the barrier tree. */
+    int *bar_children;
+    /** Number of times we spin on a shared flag before yielding or sleeping. */
+    int bar_spins;
+    /** Last split-phase barrier phase that I arrived at. */
+    uint64_t sp_phase;
+    /** Whether or not I arrived at sp_phase but didn't see it complete yet. */
+    bool sp_pending;
+    /** Which of my subset barriers are in use (one bit each). */
+    unsigned subsets_used;
+    /** Last subset generation that I published. */
+    uint64_t subset_gen;
+    /** Number of entries in subsets_seen. */
+    int nsubsets_seen;
+    /** Subsets that I joined, so that I never join the same generation twice. */
+    quo_ctrl_subset_seen_t *subsets_seen;
+    /** Which synchronization objects are in use. Collective, so the same
+     * everywhere. */
+    uint64_t objs_used[QUO_CTRL_NOBJS / 64];
+    /** Number of lenders whose cpusets I borrowed. */
+    int nborrowed;
+    /** QIDs of the lenders whose cpusets I borrowed (nqid long). */
+    int *borrowed;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static size_t
+header_size(void)
+{
+    return QUO_CACHE_LINE_ROUNDUP(sizeof(quo_ctrl_header_t));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static quo_ctrl_quiesce_t *
+get_quiesce(const quo_ctrl_t *ctrl)
+{
+    return (quo_ctrl_quiesce_t *)(ctrl->basep + header_size());
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static quo_ctrl_counter_barrier_t *
+get_split_barrier(const quo_ctrl_t *ctrl)
+{
+    return (quo_ctrl_counter_barrier_t *)(ctrl->basep + header_size() +
+                                          QUO_CACHE_LINE_SIZE);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns qid's barrier arrival flag. qid -1 is the release flag.
+ */
+static quo_ctrl_barrier_flag_t *
+get_barrier_flag(const quo_ctrl_t *ctrl,
+                 int qid)
+{
+    return (quo_ctrl_barrier_flag_t *)(ctrl->basep + header_size() +
+                                       (size_t)(qid + 3) * QUO_CACHE_LINE_SIZE);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns leader's subset barrier i. Line 0 is the leader's failure record.
+ */
+static quo_ctrl_subset_line_t *
+get_subset_line(const quo_ctrl_t *ctrl,
+                int leader,
+                int i)
+{
+    const size_t line = (size_t)ctrl->nqid + 3 +
+                        (size_t)leader * QUO_CTRL_SUBSET_NLINES + i;
+    return (quo_ctrl_subset_line_t *)(ctrl->basep + header_size() +
+                                      line * QUO_CACHE_LINE_SIZE);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void *
+get_obj(const quo_ctrl_t *ctrl,
+        int obj)
+{
+    const size_t line = (size_t)ctrl->nqid + 3 +
+                        (size_t)ctrl->nqid * QUO_CTRL_SUBSET_NLINES + obj;
+    return ctrl->basep + header_size() + line * QUO_CACHE_LINE_SIZE;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static quo_ctrl_slot_t *
+get_slot(const quo_ctrl_t *ctrl,
+         int qid)
+{
+    return (quo_ctrl_slot_t *)(ctrl->basep + header_size() +
+                               (size_t)QUO_CTRL_NSYNC_LINES(ctrl->nqid) *
+                               QUO_CACHE_LINE_SIZE +
+                               (size_t)qid * ctrl->slot_size);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static quo_ctrl_header_t *
+get_header(const quo_ctrl_t *ctrl)
+{
+    return (quo_ctrl_header_t *)ctrl->basep;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static quo_ctrl_bind_pub_t *
+get_bind_pub(const quo_ctrl_t *ctrl,
+             int qid,
+             uint64_t gen)
+{
+    /* double buffered by generation parity */
+    return (quo_ctrl_bind_pub_t *)((char *)get_slot(ctrl, qid) +
+                                   ctrl->pub_off + (gen & 1) * ctrl->pub_size);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_ctrl_construct(quo_ctrl_t **nctrl)
+{
+    int rc = QUO_SUCCESS;
+    quo_ctrl_t *ctrl = NULL;
+
+    if (!nctrl) return QUO_ERR_INVLD_ARG;
+    if (NULL == (ctrl = calloc(1, sizeof(*ctrl)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = quo_sm_construct(&ctrl->sm))) {
+        QUO_ERR_MSGRC("quo_sm_construct", rc);
+        free(ctrl);
+        return rc;
+    }
+    *nctrl = ctrl;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_ctrl_init(quo_ctrl_t *ctrl,
+              quo_mpi_t *mpi,
+              int cpuset_nulongs)
+{
+    int rc = QUO_SUCCESS;
+    char *seg_path = NULL;
+
+    if (!ctrl || !mpi || cpuset_nulongs <= 0) return QUO_ERR_INVLD_ARG;
+
+    if (QUO_SUCCESS != (rc = quo_mpi_noderank(mpi, &ctrl->qid))) goto out;
+    if (QUO_SUCCESS != (rc = quo_mpi_nnoderanks(mpi, &ctrl->nqid))) goto out;
+    ctrl->nulongs = cpuset_nulongs;
+    ctrl->bar_spins = QUO_CTRL_BARRIER_SPINS;
+    const size_t masks_size = cpuset_nulongs * sizeof(unsigned long);
+    ctrl->lend_off = QUO_CTRL_ROUNDUP8(sizeof(quo_ctrl_slot_t) + masks_size);
+    ctrl->pub_off = ctrl->lend_off + QUO_CTRL_ROUNDUP8(masks_size);
+    ctrl->pub_size = QUO_CTRL_ROUNDUP8(sizeof(quo_ctrl_bind_pub_t) + masks_size);
+    ctrl->slot_size = QUO_CACHE_LINE_ROUNDUP(ctrl->pub_off + 2 * ctrl->pub_size);
+    const size_t seg_size = header_size() +
+                            QUO_CTRL_NSYNC_LINES(ctrl->nqid) *
+                            QUO_CACHE_LINE_SIZE +
+                            ctrl->nqid * ctrl->slot_size;
+    /* Generate and agree upon a unique (node-local) path name. */
+    if (QUO_SUCCESS != (rc = quo_mpi_xchange_uniq_path(mpi, "ctrl",
+                                                       &seg_path))) {
+        QUO_ERR_MSGRC("quo_mpi_xchange_uniq_path", rc);
+        goto out;
+    }
+    if (0 == ctrl->qid) {
+        /* ftruncate zero-fills, so everything starts out zeroed. */
+        rc = quo_sm_segment_create(ctrl->sm, seg_path, seg_size);
+        if (QUO_SUCCESS != rc) {
+            QUO_ERR_MSGRC("quo_sm_segment_create", rc);
+            goto out;
+        }
+        ctrl->mapped = true;
+        quo_ctrl_header_t *hdr = quo_sm_get_basep(ctrl->sm);
+        hdr->nqid = ctrl->nqid;
+        hdr->nulongs = ctrl->nulongs;
+        /* Signal completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        /* Wait for attach completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        /* Cleanup after everyone is done. */
+        (void)quo_sm_unlink(ctrl->sm);
+    }
+    else {
+        /* Wait for the segment to be created. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        rc = quo_sm_segment_attach(ctrl->sm, seg_path, seg_size);
+        if (QUO_SUCCESS != rc) {
+            QUO_ERR_MSGRC("quo_sm_segment_attach", rc);
+            goto out;
+        }
+        ctrl->mapped = true;
+        /* Signal attach completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+    }
+    ctrl->basep = quo_sm_get_basep(ctrl->sm);
+    if (NULL == (ctrl->borrowed = calloc(ctrl->nqid, sizeof(int)))) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+out:
+    if (seg_path) free(seg_path);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_ctrl_destruct(quo_ctrl_t *ctrl)
+{
+    if (!ctrl) return QUO_ERR_INVLD_ARG;
+    /* quo_sm_destruct unmaps, so only call it when there is a mapping. */
+    if (ctrl->mapped) {
+        (void)quo_sm_destruct(ctrl->sm);
+    }
+    else {
+        free(ctrl->sm);
+    }
+    if (ctrl->bar_children) free(ctrl->bar_children);
+    if (ctrl->subsets_seen) free(ctrl->subsets_seen);
+    if (ctrl->borrowed) free(ctrl->borrowed);
+    free(ctrl);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Posts a rebind request to qid's slot. The slot's sequence number is used as
+ * a seqlock, so concurrent posters are serialized and readers never see a
+ * partially written mask.
+ */
+int
+quo_ctrl_rebind_post(quo_ctrl_t *ctrl,
+                     int qid,
+                     const unsigned long *masks)
+{
+    if (!ctrl || !masks || qid < 0 || qid >= ctrl->nqid) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    quo_ctrl_slot_t *slot = get_slot(ctrl, qid);
+    /* Take the slot by moving the sequence number from even to odd. */
+    uint64_t seq = quo_atomic_load_u64(&slot->rebind_seq);
+    while ((seq & 1) || !quo_atomic_cas_u64(&slot->rebind_seq, seq, seq + 1)) {
+        quo_atomic_cpu_relax();
+        seq = quo_atomic_load_u64(&slot->rebind_seq);
+    }
+    (void)memmove(slot->rebind_masks, masks,
+                  ctrl->nulongs * sizeof(unsigned long));
+    /* Publish. */
+    quo_atomic_store_u64(&slot->rebind_seq, seq + 2);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns whether or not a rebind request was posted to my slot since the last
+ * fetch.
+ */
+bool
+quo_ctrl_rebind_pending(const quo_ctrl_t *ctrl)
+{
+    const quo_ctrl_slot_t *slot = get_slot(ctrl, ctrl->qid);
+    return ctrl->rebind_seen != quo_atomic_load_u64(&slot->rebind_seq);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Fetches the latest rebind request posted to my slot (if any). *out_new is
+ * set to true only if a request was posted since the last fetch. Multiple
+ * requests posted between fetches are coalesced into the latest one.
+ */
+int
+quo_ctrl_rebind_fetch(quo_ctrl_t *ctrl,
+                      unsigned long *masks,
+                      bool *out_new)
+{
+    if (!ctrl || !masks || !out_new) return QUO_ERR_INVLD_ARG;
+
+    quo_ctrl_slot_t *slot = get_slot(ctrl, ctrl->qid);
+    *out_new = false;
+    for (;;) {
+        const uint64_t s1 = quo_atomic_load_u64(&slot->rebind_seq);
+        /* Common case: nothing new. */
+        if (s1 == ctrl->rebind_seen) return QUO_SUCCESS;
+        /* A write is in progress. */
+        if (s1 & 1) {
+            quo_atomic_cpu_relax();
+            continue;
+        }
+        (void)memmove(masks, slot->rebind_masks,
+                      ctrl->nulongs * sizeof(unsigned long));
+        quo_atomic_fence();
+        if (s1 == quo_atomic_load_u64(&slot->rebind_seq)) {
+            ctrl->rebind_seen = s1;
+            *out_new = true;
+            return QUO_SUCCESS;
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns a pointer to the node-wide binding epoch.
+ */
+uint64_t *
+quo_ctrl_bind_epoch_ptr(const quo_ctrl_t *ctrl)
+{
+    return &get_header(ctrl)->bind_epoch;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the current node-wide binding epoch.
+ */
+uint64_t
+quo_ctrl_bind_epoch(const quo_ctrl_t *ctrl)
+{
+    return quo_atomic_load_u64(quo_ctrl_bind_epoch_ptr(ctrl));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Publishes my current binding (along with the binding epoch that I observed,
+ * whether or not my cached result is still valid, and my work weight) so that other node
+ * processes can read it after the next node barrier. Collective: every node
+ * process must call this the same number of times. Publications are double
+ * buffered, so a process that is done with generation g can publish g + 1 while
+ * slower processes are still reading generation g: nobody can publish g + 2
+ * before everyone reached the barrier that follows g + 1.
+ */
+int
+quo_ctrl_bind_publish(quo_ctrl_t *ctrl,
+                      uint64_t epoch,
+                      bool cache_valid,
+                      double weight,
+                      const unsigned long *masks)
+{
+    if (!ctrl || !masks) return QUO_ERR_INVLD_ARG;
+    ctrl->bind_gen++;
+    quo_ctrl_bind_pub_t *pub = get_bind_pub(ctrl, ctrl->qid, ctrl->bind_gen);
+    pub->epoch = epoch;
+    pub->cache_valid = cache_valid ? 1 : 0;
+    pub->weight = weight;
+    (void)memmove(pub->masks, masks, ctrl->nulongs * sizeof(unsigned long));
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns a pointer to qid's most recent publication. Only valid after the
+ * barrier that follows quo_ctrl_bind_publish and until the next one.
+ */
+int
+quo_ctrl_bind_published(const quo_ctrl_t *ctrl,
+                        int qid,
+                        const quo_ctrl_bind_pub_t **pub)
+{
+    if (!ctrl || !pub || qid < 0 || qid >= ctrl->nqid) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    *pub = get_bind_pub(ctrl, qid, ctrl->bind_gen);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Builds the barrier tree over nqid processes, given their groups: members of
+ * a group form a QUO_CTRL_BARRIER_ARITY-ary heap rooted at the group's first
+ * member, and those first members form a heap of their own (in group order).
+ * Fills parents with every process' parent (-1 for the root).
+ */
+static int
+barrier_tree(int nqid,
+             const int64_t *groups,
+             int *parents)
+{
+    int rc = QUO_SUCCESS, ngroups = 0;
+    /* QIDs sorted by (group, QID) and where every group starts in there */
+    int *order = NULL, *starts = NULL;
+
+    if (nqid <= 0) return QUO_ERR_INVLD_ARG;
+    order = calloc(nqid, sizeof(*order));
+    starts = calloc(nqid + 1, sizeof(*starts));
+    if (!order || !starts) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    for (int qid = 0; qid < nqid; ++qid) {
+        int i = qid;
+        for (; i > 0 && groups[order[i - 1]] > groups[qid]; --i) {
+            order[i] = order[i - 1];
+        }
+        order[i] = qid;
+    }
+    for (int i = 0; i < nqid; ++i) {
+        if (0 == i || groups[order[i]] != groups[order[i - 1]]) {
+            starts[ngroups++] = i;
+        }
+    }
+    starts[ngroups] = nqid;
+    for (int g = 0; g < ngroups; ++g) {
+        const int leader = order[starts[g]];
+        parents[leader] = (0 == g) ? -1 :
+            order[starts[(g - 1) / QUO_CTRL_BARRIER_ARITY]];
+        for (int p = 1; p < starts[g + 1] - starts[g]; ++p) {
+            parents[order[starts[g] + p]] =
+                order[starts[g] + (p - 1) / QUO_CTRL_BARRIER_ARITY];
+        }
+    }
+out:
+    if (order) free(order);
+    if (starts) free(starts);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Sets up the tree barrier (see quo_ctrl_barrier). group is the barrier group
+ * that I am in: processes in the same group (e.g., on the same socket) are
+ * synchronized with each other first, so most flags only bounce between caches
+ * that share a socket. A group of -1 means that I am not in any one group (e.g.,
+ * I'm unbound or span sockets); if anybody says so, the tree is built flat over
+ * all node processes instead. Collective over the node; uses the current
+ * quo_mpi_sm_barrier.
+ */
+int
+quo_ctrl_barrier_setup(quo_ctrl_t *ctrl,
+                       quo_mpi_t *mpi,
+                       int group)
+{
+    int rc = QUO_SUCCESS, brc = QUO_SUCCESS;
+    int64_t *groups = NULL;
+    int *parents = NULL;
+
+    if (!ctrl || !mpi) return QUO_ERR_INVLD_ARG;
+
+    groups = calloc(ctrl->nqid, sizeof(*groups));
+    parents = calloc(ctrl->nqid, sizeof(*parents));
+    if (ctrl->bar_children) free(ctrl->bar_children);
+    ctrl->bar_children = calloc(ctrl->nqid, sizeof(*ctrl->bar_children));
+    if (!groups || !parents || !ctrl->bar_children) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+    }
+    get_barrier_flag(ctrl, ctrl->qid)->group = group;
+    /* on error, still take part in the barriers so nobody is left waiting */
+    if (QUO_SUCCESS != (brc = quo_mpi_sm_barrier(mpi))) goto out;
+    if (QUO_SUCCESS == rc) {
+        bool flat = false;
+        for (int qid = 0; qid < ctrl->nqid; ++qid) {
+            groups[qid] = get_barrier_flag(ctrl, qid)->group;
+            if (groups[qid] < 0) flat = true;
+        }
+        /* everyone reads the same groups, so everyone agrees on this */
+        if (flat) (void)memset(groups, 0, ctrl->nqid * sizeof(*groups));
+        rc = barrier_tree(ctrl->nqid, groups, parents);
+    }
+    if (QUO_SUCCESS == rc) {
+        ctrl->bar_parent = parents[ctrl->qid];
+        ctrl->bar_nchildren = 0;
+        for (int qid = 0; qid < ctrl->nqid; ++qid) {
+            if (parents[qid] != ctrl->qid) continue;
+            ctrl->bar_children[ctrl->bar_nchildren++] = qid;
+        }
+    }
+    /* nobody may touch the flags before everyone has read the groups */
+    brc = quo_mpi_sm_barrier(mpi);
+out:
+    if (groups) free(groups);
+    if (parents) free(parents);
+    return (QUO_SUCCESS != rc) ? rc : brc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Tells the control region whether or not there are more node processes than
+ * PUs. If so, waiters yield (or sleep) right away instead of spinning first.
+ */
+int
+quo_ctrl_set_oversubscribed(quo_ctrl_t *ctrl,
+                            bool oversubscribed)
+{
+    if (!ctrl) return QUO_ERR_INVLD_ARG;
+    ctrl->bar_spins = oversubscribed ? 0 : QUO_CTRL_BARRIER_SPINS;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns how many times a waiter should spin before yielding or sleeping.
+ */
+int
+quo_ctrl_spin_limit(const quo_ctrl_t *ctrl)
+{
+    return ctrl->bar_spins;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Waits until *epochp reaches at least epoch.
+ */
+static void
+barrier_wait_for(const quo_ctrl_t *ctrl,
+                 const uint64_t *epochp,
+                 uint64_t epoch)
+{
+    int spins = 0;
+    while (quo_atomic_load_u64(epochp) < epoch) {
+        if (spins < ctrl->bar_spins) {
+            quo_atomic_cpu_relax();
+            spins++;
+        }
+        else {
+            (void)sched_yield();
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Node barrier over the control region. Arrivals are combined up the tree set
+ * up by quo_ctrl_barrier_setup, and the root releases everyone through a single
+ * flag. Epochs only grow, so no sense reversal is needed: a process can't
+ * signal epoch e + 1 before everyone saw the release of e.
+ */
+int
+quo_ctrl_barrier(quo_ctrl_t *ctrl)
+{
+    if (!ctrl) return QUO_ERR_INVLD_ARG;
+
+    const uint64_t epoch = ++ctrl->bar_epoch;
+    for (int i = 0; i < ctrl->bar_nchildren; ++i) {
+        barrier_wait_for(ctrl, &get_barrier_flag(ctrl,
+                                                 ctrl->bar_children[i])->epoch,
+                         epoch);
+    }
+    if (-1 == ctrl->bar_parent) {
+        quo_atomic_store_u64(&get_barrier_flag(ctrl, -1)->epoch, epoch);
+    }
+    else {
+        quo_atomic_store_u64(&get_barrier_flag(ctrl, ctrl->qid)->epoch, epoch);
+        barrier_wait_for(ctrl, &get_barrier_flag(ctrl, -1)->epoch, epoch);
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Node barrier whose waiters sleep instead of spinning: everyone but the last
+ * arriver waits on a futex in the control region, and the last arriver wakes
+ * them all up with a single call.
+ */
+int
+quo_ctrl_quiesce(quo_ctrl_t *ctrl)
+{
+    if (!ctrl) return QUO_ERR_INVLD_ARG;
+
+    quo_ctrl_quiesce_t *qs = get_quiesce(ctrl);
+    /* read the round before arriving, so its end can't be missed */
+    const uint32_t seq = quo_atomic_load_u32(&qs->seq);
+    if ((uint32_t)ctrl->nqid - 1 ==
+        quo_atomic_fetch_add_u32(&qs->narrived, 1)) {
+        /* nobody can arrive for the next round before seq moves */
+        quo_atomic_store_u32(&qs->narrived, 0);
+        (void)quo_atomic_fetch_add_u32(&qs->seq, 1);
+        quo_futex_wake_all(&qs->seq);
+        return QUO_SUCCESS;
+    }
+    while (seq == quo_atomic_load_u32(&qs->seq)) {
+        quo_futex_wait(&qs->seq, seq);
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns whether or not the counting barrier reached the given phase.
+ */
+static bool
+counter_barrier_done(const quo_ctrl_counter_barrier_t *cb,
+                     uint32_t phase)
+{
+    /* phase wraps around, but nobody can be 2^31 phases behind */
+    return (int32_t)(quo_atomic_load_u32(&cb->phase) - phase) >= 0;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Arrives at a counting barrier. The arriver that brings the arrival count to
+ * target completes the phase.
+ */
+static void
+counter_barrier_arrive(quo_ctrl_counter_barrier_t *cb,
+                       uint64_t target,
+                       uint32_t phase)
+{
+    if (target == quo_atomic_fetch_add_u64(&cb->narrived, 1) + 1) {
+        quo_atomic_store_u32(&cb->phase, phase);
+        /* pairs with the fence in counter_barrier_wait */
+        quo_atomic_fence();
+        if (quo_atomic_load_u32(&cb->nsleepers) > 0) {
+            quo_futex_wake_all(&cb->phase);
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Waits until a counting barrier reached the given phase. Spins for a while
+ * (unless the node is oversubscribed) and then sleeps.
+ */
+static void
+counter_barrier_wait(const quo_ctrl_t *ctrl,
+                     quo_ctrl_counter_barrier_t *cb,
+                     uint32_t phase)
+{
+    for (int spins = 0; spins < ctrl->bar_spins; ++spins) {
+        if (counter_barrier_done(cb, phase)) return;
+        quo_atomic_cpu_relax();
+    }
+    while (!counter_barrier_done(cb, phase)) {
+        (void)quo_atomic_fetch_add_u32(&cb->nsleepers, 1);
+        /* pairs with the fence in counter_barrier_arrive */
+        quo_atomic_fence();
+        const uint32_t cur = quo_atomic_load_u32(&cb->phase);
+        if (!counter_barrier_done(cb, phase)) quo_futex_wait(&cb->phase, cur);
+        (void)quo_atomic_fetch_add_u32(&cb->nsleepers, (uint32_t)-1);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Arrives at the split-phase node barrier without waiting for the others (see
+ * quo_ctrl_barrier_test and quo_ctrl_barrier_wait). Phase p is complete once
+ * there were p * nqid arrivals.
+ */
+int
+quo_ctrl_barrier_arrive(quo_ctrl_t *ctrl)
+{
+    if (!ctrl || ctrl->sp_pending) return QUO_ERR_INVLD_ARG;
+
+    const uint64_t phase = ++ctrl->sp_phase;
+    ctrl->sp_pending = true;
+    counter_barrier_arrive(get_split_barrier(ctrl),
+                           phase * (uint64_t)ctrl->nqid, (uint32_t)phase);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Sets *out_done to whether or not everyone arrived at the phase that I last
+ * arrived at. Once it is, the next quo_ctrl_barrier_arrive can be called.
+ */
+int
+quo_ctrl_barrier_test(quo_ctrl_t *ctrl,
+                      bool *out_done)
+{
+    if (!ctrl || !out_done || !ctrl->sp_pending) return QUO_ERR_INVLD_ARG;
+
+    *out_done = counter_barrier_done(get_split_barrier(ctrl),
+                                     (uint32_t)ctrl->sp_phase);
+    if (*out_done) ctrl->sp_pending = false;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Waits until everyone arrived at the phase that I last arrived at.
+ */
+int
+quo_ctrl_barrier_wait(quo_ctrl_t *ctrl)
+{
+    if (!ctrl || !ctrl->sp_pending) return QUO_ERR_INVLD_ARG;
+
+    counter_barrier_wait(ctrl, get_split_barrier(ctrl),
+                         (uint32_t)ctrl->sp_phase);
+    ctrl->sp_pending = false;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns an FNV-1a hash of a member list (never 0).
+ */
+static uint64_t
+subset_key(int nmembers,
+           const int *members)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < nmembers; ++i) {
+        h ^= (uint64_t)(uint32_t)members[i];
+        h *= 1099511628211ULL;
+    }
+    return (0 == h) ? 1 : h;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Publishes a subset line (see quo_ctrl_subset_line_t).
+ */
+static void
+subset_line_publish(quo_ctrl_subset_line_t *line,
+                    uint64_t gen,
+                    uint64_t key,
+                    uint64_t nmembers)
+{
+    quo_atomic_store_u64(&line->gen, 0);
+    quo_atomic_fence();
+    line->key = key;
+    line->nmembers = nmembers;
+    line->base = quo_atomic_load_u64(&line->cb.narrived);
+    line->pbase = quo_atomic_load_u32(&line->cb.phase);
+    quo_atomic_store_u64(&line->gen, gen);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Reads a consistent copy of a subset line's published fields. Returns false
+ * if the line is being written.
+ */
+static bool
+subset_line_read(const quo_ctrl_subset_line_t *line,
+                 quo_ctrl_subset_line_t *copy)
+{
+    const uint64_t gen = quo_atomic_load_u64(&line->gen);
+    if (0 == gen) return false;
+    copy->key = line->key;
+    copy->nmembers = line->nmembers;
+    copy->base = line->base;
+    copy->pbase = line->pbase;
+    quo_atomic_fence();
+    copy->gen = gen;
+    return gen == quo_atomic_load_u64(&line->gen);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns (adding it if need be) what I know about leader's subset with key.
+ */
+static quo_ctrl_subset_seen_t *
+subset_seen(quo_ctrl_t *ctrl,
+            int leader,
+            uint64_t key)
+{
+    for (int i = 0; i < ctrl->nsubsets_seen; ++i) {
+        quo_ctrl_subset_seen_t *seen = &ctrl->subsets_seen[i];
+        if (seen->leader == leader && seen->key == key) return seen;
+    }
+    quo_ctrl_subset_seen_t *seen =
+        realloc(ctrl->subsets_seen,
+                (ctrl->nsubsets_seen + 1) * sizeof(*ctrl->subsets_seen));
+    if (!seen) return NULL;
+    ctrl->subsets_seen = seen;
+    seen = &ctrl->subsets_seen[ctrl->nsubsets_seen++];
+    seen->leader = leader;
+    seen->key = key;
+    seen->gen = 0;
+    seen->nlive = 0;
+    return seen;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Leaves one of leader's live subsets with key. Once none are left, forgets
+ * about them. Only safe when the leader no longer publishes any generation with
+ * key that I saw (see quo_ctrl_subset_leave).
+ */
+static void
+subset_seen_leave(quo_ctrl_t *ctrl,
+                  int leader,
+                  uint64_t key)
+{
+    for (int i = 0; i < ctrl->nsubsets_seen; ++i) {
+        quo_ctrl_subset_seen_t *seen = &ctrl->subsets_seen[i];
+        if (seen->leader != leader || seen->key != key) continue;
+        if (--seen->nlive > 0) return;
+        *seen = ctrl->subsets_seen[--ctrl->nsubsets_seen];
+        return;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Joins the subset barrier of the given (sorted, duplicate-free) members, which
+ * must include me. Collective over the members only: the leader (the first
+ * member) takes one of its free barriers and publishes it; everyone else waits
+ * for a generation of it that they haven't joined yet. Members remember the
+ * last generation that they joined for every leader and member list, so
+ * subsets over the same members are told apart by generation, oldest first
+ * (everyone creates them in the same order). If the leader has no free
+ * barriers, it publishes a failure record (generation-stamped the same way)
+ * instead and everyone returns QUO_ERR_OOR.
+ */
+int
+quo_ctrl_subset_join(quo_ctrl_t *ctrl,
+                     int nmembers,
+                     const int *members,
+                     quo_ctrl_subset_t *out_subset)
+{
+    if (!ctrl || nmembers <= 0 || !members || !out_subset) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    const int leader = members[0];
+    const uint64_t key = subset_key(nmembers, members);
+    quo_ctrl_subset_line_t copy;
+
+    out_subset->leader = leader;
+    out_subset->nmembers = nmembers;
+    out_subset->key = key;
+    out_subset->nphases = 0;
+    if (leader == ctrl->qid) {
+        const uint64_t gen = ++ctrl->subset_gen;
+        for (int i = 1; i <= QUO_CTRL_SUBSETS_PER_QID; ++i) {
+            if (ctrl->subsets_used & (1U << i)) continue;
+            quo_ctrl_subset_line_t *line = get_subset_line(ctrl, leader, i);
+            ctrl->subsets_used |= (1U << i);
+            subset_line_publish(line, gen, key, (uint64_t)nmembers);
+            out_subset->line = i;
+            out_subset->base = line->base;
+            out_subset->pbase = (uint32_t)line->pbase;
+            return QUO_SUCCESS;
+        }
+        subset_line_publish(get_subset_line(ctrl, leader, 0), gen, key,
+                            (uint64_t)nmembers);
+        return QUO_ERR_OOR;
+    }
+    quo_ctrl_subset_seen_t *seen = subset_seen(ctrl, leader, key);
+    if (!seen) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    for (int spins = 0; ; ++spins) {
+        /* the leader may be ahead of me, so take its oldest generation */
+        int found = -1;
+        quo_ctrl_subset_line_t oldest;
+        (void)memset(&oldest, 0, sizeof(oldest));
+        for (int i = 0; i <= QUO_CTRL_SUBSETS_PER_QID; ++i) {
+            if (!subset_line_read(get_subset_line(ctrl, leader, i), &copy) ||
+                copy.key != key || copy.nmembers != (uint64_t)nmembers ||
+                copy.gen <= seen->gen) continue;
+            if (-1 == found || copy.gen < oldest.gen) {
+                found = i;
+                oldest = copy;
+            }
+        }
+        if (-1 != found) {
+            seen->gen = oldest.gen;
+            if (0 == found) return QUO_ERR_OOR;
+            seen->nlive++;
+            out_subset->line = found;
+            out_subset->base = oldest.base;
+            out_subset->pbase = (uint32_t)oldest.pbase;
+            return QUO_SUCCESS;
+        }
+        if (spins < ctrl->bar_spins) quo_atomic_cpu_relax();
+        else (void)sched_yield();
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Barrier over the members of a subset joined with quo_ctrl_subset_join.
+ */
+int
+quo_ctrl_subset_barrier(quo_ctrl_t *ctrl,
+                        quo_ctrl_subset_t *subset)
+{
+    if (!ctrl || !subset) return QUO_ERR_INVLD_ARG;
+
+    quo_ctrl_subset_line_t *line = get_subset_line(ctrl, subset->leader,
+                                                   subset->line);
+    const uint64_t k = ++subset->nphases;
+    const uint32_t phase = subset->pbase + (uint32_t)k;
+    counter_barrier_arrive(&line->cb,
+                           subset->base + k * (uint64_t)subset->nmembers,
+                           phase);
+    counter_barrier_wait(ctrl, &line->cb, phase);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Leaves a subset joined with quo_ctrl_subset_join. Collective over its
+ * members. The barrier's counters keep going, so the leader can hand it out
+ * again right away: its next owner starts counting where this one stopped.
+ * Members forget a member list once they're in no live subset over it, so
+ * creating and freeing subsets over and over doesn't pile up state.
+ */
+int
+quo_ctrl_subset_leave(quo_ctrl_t *ctrl,
+                      quo_ctrl_subset_t *subset)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!ctrl || !subset) return QUO_ERR_INVLD_ARG;
+    /* everyone joined, so the leader can take the generation down. so can it
+     * take down a failure record over the same members: they create subsets in
+     * the same order, so they all saw it before getting here */
+    if (QUO_SUCCESS != (rc = quo_ctrl_subset_barrier(ctrl, subset))) return rc;
+    if (subset->leader == ctrl->qid) {
+        quo_ctrl_subset_line_t *fail = get_subset_line(ctrl, ctrl->qid, 0);
+        quo_atomic_store_u64(&get_subset_line(ctrl, subset->leader,
+                                              subset->line)->gen, 0);
+        if (fail->key == subset->key) quo_atomic_store_u64(&fail->gen, 0);
+    }
+    /* once they're down, members that forget about them can't join them again
+     * by mistake, and nobody may still be arriving when the leader hands the
+     * barrier out */
+    if (QUO_SUCCESS != (rc = quo_ctrl_subset_barrier(ctrl, subset))) return rc;
+    if (subset->leader == ctrl->qid) {
+        ctrl->subsets_used &= ~(1U << subset->line);
+    }
+    else {
+        subset_seen_leave(ctrl, subset->leader, subset->key);
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Allocates a (zeroed, cache-line-sized) synchronization object. Collective
+ * over the node: everyone allocates and frees objects in the same order, so
+ * everyone picks the same one without talking. The object can only be used
+ * after a node barrier.
+ */
+int
+quo_ctrl_obj_alloc(quo_ctrl_t *ctrl,
+                   int *out_obj,
+                   void **out_ptr)
+{
+    if (!ctrl || !out_obj || !out_ptr) return QUO_ERR_INVLD_ARG;
+
+    for (int obj = 0; obj < QUO_CTRL_NOBJS; ++obj) {
+        uint64_t *word = &ctrl->objs_used[obj / 64];
+        const uint64_t bit = UINT64_C(1) << (obj % 64);
+        if (*word & bit) continue;
+        *word |= bit;
+        *out_obj = obj;
+        *out_ptr = get_obj(ctrl, obj);
+        /* nobody touches it before the next barrier */
+        if (0 == ctrl->qid) (void)memset(*out_ptr, 0, QUO_CACHE_LINE_SIZE);
+        return QUO_SUCCESS;
+    }
+    return QUO_ERR_OOR;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Frees an object allocated by quo_ctrl_obj_alloc. Collective over the node;
+ * everyone must be done with the object.
+ */
+int
+quo_ctrl_obj_free(quo_ctrl_t *ctrl,
+                  int obj)
+{
+    if (!ctrl || obj < 0 || obj >= QUO_CTRL_NOBJS) return QUO_ERR_INVLD_ARG;
+    ctrl->objs_used[obj / 64] &= ~(UINT64_C(1) << (obj % 64));
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static unsigned long *
+get_lend_masks(const quo_ctrl_t *ctrl,
+               int qid)
+{
+    return (unsigned long *)((char *)get_slot(ctrl, qid) + ctrl->lend_off);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Offers the given cpuset to other node processes (see quo_ctrl_lend_take).
+ * Fails if I am still lending or if I am borrowing.
+ */
+int
+quo_ctrl_lend(quo_ctrl_t *ctrl,
+              const unsigned long *masks)
+{
+    if (!ctrl || !masks) return QUO_ERR_INVLD_ARG;
+
+    quo_ctrl_slot_t *slot = get_slot(ctrl, ctrl->qid);
+    const uint32_t s = quo_atomic_load_u32(&slot->lend_state);
+    if (QUO_CTRL_LEND_NONE != (s & QUO_CTRL_LEND_STATE_MASK) ||
+        0 != ctrl->nborrowed) return QUO_ERR_INVLD_ARG;
+    /* Nobody reads the masks before they see the new state. */
+    (void)memmove(get_lend_masks(ctrl, ctrl->qid), masks,
+                  ctrl->nulongs * sizeof(unsigned long));
+    quo_atomic_store_u32(&slot->lend_state,
+                         ((s & ~QUO_CTRL_LEND_STATE_MASK) +
+                          QUO_CTRL_LEND_STATE_MASK + 1) |
+                         QUO_CTRL_LEND_AVAILABLE);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Takes back what I lent, waiting for the borrower (if any) to return it.
+ * Waiters spin for a little while and then sleep.
+ */
+int
+quo_ctrl_lend_reclaim(quo_ctrl_t *ctrl)
+{
+    if (!ctrl) return QUO_ERR_INVLD_ARG;
+
+    quo_ctrl_slot_t *slot = get_slot(ctrl, ctrl->qid);
+    const uint32_t gen_mask = ~QUO_CTRL_LEND_STATE_MASK;
+    for (int spins = 0; ; ++spins) {
+        const uint32_t s = quo_atomic_load_u32(&slot->lend_state);
+        switch (s & QUO_CTRL_LEND_STATE_MASK) {
+            case QUO_CTRL_LEND_NONE:
+                return QUO_SUCCESS;
+            case QUO_CTRL_LEND_AVAILABLE:
+                if (quo_atomic_cas_u32(&slot->lend_state, s, s & gen_mask)) {
+                    return QUO_SUCCESS;
+                }
+                break;
+            case QUO_CTRL_LEND_BORROWED:
+                (void)quo_atomic_cas_u32(&slot->lend_state, s,
+                                         (s & gen_mask) |
+                                         QUO_CTRL_LEND_RECALLED);
+                break;
+            default:
+                if (spins < ctrl->bar_spins) {
+                    quo_atomic_cpu_relax();
+                }
+                else {
+                    quo_futex_wait(&slot->lend_state, s);
+                }
+                break;
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Copies the cpuset that qid currently lends into masks. *out_ticket is what
+ * quo_ctrl_lend_take expects. Returns QUO_ERR_NOT_FOUND if qid's cpuset isn't
+ * available.
+ */
+int
+quo_ctrl_lend_peek(const quo_ctrl_t *ctrl,
+                   int qid,
+                   unsigned long *masks,
+                   uint32_t *out_ticket)
+{
+    if (!ctrl || !masks || !out_ticket || qid < 0 || qid >= ctrl->nqid) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    quo_ctrl_slot_t *slot = get_slot(ctrl, qid);
+    const uint32_t s = quo_atomic_load_u32(&slot->lend_state);
+    if (QUO_CTRL_LEND_AVAILABLE != (s & QUO_CTRL_LEND_STATE_MASK)) {
+        return QUO_ERR_NOT_FOUND;
+    }
+    (void)memmove(masks, get_lend_masks(ctrl, qid),
+                  ctrl->nulongs * sizeof(unsigned long));
+    *out_ticket = s;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Borrows qid's cpuset if it is still the one that quo_ctrl_lend_peek saw.
+ * If the lender reclaimed it (and maybe lent it again) in the meantime, the
+ * generation in the ticket no longer matches and nothing is taken.
+ */
+int
+quo_ctrl_lend_take(quo_ctrl_t *ctrl,
+                   int qid,
+                   uint32_t ticket,
+                   bool *out_taken)
+{
+    if (!ctrl || !out_taken || qid < 0 || qid >= ctrl->nqid ||
+        qid == ctrl->qid) return QUO_ERR_INVLD_ARG;
+
+    /* lenders can't borrow */
+    const quo_ctrl_slot_t *mine = get_slot(ctrl, ctrl->qid);
+    if (QUO_CTRL_LEND_NONE != (quo_atomic_load_u32(&mine->lend_state) &
+                               QUO_CTRL_LEND_STATE_MASK)) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    quo_ctrl_slot_t *slot = get_slot(ctrl, qid);
+    *out_taken = quo_atomic_cas_u32(&slot->lend_state, ticket,
+                                    (ticket & ~QUO_CTRL_LEND_STATE_MASK) |
+                                    QUO_CTRL_LEND_BORROWED);
+    if (*out_taken) ctrl->borrowed[ctrl->nborrowed++] = qid;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the number of cpusets that I borrowed.
+ */
+int
+quo_ctrl_lend_nborrowed(const quo_ctrl_t *ctrl)
+{
+    return ctrl->nborrowed;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns whether or not a lender wants its cpuset back.
+ */
+bool
+quo_ctrl_lend_recalled(const quo_ctrl_t *ctrl)
+{
+    for (int i = 0; i < ctrl->nborrowed; ++i) {
+        const quo_ctrl_slot_t *slot = get_slot(ctrl, ctrl->borrowed[i]);
+        const uint32_t s = quo_atomic_load_u32(&slot->lend_state);
+        if (QUO_CTRL_LEND_RECALLED == (s & QUO_CTRL_LEND_STATE_MASK)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Gives every borrowed cpuset back to its lender.
+ */
+int
+quo_ctrl_lend_return(quo_ctrl_t *ctrl)
+{
+    if (!ctrl) return QUO_ERR_INVLD_ARG;
+
+    for (int i = 0; i < ctrl->nborrowed; ++i) {
+        quo_ctrl_slot_t *slot = get_slot(ctrl, ctrl->borrowed[i]);
+        /* The lender may be moving it from borrowed to recalled. */
+        uint32_t s = quo_atomic_load_u32(&slot->lend_state);
+        while (!quo_atomic_cas_u32(&slot->lend_state, s,
+                                   s & ~QUO_CTRL_LEND_STATE_MASK)) {
+            s = quo_atomic_load_u32(&slot->lend_state);
+        }
+        quo_futex_wake(&slot->lend_state, 1);
+    }
+    ctrl->nborrowed = 0;
+    return QUO_SUCCESS;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-ctrl.h
+ */
+
+#ifndef QUO_CTRL_H_INCLUDED
+#define QUO_CTRL_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo-private.h"
+#include "quo.h"
+
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+
+/** A node process' binding publication (see quo_ctrl_bind_publish). */
+typedef struct quo_ctrl_bind_pub_t {
+    /** Node binding epoch observed by the publisher. */
+    uint64_t epoch;
+    /** Whether or not the publisher's cached result is still valid. */
+    uint64_t cache_valid;
+    /** The publisher's work weight (QUO_auto_distrib_weighted). */
+    double weight;
+    /** The publisher's binding (nulongs long). */
+    unsigned long masks[];
+} quo_ctrl_bind_pub_t;
+
+/** A subset barrier that a node process joined (see quo_ctrl_subset_join). */
+typedef struct quo_ctrl_subset_t {
+    /** Leader (lowest member) QID. */
+    int leader;
+    /** Which of the leader's subset barriers it is. */
+    int line;
+    /** Number of members. */
+    int nmembers;
+    /** Hash of the member list. */
+    uint64_t key;
+    /** The barrier's arrival count when it was handed to us. */
+    uint64_t base;
+    /** The barrier's phase when it was handed to us. */
+    uint32_t pbase;
+    /** Number of phases that I went through. */
+    uint64_t nphases;
+} quo_ctrl_subset_t;
+
+int
+quo_ctrl_construct(quo_ctrl_t **nctrl);
+
+int
+quo_ctrl_init(quo_ctrl_t *ctrl,
+              quo_mpi_t *mpi,
+              int cpuset_nulongs);
+
+int
+quo_ctrl_destruct(quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_rebind_post(quo_ctrl_t *ctrl,
+                     int qid,
+                     const unsigned long *masks);
+
+bool
+quo_ctrl_rebind_pending(const quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_rebind_fetch(quo_ctrl_t *ctrl,
+                      unsigned long *masks,
+                      bool *out_new);
+
+uint64_t *
+quo_ctrl_bind_epoch_ptr(const quo_ctrl_t *ctrl);
+
+uint64_t
+quo_ctrl_bind_epoch(const quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_bind_publish(quo_ctrl_t *ctrl,
+                      uint64_t epoch,
+                      bool cache_valid,
+                      double weight,
+                      const unsigned long *masks);
+
+int
+quo_ctrl_bind_published(const quo_ctrl_t *ctrl,
+                        int qid,
+                        const quo_ctrl_bind_pub_t **pub);
+
+int
+quo_ctrl_set_oversubscribed(quo_ctrl_t *ctrl,
+                            bool oversubscribed);
+
+int
+quo_ctrl_spin_limit(const quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_barrier_setup(quo_ctrl_t *ctrl,
+                       quo_mpi_t *mpi,
+                       int group);
+
+int
+quo_ctrl_barrier(quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_quiesce(quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_barrier_arrive(quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_barrier_test(quo_ctrl_t *ctrl,
+                      bool *out_done);
+
+int
+quo_ctrl_barrier_wait(quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_subset_join(quo_ctrl_t *ctrl,
+                     int nmembers,
+                     const int *members,
+                     quo_ctrl_subset_t *out_subset);
+
+int
+quo_ctrl_subset_barrier(quo_ctrl_t *ctrl,
+                        quo_ctrl_subset_t *subset);
+
+int
+quo_ctrl_subset_leave(quo_ctrl_t *ctrl,
+                      quo_ctrl_subset_t *subset);
+
+int
+quo_ctrl_obj_alloc(quo_ctrl_t *ctrl,
+                   int *out_obj,
+                   void **out_ptr);
+
+int
+quo_ctrl_obj_free(quo_ctrl_t *ctrl,
+                  int obj);
+
+int
+quo_ctrl_lend(quo_ctrl_t *ctrl,
+              const unsigned long *masks);
+
+int
+quo_ctrl_lend_reclaim(quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_lend_peek(const quo_ctrl_t *ctrl,
+                   int qid,
+                   unsigned long *masks,
+                   uint32_t *out_ticket);
+
+int
+quo_ctrl_lend_take(quo_ctrl_t *ctrl,
+                   int qid,
+                   uint32_t ticket,
+                   bool *out_taken);
+
+int
+quo_ctrl_lend_nborrowed(const quo_ctrl_t *ctrl);
+
+bool
+quo_ctrl_lend_recalled(const quo_ctrl_t *ctrl);
+
+int
+quo_ctrl_lend_return(quo_ctrl_t *ctrl);
+
+#endif
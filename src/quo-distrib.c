@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-distrib.c Work distribution heuristics.
+ */
+
+/* Both routines take the same description of the node: for every target
+ * resource rid, rank_ids_in_res[rid] lists (sorted) the nranks_in_res[rid]
+ * QIDs whose binding covers that resource. They fill out_assign (length nqid)
+ * with the resource each QID was assigned to, or -1 if the QID wasn't
+ * selected. No resource is ever assigned more than max_qids_per_res QIDs.
+ * quo_distrib_assign only promises that a QID covers its resource when the
+ * selection allows it (see the "all processes overlap" case). */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo-distrib.h"
+#include "quo-set.h"
+#include "quo-private.h"
+#include "quo.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+#ifdef HAVE_MATH_H
+#include <math.h>
+#endif
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+valid_table(int nres,
+            int nqid,
+            const int *nranks_in_res,
+            int **rank_ids_in_res)
+{
+    if (nres <= 0 || nqid <= 0 || !nranks_in_res || !rank_ids_in_res) {
+        return false;
+    }
+    for (int rid = 0; rid < nres; ++rid) {
+        for (int i = 0; i < nranks_in_res[rid]; ++i) {
+            const int qid = rank_ids_in_res[rid][i];
+            if (qid < 0 || qid >= nqid) return false;
+        }
+    }
+    return true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * The classic QUO_auto_distrib heuristic.
+ */
+int
+quo_distrib_assign(int nres,
+                   int nqid,
+                   const int *nranks_in_res,
+                   int **rank_ids_in_res,
+                   int max_qids_per_res,
+                   int *out_assign)
+{
+    int rc = QUO_SUCCESS;
+    /* holds k set intersection info */
+    int *k_set_intersection = NULL, k_set_intersection_len = 0;
+    bool *shared = NULL, *covers = NULL;
+    int *nassigned = NULL;
+
+    if (!out_assign || max_qids_per_res <= 0) return QUO_ERR_INVLD_ARG;
+    if (!valid_table(nres, nqid, nranks_in_res, rank_ids_in_res)) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    for (int qid = 0; qid < nqid; ++qid) out_assign[qid] = -1;
+    /* calculate the k set intersection of ranks on resources. the returned
+     * array will be the set of ranks that currently share a particular
+     * resource. */
+    rc = quo_set_get_k_set_intersection(nres, nranks_in_res,
+                                        rank_ids_in_res,
+                                        &k_set_intersection,
+                                        &k_set_intersection_len);
+    if (QUO_SUCCESS != rc) goto out;
+
+    /* !!! remember: always maintain "max workers per resource" invariant !!! */
+
+    /* completely disjoint sets: every QID covers at most one resource, so the
+     * first max_qids_per_res QIDs on every resource get it. */
+    if (0 == k_set_intersection_len) {
+        for (int rid = 0; rid < nres; ++rid) {
+            for (int i = 0; i < nranks_in_res[rid]; ++i) {
+                if (i < max_qids_per_res) {
+                    out_assign[rank_ids_in_res[rid][i]] = rid;
+                }
+            }
+        }
+    }
+    /* all processes overlap - really no hope of doing anything sane. we
+     * typically see this in the "no one is bound case." the first
+     * max_qids_per_res * nres QIDs are selected and dealt out round-robin,
+     * preferring resources that they cover. */
+    else if (nqid == k_set_intersection_len) {
+        if (NULL == (nassigned = calloc(nres, sizeof(*nassigned))) ||
+            NULL == (covers = calloc((size_t)nres * nqid, sizeof(*covers)))) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+        for (int rid = 0; rid < nres; ++rid) {
+            for (int i = 0; i < nranks_in_res[rid]; ++i) {
+                covers[(size_t)rid * nqid + rank_ids_in_res[rid][i]] = true;
+            }
+        }
+        for (int qid = 0; qid < nqid && qid < max_qids_per_res * nres; ++qid) {
+            int pick = -1;
+            for (int k = 0; k < nres && -1 == pick; ++k) {
+                const int rid = (qid + k) % nres;
+                if (nassigned[rid] < max_qids_per_res &&
+                    covers[(size_t)rid * nqid + qid]) pick = rid;
+            }
+            /* there is always room somewhere, since only max * nres QIDs are
+             * ever selected here */
+            for (int k = 0; k < nres && -1 == pick; ++k) {
+                const int rid = (qid + k) % nres;
+                if (nassigned[rid] < max_qids_per_res) pick = rid;
+            }
+            out_assign[qid] = pick;
+            nassigned[pick]++;
+        }
+    }
+    /* only a few ranks share a resource. in this case, favor unshared
+     * resources: only ranks that aren't sharing resources are considered. */
+    else {
+        if (NULL == (shared = calloc(nqid, sizeof(*shared)))) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+        for (int i = 0; i < k_set_intersection_len; ++i) {
+            shared[k_set_intersection[i]] = true;
+        }
+        for (int rid = 0; rid < nres; ++rid) {
+            int rmapped = 0;
+            for (int i = 0; i < nranks_in_res[rid]; ++i) {
+                const int qid = rank_ids_in_res[rid][i];
+                /* this thing is shared - skip */
+                if (shared[qid]) continue;
+                if (rmapped < max_qids_per_res) out_assign[qid] = rid;
+                ++rmapped;
+            }
+        }
+    }
+out:
+    if (k_set_intersection) free(k_set_intersection);
+    if (shared) free(shared);
+    if (covers) free(covers);
+    if (nassigned) free(nassigned);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/** A QID and its weight, so that sorting needs no outside state. */
+typedef struct weighted_qid_t {
+    double weight;
+    int qid;
+} weighted_qid_t;
+
+/** Sorts QIDs by decreasing weight (then increasing QID, so it is stable). */
+static int
+heavier_first(const void *a,
+              const void *b)
+{
+    const weighted_qid_t *wa = a, *wb = b;
+    if (wa->weight > wb->weight) return -1;
+    if (wa->weight < wb->weight) return 1;
+    return (wa->qid > wb->qid) - (wa->qid < wb->qid);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Weighted variant: longest processing time first (LPT). QIDs are considered
+ * from heaviest to lightest, and each one goes to the least loaded resource
+ * that its binding covers and that still has room. A QID that doesn't fit
+ * anywhere is not selected.
+ */
+int
+quo_distrib_assign_weighted(int nres,
+                            int nqid,
+                            const int *nranks_in_res,
+                            int **rank_ids_in_res,
+                            int max_qids_per_res,
+                            const double *weights,
+                            int *out_assign)
+{
+    int rc = QUO_SUCCESS;
+    int *nassigned = NULL, *cover_start = NULL, *covers = NULL;
+    double *load = NULL;
+    weighted_qid_t *order = NULL;
+
+    if (!out_assign || !weights || max_qids_per_res <= 0) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    if (!valid_table(nres, nqid, nranks_in_res, rank_ids_in_res)) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    for (int qid = 0; qid < nqid; ++qid) {
+        if (!isfinite(weights[qid]) || weights[qid] < 0.0) {
+            return QUO_ERR_INVLD_ARG;
+        }
+        out_assign[qid] = -1;
+    }
+    int ncovers = 0;
+    for (int rid = 0; rid < nres; ++rid) ncovers += nranks_in_res[rid];
+
+    order = calloc(nqid, sizeof(*order));
+    nassigned = calloc(nres, sizeof(*nassigned));
+    load = calloc(nres, sizeof(*load));
+    cover_start = calloc(nqid + 1, sizeof(*cover_start));
+    covers = calloc(ncovers > 0 ? ncovers : 1, sizeof(*covers));
+    if (!order || !nassigned || !load || !cover_start || !covers) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    /* invert the table: the resources covered by every QID (CSR style) */
+    for (int rid = 0; rid < nres; ++rid) {
+        for (int i = 0; i < nranks_in_res[rid]; ++i) {
+            cover_start[rank_ids_in_res[rid][i] + 1]++;
+        }
+    }
+    for (int qid = 0; qid < nqid; ++qid) {
+        cover_start[qid + 1] += cover_start[qid];
+    }
+    for (int rid = 0; rid < nres; ++rid) {
+        for (int i = 0; i < nranks_in_res[rid]; ++i) {
+            const int qid = rank_ids_in_res[rid][i];
+            /* order[].qid is scratch space for fill positions here */
+            covers[cover_start[qid] + order[qid].qid++] = rid;
+        }
+    }
+    for (int qid = 0; qid < nqid; ++qid) {
+        order[qid].weight = weights[qid];
+        order[qid].qid = qid;
+    }
+    qsort(order, nqid, sizeof(*order), heavier_first);
+
+    for (int i = 0; i < nqid; ++i) {
+        const int qid = order[i].qid;
+        int best = -1;
+        for (int c = cover_start[qid]; c < cover_start[qid + 1]; ++c) {
+            const int rid = covers[c];
+            if (nassigned[rid] >= max_qids_per_res) continue;
+            /* least loaded, then least populated, then lowest index */
+            if (-1 == best || load[rid] < load[best] ||
+                (load[rid] == load[best] && nassigned[rid] < nassigned[best])) {
+                best = rid;
+            }
+        }
+        if (-1 == best) continue;
+        out_assign[qid] = best;
+        load[best] += weights[qid];
+        nassigned[best]++;
+    }
+out:
+    if (order) free(order);
+    if (nassigned) free(nassigned);
+    if (load) free(load);
+    if (cover_start) free(cover_start);
+    if (covers) free(covers);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the home resource (e.g., work queue) of QID qid given the index of
+ * the resource that its binding fits in, or -1 if it doesn't fit in a single
+ * one (e.g., it's unbound). Processes without a resource of their own are
+ * spread over all of them by QID.
+ */
+int
+quo_distrib_home(int nres,
+                 int qid,
+                 int res_index)
+{
+    if (nres <= 0 || qid < 0) return -1;
+    if (res_index >= 0 && res_index < nres) return res_index;
+    return qid % nres;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-distrib.h
+ */
+
+#ifndef QUO_DISTRIB_H_INCLUDED
+#define QUO_DISTRIB_H_INCLUDED
+
+/* Everything in here is a pure function of its inputs (no context, no
+ * communication), so it can be exercised offline on synthetic tables. */
+
+int
+quo_distrib_assign(int nres,
+                   int nqid,
+                   const int *nranks_in_res,
+                   int **rank_ids_in_res,
+                   int max_qids_per_res,
+                   int *out_assign);
+
+int
+quo_distrib_assign_weighted(int nres,
+                            int nqid,
+                            const int *nranks_in_res,
+                            int **rank_ids_in_res,
+                            int max_qids_per_res,
+                            const double *weights,
+                            int *out_assign);
+
+int
+quo_distrib_home(int nres,
+                 int qid,
+                 int res_index);
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-global.c Job-wide placement.
+ */
+
+/* Every node first distributes its processes over the target resources
+ * exactly like QUO_auto_distrib does (without a per-resource limit). That gives
+ * every resource a capacity and every candidate a level (its position among the
+ * candidates of its resource). Worker slots are then ordered job-wide by
+ * (level, resource index, node index) and the first nworkers slots win. So
+ * resources fill up evenly (water filling), and leftovers at a level are spread
+ * over nodes before a node gets a second one. Only node leaders communicate:
+ * two allreduces and an exclusive scan over small level x resource tables,
+ * followed by a node broadcast. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo.h"
+#include "quo-private.h"
+#include "quo-hwloc.h"
+#include "quo-mpi.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Node leader part of QUO_global_place. cap[i] is the number of candidates for
+ * local resource i. Fills ids (nqid x nres, by level) with the job-wide worker
+ * ID of every local slot, or -1. If node_rc isn't QUO_SUCCESS, then my node
+ * already failed (and cap and ids may be NULL): I only go along with the
+ * collectives, so that all leaders fail together.
+ */
+static int
+leader_place(QUO_t *q,
+             int node_rc,
+             int nres,
+             const int *cap,
+             int nworkers,
+             int *ids)
+{
+    int rc = QUO_SUCCESS, lrc = node_rc, any_rc = QUO_SUCCESS;
+    MPI_Comm leader_comm;
+    int *ind = NULL, *tot = NULL, *pre = NULL;
+    int local_dims[2] = {0, nres}, dims[2] = {0, 0};
+
+    if (QUO_SUCCESS != (rc = quo_mpi_get_leader_comm(q->mpi, &leader_comm))) {
+        return rc;
+    }
+    for (int i = 0; QUO_SUCCESS == node_rc && i < nres; ++i) {
+        if (cap[i] > local_dims[0]) local_dims[0] = cap[i];
+    }
+    /* global number of levels and widest node */
+    if (QUO_SUCCESS != (rc = quo_mpi_allreduce(local_dims, dims, 2, MPI_INT,
+                                               MPI_MAX, leader_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allreduce", rc);
+        return rc;
+    }
+    const int nlvls = dims[0], width = dims[1];
+    const size_t tsize = (size_t)(nlvls > 0 ? nlvls : 1) * width;
+    ind = calloc(tsize, sizeof(*ind));
+    tot = calloc(tsize, sizeof(*tot));
+    pre = calloc(tsize, sizeof(*pre));
+    if ((!ind || !tot || !pre) && QUO_SUCCESS == lrc) {
+        QUO_OOR_COMPLAIN();
+        lrc = QUO_ERR_OOR;
+    }
+    /* the others are about to use leader_comm, so fail together or not at all */
+    if (QUO_SUCCESS != (rc = quo_mpi_allreduce(&lrc, &any_rc, 1, MPI_INT,
+                                               MPI_MAX, leader_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allreduce", rc);
+        goto out;
+    }
+    if (QUO_SUCCESS != any_rc) {
+        rc = any_rc;
+        goto out;
+    }
+    /* which of my (level, resource) slots exist */
+    for (int l = 0; l < nlvls; ++l) {
+        for (int i = 0; i < nres; ++i) {
+            ind[(size_t)l * width + i] = (cap[i] > l) ? 1 : 0;
+        }
+    }
+    /* how many nodes have every slot, and how many of those come before me */
+    if (QUO_SUCCESS != (rc = quo_mpi_allreduce(ind, tot, (int)tsize, MPI_INT,
+                                               MPI_SUM, leader_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allreduce", rc);
+        goto out;
+    }
+    if (QUO_SUCCESS != (rc = quo_mpi_exscan_int_sum(ind, pre, (int)tsize,
+                                                    leader_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_exscan_int_sum", rc);
+        goto out;
+    }
+    for (size_t s = 0; s < (size_t)q->nqid * nres; ++s) ids[s] = -1;
+    /* every process computes the same order, so worker IDs are unique */
+    long base = 0;
+    for (int l = 0; l < nlvls; ++l) {
+        for (int i = 0; i < width; ++i) {
+            const size_t s = (size_t)l * width + i;
+            if (i < nres && l < q->nqid && ind[s]) {
+                const long order = base + pre[s];
+                if (order < nworkers) ids[(size_t)l * nres + i] = (int)order;
+            }
+            base += tot[s];
+        }
+    }
+out:
+    if (ind) free(ind);
+    if (tot) free(tot);
+    if (pre) free(pre);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_global_place(QUO_t *q,
+                 QUO_obj_type_t distrib_over_this,
+                 int max_qids_per_res_type,
+                 int nworkers,
+                 int flags,
+                 int *out_res,
+                 int *out_worker_id)
+{
+    int rc = QUO_ERR, lrc = QUO_SUCCESS, node_rc = QUO_SUCCESS;
+    int nres = 0, my_res = -1, my_lvl = 0;
+    int *assign = NULL, *cap = NULL, *buf = NULL;
+    MPI_Comm node_comm;
+
+    if (!q || !out_res || !out_worker_id) return QUO_ERR_INVLD_ARG;
+    if (max_qids_per_res_type <= 0 || nworkers < 0) return QUO_ERR_INVLD_ARG;
+    if (0 != (flags & ~QUO_AUTO_DISTRIB_BIND_PUSH)) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *out_res = -1; *out_worker_id = -1; /* set defaults */
+
+    if (QUO_SUCCESS != (rc = quo_mpi_get_node_comm(q->mpi, &node_comm))) {
+        return rc;
+    }
+    if (QUO_SUCCESS != (rc = QUO_nobjs_by_type(q, distrib_over_this,
+                                               &nres))) {
+        return rc;
+    }
+    if (0 == nres) return QUO_ERR_NOT_FOUND;
+    assign = calloc(q->nqid, sizeof(*assign));
+    cap = calloc(nres, sizeof(*cap));
+    /* slot 0 carries the leader's return code */
+    buf = calloc(1 + (size_t)q->nqid * nres, sizeof(*buf));
+    if (!assign || !cap || !buf) {
+        QUO_OOR_COMPLAIN();
+        lrc = QUO_ERR_OOR;
+    }
+    /* node-local candidates: no limit here, that's applied per level below.
+     * collective, so go along even if I can't use the result. */
+    rc = QUO_auto_distrib_assign(q, distrib_over_this, q->nqid,
+                                 QUO_AUTO_DISTRIB_NO_FLAGS, &my_res, assign);
+    if (QUO_SUCCESS == lrc) lrc = rc;
+    for (int qid = 0; QUO_SUCCESS == lrc && qid < q->nqid; ++qid) {
+        if (-1 == assign[qid]) continue;
+        if (qid < q->qid && my_res == assign[qid]) my_lvl++;
+        if (cap[assign[qid]] < max_qids_per_res_type) cap[assign[qid]]++;
+    }
+    /* the node fails together, and so do the leaders (see leader_place) */
+    if (QUO_SUCCESS != (rc = quo_mpi_allreduce(&lrc, &node_rc, 1, MPI_INT,
+                                               MPI_MAX, node_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allreduce", rc);
+        goto out;
+    }
+    if (0 == q->qid) {
+        lrc = leader_place(q, node_rc, nres, cap, nworkers,
+                           buf ? buf + 1 : NULL);
+        if (QUO_SUCCESS == node_rc) buf[0] = lrc;
+    }
+    if (QUO_SUCCESS != (rc = node_rc)) goto out;
+    if (QUO_SUCCESS != (rc = quo_mpi_bcast(buf, 1 + q->nqid * nres, MPI_INT, 0,
+                                           node_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_bcast", rc);
+        goto out;
+    }
+    if (QUO_SUCCESS != (rc = buf[0])) goto out;
+    if (-1 == my_res || my_lvl >= cap[my_res]) goto out;
+    const int id = buf[1 + (size_t)my_lvl * nres + my_res];
+    if (-1 == id) goto out;
+    if (flags & QUO_AUTO_DISTRIB_BIND_PUSH) {
+        hwloc_const_cpuset_t res_cpuset = NULL;
+        rc = quo_hwloc_get_obj_cpuset(q->hwloc, distrib_over_this,
+                                      (unsigned)my_res, &res_cpuset);
+        if (QUO_SUCCESS != rc) goto out;
+        if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) goto out;
+        rc = quo_hwloc_bind_push_cpuset(q->hwloc, res_cpuset);
+        if (QUO_SUCCESS != rc) goto out;
+    }
+    *out_res = my_res;
+    *out_worker_id = id;
+out:
+    if (assign) free(assign);
+    if (cap) free(cap);
+    if (buf) free(buf);
+    return rc;
+}
@@ -19,6 +19,8 @@
 #include "quo-private.h"
 #include "quo-sm.h"
 #include "quo-mpi.h"
+#include "quo-utils.h"
+#include "quo-atomic.h"
 
 #ifdef HAVE_STDLIB_H
 #include <stdlib.h>
@@ -38,10 +40,25 @@
 #ifdef HAVE_SYSCALL_H
 #include <syscall.h>
 #endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_LIMITS_H
+#include <limits.h>
+#endif
+#ifdef HAVE_SCHED_H
+#include <sched.h>
+#endif
 
 /** Constant that dictates the max size of the bind stack - should be plenty. */
 #define BIND_STACK_SIZE 128
 
+/** Environment variable that enables binding instrumentation. */
+#define QUO_BIND_STATS_ENV_VAR_STR "QUO_BIND_STATS"
+
+/** How long (in seconds) instrumentation waits for threads to settle. */
+#define BIND_SETTLE_TIMEOUT 0.01
+
 /** The almighty bind stack. */
 typedef struct bind_stack_t {
     /** Index to top of the stack. */
@@ -66,6 +83,12 @@ struct quo_hwloc_t {
     int nid;
     /** Used to store hardware topology information. */
     quo_sm_t *htopo_sm;
+    /** Whether or not binding changes are instrumented. */
+    bool bstats_enabled;
+    /** Binding instrumentation counters. */
+    QUO_bind_stats_t bstats;
+    /** Node-wide binding epoch (lives in shared memory). May be NULL. */
+    uint64_t *bind_epoch;
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -75,6 +98,7 @@ valid_bind_policy(QUO_bind_push_policy_t policy)
     switch (policy) {
         case QUO_BIND_PUSH_PROVIDED:
         case QUO_BIND_PUSH_OBJ:
+        case QUO_BIND_PUSH_CPUSET:
             return true;
         default:
             return false;
@@ -110,6 +134,9 @@ ext2intobj(QUO_obj_type_t external,
         case QUO_OBJ_PU:
             *internal = HWLOC_OBJ_PU;
             break;
+        case QUO_OBJ_L3CACHE:
+            *internal = HWLOC_OBJ_L3CACHE;
+            break;
         default:
             /* Well, we'll just return the machine if something weird was passed
              * to us. check your return codes, folks! */
@@ -245,6 +272,588 @@ out:
     return rc;
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Finds the object of the given type that contains all of cpuset. Unlike
+ * get_obj_covering_cur_bind, which settles for the first object that
+ * intersects, this finds nothing (QUO_ERR_NOT_FOUND) when cpuset spans more
+ * than one object.
+ */
+static int
+get_obj_containing(const quo_hwloc_t *hwloc,
+                   QUO_obj_type_t type,
+                   hwloc_const_cpuset_t cpuset,
+                   hwloc_obj_t *out_obj)
+{
+    int rc = QUO_ERR;
+    hwloc_cpuset_t clipped = NULL;
+    hwloc_obj_type_t real_type = HWLOC_OBJ_MACHINE;
+
+    if (!hwloc || !cpuset || !out_obj) return QUO_ERR_INVLD_ARG;
+    *out_obj = NULL;
+    if (QUO_SUCCESS != (rc = ext2intobj(type, &real_type))) return rc;
+    /* an unbound process may be allowed on more than what the topology knows
+     * about, so only consider the part of cpuset that we can see. */
+    if (NULL == (clipped = hwloc_bitmap_dup(cpuset))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    hwloc_bitmap_and(clipped, clipped,
+                     hwloc_topology_get_topology_cpuset(hwloc->topo));
+    rc = QUO_ERR_NOT_FOUND;
+    if (hwloc_bitmap_iszero(clipped)) goto out;
+    /* NUMA nodes aren't in the cpu parent chain, so just look at them all. */
+    for (hwloc_obj_t obj = hwloc_get_next_obj_by_type(hwloc->topo,
+                                                      real_type, NULL);
+         NULL != obj;
+         obj = hwloc_get_next_obj_by_type(hwloc->topo, real_type, obj)) {
+        if (obj->cpuset && hwloc_bitmap_isincluded(clipped, obj->cpuset)) {
+            *out_obj = obj;
+            rc = QUO_SUCCESS;
+            break;
+        }
+    }
+out:
+    hwloc_bitmap_free(clipped);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+get_obj_containing_cur_bind(const quo_hwloc_t *hwloc,
+                            QUO_obj_type_t type,
+                            hwloc_obj_t *out_obj)
+{
+    int rc = QUO_ERR;
+    hwloc_cpuset_t curbind = NULL;
+
+    if (!hwloc || !out_obj) return QUO_ERR_INVLD_ARG;
+    if (QUO_SUCCESS != (rc = get_cur_bind(hwloc, hwloc->mypid, &curbind))) {
+        return rc;
+    }
+    rc = get_obj_containing(hwloc, type, curbind, out_obj);
+    hwloc_bitmap_free(curbind);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * \note Caller is responsible for freeing returned resources.
+ */
+int
+quo_hwloc_get_cur_bind(const quo_hwloc_t *hwloc,
+                       hwloc_cpuset_t *out_cpuset)
+{
+    if (!hwloc || !out_cpuset) return QUO_ERR_INVLD_ARG;
+    return get_cur_bind(hwloc, hwloc->mypid, out_cpuset);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the cpuset of the type_index-th object of the given type. The
+ * returned cpuset belongs to the topology, so don't free or modify it.
+ */
+int
+quo_hwloc_get_obj_cpuset(const quo_hwloc_t *hwloc,
+                         QUO_obj_type_t type,
+                         unsigned type_index,
+                         hwloc_const_cpuset_t *out_cpuset)
+{
+    int rc = QUO_ERR;
+    hwloc_obj_t obj = NULL;
+
+    if (!hwloc || !out_cpuset) return QUO_ERR_INVLD_ARG;
+    if (QUO_SUCCESS != (rc = get_obj_by_type(hwloc, type, type_index, &obj))) {
+        return rc;
+    }
+    *out_cpuset = obj->cpuset;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the union of the cpusets of the objects of the given type that my
+ * current binding touches: the one object that contains it if we are bound
+ * within one, and more if the binding spans objects.
+ *
+ * \note Caller is responsible for freeing returned resources.
+ */
+int
+quo_hwloc_get_objs_cpuset_touching_cur_bind(const quo_hwloc_t *hwloc,
+                                            QUO_obj_type_t type,
+                                            hwloc_cpuset_t *out_cpuset)
+{
+    int rc = QUO_ERR;
+    hwloc_cpuset_t curbind = NULL;
+    hwloc_obj_type_t real_type = HWLOC_OBJ_MACHINE;
+
+    if (!hwloc || !out_cpuset) return QUO_ERR_INVLD_ARG;
+    *out_cpuset = NULL;
+    if (QUO_SUCCESS != (rc = ext2intobj(type, &real_type))) return rc;
+    if (QUO_SUCCESS != (rc = get_cur_bind(hwloc, hwloc->mypid, &curbind))) {
+        return rc;
+    }
+    if (NULL == (*out_cpuset = hwloc_bitmap_alloc())) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    for (hwloc_obj_t obj = hwloc_get_next_obj_by_type(hwloc->topo,
+                                                      real_type, NULL);
+         NULL != obj;
+         obj = hwloc_get_next_obj_by_type(hwloc->topo, real_type, obj)) {
+        if (obj->cpuset && hwloc_bitmap_intersects(curbind, obj->cpuset)) {
+            hwloc_bitmap_or(*out_cpuset, *out_cpuset, obj->cpuset);
+        }
+    }
+out:
+    hwloc_bitmap_free(curbind);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the logical index of the object of the given type that contains all
+ * of cpuset, or -1 if there is no such object.
+ */
+int
+quo_hwloc_get_obj_index_containing(const quo_hwloc_t *hwloc,
+                                   QUO_obj_type_t type,
+                                   hwloc_const_cpuset_t cpuset,
+                                   int *out_index)
+{
+    int rc = QUO_ERR;
+    hwloc_obj_t obj = NULL;
+
+    if (!hwloc || !cpuset || !out_index) return QUO_ERR_INVLD_ARG;
+    *out_index = -1;
+    rc = get_obj_containing(hwloc, type, cpuset, &obj);
+    if (QUO_ERR_NOT_FOUND == rc) return QUO_SUCCESS;
+    if (QUO_SUCCESS != rc) return rc;
+    *out_index = (int)obj->logical_index;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the logical index of the object of the given type that contains all
+ * of my current binding, or -1 if there is no such object (e.g., we are
+ * unbound or the binding spans more than one).
+ */
+int
+quo_hwloc_get_obj_index_covering_cur_bind(const quo_hwloc_t *hwloc,
+                                          QUO_obj_type_t type,
+                                          int *out_index)
+{
+    int rc = QUO_ERR;
+    hwloc_obj_t obj = NULL;
+
+    if (!hwloc || !out_index) return QUO_ERR_INVLD_ARG;
+    *out_index = -1;
+    rc = get_obj_containing_cur_bind(hwloc, type, &obj);
+    if (QUO_ERR_NOT_FOUND == rc) return QUO_SUCCESS;
+    if (QUO_SUCCESS != rc) return rc;
+    *out_index = (int)obj->logical_index;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns how close my current binding is to the node's network interface: 2
+ * if it is inside of the interface's locality, 1 if it overlaps it, and 0
+ * otherwise (or if no interface was discovered). High-speed interconnects are
+ * preferred over Ethernet.
+ */
+int
+quo_hwloc_get_nic_closeness(const quo_hwloc_t *hwloc,
+                            int *out_closeness)
+{
+    int rc = QUO_SUCCESS;
+    hwloc_obj_t osdev = NULL, nic = NULL, near = NULL;
+    hwloc_cpuset_t curbind = NULL;
+
+    if (!hwloc || !out_closeness) return QUO_ERR_INVLD_ARG;
+    *out_closeness = 0;
+
+    while (NULL != (osdev = hwloc_get_next_osdev(hwloc->topo, osdev))) {
+        if (HWLOC_OBJ_OSDEV_OPENFABRICS == osdev->attr->osdev.type) {
+            nic = osdev;
+            break;
+        }
+        if (!nic && HWLOC_OBJ_OSDEV_NETWORK == osdev->attr->osdev.type) {
+            nic = osdev;
+        }
+    }
+    if (!nic) return QUO_SUCCESS;
+    near = hwloc_get_non_io_ancestor_obj(hwloc->topo, nic);
+    if (!near || !near->cpuset) return QUO_SUCCESS;
+    if (QUO_SUCCESS != (rc = get_cur_bind(hwloc, hwloc->mypid, &curbind))) {
+        return rc;
+    }
+    if (hwloc_bitmap_isincluded(curbind, near->cpuset)) {
+        *out_closeness = 2;
+    }
+    else if (hwloc_bitmap_intersects(curbind, near->cpuset)) {
+        *out_closeness = 1;
+    }
+    hwloc_bitmap_free(curbind);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the objects of the given type that intersect cpuset (in logical
+ * order, so neighbors share as much of the cache hierarchy as possible).
+ *
+ * \note Caller is responsible for freeing returned resources.
+ */
+static int
+get_objs_intersecting(const quo_hwloc_t *hwloc,
+                      hwloc_const_cpuset_t cpuset,
+                      QUO_obj_type_t type,
+                      int *out_nobjs,
+                      hwloc_obj_t **out_objs)
+{
+    int rc = QUO_SUCCESS, nobjs = 0;
+    hwloc_obj_type_t real_type = HWLOC_OBJ_MACHINE;
+    hwloc_obj_t obj = NULL;
+
+    *out_nobjs = 0; *out_objs = NULL;
+    if (QUO_SUCCESS != (rc = ext2intobj(type, &real_type))) return rc;
+    const int nall = hwloc_get_nbobjs_by_type(hwloc->topo, real_type);
+    if (nall <= 0) return QUO_SUCCESS;
+    if (NULL == (*out_objs = calloc(nall, sizeof(hwloc_obj_t)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    while (NULL != (obj = hwloc_get_next_obj_by_type(hwloc->topo,
+                                                     real_type, obj))) {
+        if (obj->cpuset && hwloc_bitmap_intersects(obj->cpuset, cpuset)) {
+            (*out_objs)[nobjs++] = obj;
+        }
+    }
+    *out_nobjs = nobjs;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Splits our current binding into nparts contiguous chunks along topology
+ * boundaries and returns chunk part. We start at the provided granularity and
+ * fall back to cores and then PUs when there are fewer objects than parts. If
+ * there are fewer PUs than parts, then parts share PUs.
+ *
+ * \note Caller is responsible for freeing returned resources.
+ */
+int
+quo_hwloc_get_split_cpuset(const quo_hwloc_t *hwloc,
+                           int nparts,
+                           int part,
+                           QUO_obj_type_t granularity,
+                           hwloc_cpuset_t *out_cpuset)
+{
+    int rc = QUO_SUCCESS, nobjs = 0;
+    hwloc_cpuset_t curbind = NULL, split = NULL;
+    hwloc_obj_t *objs = NULL;
+    hwloc_obj_type_t real_type = HWLOC_OBJ_MACHINE;
+
+    if (!hwloc || !out_cpuset) return QUO_ERR_INVLD_ARG;
+    if (nparts <= 0 || part < 0 || part >= nparts) return QUO_ERR_INVLD_ARG;
+    if (QUO_SUCCESS != (rc = ext2intobj(granularity, &real_type))) return rc;
+    *out_cpuset = NULL;
+
+    if (QUO_SUCCESS != (rc = get_cur_bind(hwloc, hwloc->mypid, &curbind))) {
+        return rc;
+    }
+    /* QUO_obj_type_t values increase as objects get finer (caches aside,
+     * which fall back to cores) */
+    const int first = (QUO_OBJ_L3CACHE == granularity) ? QUO_OBJ_CORE
+                                                       : (int)granularity;
+    if (first != (int)granularity) {
+        rc = get_objs_intersecting(hwloc, curbind, granularity, &nobjs, &objs);
+        if (QUO_SUCCESS != rc) goto out;
+    }
+    for (int type = first; nobjs < nparts && type <= QUO_OBJ_PU; ++type) {
+        /* only fall back to types that are always nested in one another */
+        if (type != first && type != QUO_OBJ_CORE && type != QUO_OBJ_PU) {
+            continue;
+        }
+        if (objs) { free(objs); objs = NULL; }
+        rc = get_objs_intersecting(hwloc, curbind, (QUO_obj_type_t)type,
+                                   &nobjs, &objs);
+        if (QUO_SUCCESS != rc) goto out;
+        if (nobjs >= nparts) break;
+    }
+    if (0 == nobjs) {
+        rc = QUO_ERR_TOPO;
+        goto out;
+    }
+    if (NULL == (split = hwloc_bitmap_alloc())) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    /* near-equal chunks [begin, end). if nobjs < nparts (too few PUs), every
+     * part gets a single, possibly shared, object. */
+    int begin = (int)(((long)part * nobjs) / nparts);
+    int end = (int)(((long)(part + 1) * nobjs) / nparts);
+    if (end <= begin) end = begin + 1;
+    for (int i = begin; i < end; ++i) {
+        hwloc_bitmap_or(split, split, objs[i]->cpuset);
+    }
+    /* objects may only partially overlap our binding */
+    hwloc_bitmap_and(split, split, curbind);
+    *out_cpuset = split;
+out:
+    if (curbind) hwloc_bitmap_free(curbind);
+    if (objs) free(objs);
+    if (QUO_SUCCESS != rc && split) hwloc_bitmap_free(split);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the objects of the given type that are inside cpuset (in logical
+ * order).
+ *
+ * \note Caller is responsible for freeing returned resources.
+ */
+static int
+get_objs_inside(const quo_hwloc_t *hwloc,
+                hwloc_const_cpuset_t cpuset,
+                QUO_obj_type_t type,
+                int *out_nobjs,
+                hwloc_obj_t **out_objs)
+{
+    int rc = QUO_SUCCESS, nobjs = 0;
+    hwloc_obj_type_t real_type = HWLOC_OBJ_MACHINE;
+    hwloc_obj_t obj = NULL;
+
+    *out_nobjs = 0; *out_objs = NULL;
+    if (QUO_SUCCESS != (rc = ext2intobj(type, &real_type))) return rc;
+    const int nall = hwloc_get_nbobjs_by_type(hwloc->topo, real_type);
+    if (nall <= 0) return QUO_SUCCESS;
+    if (NULL == (*out_objs = calloc(nall, sizeof(hwloc_obj_t)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    while (NULL != (obj = hwloc_get_next_obj_inside_cpuset_by_type(
+                              hwloc->topo, cpuset, real_type, obj))) {
+        (*out_objs)[nobjs++] = obj;
+    }
+    *out_nobjs = nobjs;
+    return QUO_SUCCESS;
+}
+
+/** State shared by the policy_fill recursion. */
+typedef struct policy_fill_t {
+    const quo_hwloc_t *hwloc;
+    const QUO_policy_t *policy;
+    /** Number of levels that distribute (excludes a trailing pe_type level). */
+    int ndist;
+    /** How pe_type objects are handed out within the innermost object. */
+    QUO_policy_mode_t leaf_mode;
+    int nslots;
+    hwloc_cpuset_t *slots;
+} policy_fill_t;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Number of processes that fit in cpuset (pe pe_type objects each).
+ */
+static int
+policy_capacity(const policy_fill_t *pf,
+                hwloc_const_cpuset_t cpuset,
+                int *out_cap)
+{
+    int rc = QUO_SUCCESS, npes = 0;
+    hwloc_obj_t *pes = NULL;
+
+    rc = get_objs_inside(pf->hwloc, cpuset, pf->policy->pe_type, &npes, &pes);
+    if (pes) free(pes);
+    *out_cap = npes / pf->policy->pe;
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Places k processes inside cpuset, starting at the given policy level.
+ */
+static int
+policy_fill(policy_fill_t *pf,
+            hwloc_const_cpuset_t cpuset,
+            int level,
+            int k)
+{
+    int rc = QUO_SUCCESS, nobjs = 0;
+    int *caps = NULL, *counts = NULL;
+    hwloc_obj_t *objs = NULL;
+    const QUO_policy_t *policy = pf->policy;
+
+    /* innermost object: every process gets pe consecutive pe_type objects.
+     * packed processes are neighbors, spread ones are evenly spaced. */
+    if (level == pf->ndist) {
+        rc = get_objs_inside(pf->hwloc, cpuset, policy->pe_type, &nobjs, &objs);
+        if (QUO_SUCCESS != rc) goto out;
+        if (k * policy->pe > nobjs) {
+            rc = QUO_ERR_INVLD_ARG;
+            goto out;
+        }
+        for (int r = 0; r < k; ++r) {
+            const int first = (QUO_POLICY_PACK == pf->leaf_mode) ?
+                              r * policy->pe :
+                              (int)(((long)r * nobjs) / k);
+            hwloc_cpuset_t slot = hwloc_bitmap_alloc();
+            if (!slot) {
+                QUO_OOR_COMPLAIN();
+                rc = QUO_ERR_OOR;
+                goto out;
+            }
+            for (int i = first; i < first + policy->pe; ++i) {
+                hwloc_bitmap_or(slot, slot, objs[i]->cpuset);
+            }
+            pf->slots[pf->nslots++] = slot;
+        }
+        goto out;
+    }
+    rc = get_objs_inside(pf->hwloc, cpuset, policy->levels[level].type,
+                         &nobjs, &objs);
+    if (QUO_SUCCESS != rc) goto out;
+    caps = calloc(nobjs > 0 ? nobjs : 1, sizeof(*caps));
+    counts = calloc(nobjs > 0 ? nobjs : 1, sizeof(*counts));
+    if (!caps || !counts) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    int total = 0;
+    for (int i = 0; i < nobjs; ++i) {
+        rc = policy_capacity(pf, objs[i]->cpuset, &caps[i]);
+        if (QUO_SUCCESS != rc) goto out;
+        total += caps[i];
+    }
+    /* the policy doesn't fit this machine */
+    if (k > total) {
+        rc = QUO_ERR_INVLD_ARG;
+        goto out;
+    }
+    if (QUO_POLICY_PACK == policy->levels[level].mode) {
+        for (int i = 0, left = k; i < nobjs && left > 0; ++i) {
+            counts[i] = (caps[i] < left) ? caps[i] : left;
+            left -= counts[i];
+        }
+    }
+    else {
+        /* round-robin over the objects that still have room */
+        for (int left = k; left > 0; ) {
+            for (int i = 0; i < nobjs && left > 0; ++i) {
+                if (counts[i] < caps[i]) { counts[i]++; left--; }
+            }
+        }
+    }
+    for (int i = 0; i < nobjs; ++i) {
+        if (0 == counts[i]) continue;
+        rc = policy_fill(pf, objs[i]->cpuset, level + 1, counts[i]);
+        if (QUO_SUCCESS != rc) goto out;
+    }
+out:
+    if (objs) free(objs);
+    if (caps) free(caps);
+    if (counts) free(counts);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Evaluates a hierarchical distribution policy against the topology. Returns
+ * one cpuset (slot) per process that the policy places: ppr slots for every
+ * ppr_type object, in topology order. A trailing level of type pe_type only
+ * selects how pe_type objects are handed out within the innermost object.
+ *
+ * \note Caller is responsible for freeing returned resources.
+ */
+int
+quo_hwloc_policy_slots(const quo_hwloc_t *hwloc,
+                       const QUO_policy_t *policy,
+                       int *out_nslots,
+                       hwloc_cpuset_t **out_slots)
+{
+    int rc = QUO_SUCCESS, nppr = 0;
+    hwloc_obj_t *pprs = NULL;
+    policy_fill_t pf;
+
+    if (!hwloc || !policy || !out_nslots || !out_slots) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    if (policy->ppr <= 0 || policy->pe <= 0 || policy->nlevels < 0) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    if (policy->nlevels > 0 && !policy->levels) return QUO_ERR_INVLD_ARG;
+    *out_nslots = 0; *out_slots = NULL;
+
+    (void)memset(&pf, 0, sizeof(pf));
+    pf.hwloc = hwloc;
+    pf.policy = policy;
+    pf.ndist = policy->nlevels;
+    pf.leaf_mode = QUO_POLICY_PACK;
+    for (int l = 0; l < policy->nlevels; ++l) {
+        const QUO_policy_level_t *lvl = &policy->levels[l];
+        if (QUO_POLICY_SPREAD != lvl->mode && QUO_POLICY_PACK != lvl->mode) {
+            return QUO_ERR_INVLD_ARG;
+        }
+        if (lvl->type != policy->pe_type) continue;
+        /* only the last level can be a pe_type level */
+        if (l != policy->nlevels - 1) return QUO_ERR_INVLD_ARG;
+        pf.ndist = l;
+        pf.leaf_mode = lvl->mode;
+    }
+    rc = get_objs_inside(hwloc, hwloc->widest_cpuset, policy->ppr_type,
+                         &nppr, &pprs);
+    if (QUO_SUCCESS != rc) goto out;
+    if (0 == nppr) {
+        rc = QUO_ERR_NOT_FOUND;
+        goto out;
+    }
+    if (NULL == (pf.slots = calloc((size_t)nppr * policy->ppr,
+                                   sizeof(*pf.slots)))) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    for (int o = 0; o < nppr; ++o) {
+        if (QUO_SUCCESS != (rc = policy_fill(&pf, pprs[o]->cpuset, 0,
+                                             policy->ppr))) {
+            goto out;
+        }
+    }
+    *out_nslots = pf.nslots;
+    *out_slots = pf.slots;
+out:
+    if (pprs) free(pprs);
+    if (QUO_SUCCESS != rc && pf.slots) {
+        for (int i = 0; i < pf.nslots; ++i) hwloc_bitmap_free(pf.slots[i]);
+        free(pf.slots);
+    }
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the number of unsigned longs required to hold any cpuset on this
+ * system (see hwloc_bitmap_to_ulongs).
+ */
+int
+quo_hwloc_cpuset_nulongs(const quo_hwloc_t *hwloc,
+                         int *out_nulongs)
+{
+    if (!hwloc || !out_nulongs) return QUO_ERR_INVLD_ARG;
+    const int nulongs = hwloc_bitmap_nr_ulongs(hwloc->widest_cpuset);
+    /* widest cpuset is always finite and non-empty, but be careful anyway */
+    if (nulongs <= 0) return QUO_ERR_TOPO;
+    *out_nulongs = nulongs;
+    return QUO_SUCCESS;
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 static bool
 bind_stack_full(const quo_hwloc_t *hwloc)
@@ -255,7 +864,7 @@ bind_stack_full(const quo_hwloc_t *hwloc)
 /* ////////////////////////////////////////////////////////////////////////// */
 static int
 bind_stack_push(quo_hwloc_t *hwloc,
-                hwloc_cpuset_t cpuset)
+                hwloc_const_cpuset_t cpuset)
 {
     unsigned top = hwloc->bstack.top;
 
@@ -464,6 +1073,8 @@ quo_hwloc_init(quo_hwloc_t *hwloc,
 
     // Set flags as early as possible.
     hwloc->flags = flags;
+    (void)quo_utils_envvar_set(QUO_BIND_STATS_ENV_VAR_STR,
+                               &hwloc->bstats_enabled);
 
     /* Get node communicator so we can chat with our friends. */
     if (QUO_SUCCESS != (qrc = quo_mpi_get_node_comm(mpi, &node_comm))) {
@@ -589,6 +1200,47 @@ out:
     return qrc;
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Initializes hwloc with a synthetic topology (see hwloc's synthetic
+ * description syntax, e.g., "pack:2 numa:2 core:4 pu:2") instead of this
+ * system's. No MPI, no shared memory, and nothing is bound: only topology
+ * queries work. Used to evaluate placement logic offline.
+ */
+int
+quo_hwloc_init_synthetic(quo_hwloc_t *hwloc,
+                         const char *description)
+{
+    int qrc = QUO_SUCCESS;
+
+    if (!hwloc || !description) return QUO_ERR_INVLD_ARG;
+
+    hwloc->mypid = getpid();
+    if (0 != hwloc_topology_init(&(hwloc->topo))) {
+        qrc = QUO_ERR_TOPO;
+        QUO_ERR_MSGRC("hwloc_topology_init", qrc);
+        goto out;
+    }
+    if (0 != hwloc_topology_set_synthetic(hwloc->topo, description)) {
+        qrc = QUO_ERR_INVLD_ARG;
+        goto out;
+    }
+    if (0 != hwloc_topology_load(hwloc->topo)) {
+        qrc = QUO_ERR_TOPO;
+        QUO_ERR_MSGRC("hwloc_topology_load", qrc);
+        goto out;
+    }
+    if (NULL == (hwloc->widest_cpuset = hwloc_bitmap_dup(
+                     hwloc_get_root_obj(hwloc->topo)->cpuset))) {
+        QUO_OOR_COMPLAIN();
+        qrc = QUO_ERR_OOR;
+        goto out;
+    }
+out:
+    if (QUO_SUCCESS != qrc) (void)quo_hwloc_destruct(hwloc);
+    return qrc;
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 int
 quo_hwloc_destruct(quo_hwloc_t *hwloc)
@@ -750,45 +1402,266 @@ quo_hwloc_stringify_cbind(const quo_hwloc_t *hwloc,
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Lets everyone on the node know that some binding changed.
+ */
+static void
+bump_bind_epoch(const quo_hwloc_t *hwloc)
+{
+    if (hwloc->bind_epoch) (void)quo_atomic_fetch_add_u64(hwloc->bind_epoch, 1);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Counts our threads that last ran outside of cpuset. If running_only, then
+ * only runnable threads are considered (sleeping threads move when they wake).
+ * Uses the processor field (39) of /proc/self/task/[tid]/stat.
+ */
+static int
+ntasks_outside_cpuset(hwloc_const_cpuset_t cpuset,
+                      bool running_only,
+                      int *out_ntasks)
+{
+#ifdef HAVE_DIRENT_H
+    DIR *dir = NULL;
+    struct dirent *ent = NULL;
+    /* room for any directory entry name */
+    char path[sizeof("/proc/self/task//stat") + NAME_MAX], buf[1024];
+    int ntasks = 0;
+
+    if (NULL == (dir = opendir("/proc/self/task"))) {
+        return QUO_ERR_NOT_SUPPORTED;
+    }
+    while (NULL != (ent = readdir(dir))) {
+        if ('.' == ent->d_name[0]) continue;
+        snprintf(path, sizeof(path), "/proc/self/task/%s/stat", ent->d_name);
+        FILE *statf = fopen(path, "r");
+        /* the thread may have exited since we read the directory */
+        if (!statf) continue;
+        const size_t n = fread(buf, 1, sizeof(buf) - 1, statf);
+        fclose(statf);
+        buf[n] = '\0';
+        /* comm (field 2) may contain spaces, so start after its last ')' */
+        char *fp = strrchr(buf, ')');
+        if (!fp || ' ' != fp[1]) continue;
+        fp += 2;
+        const char state = *fp;
+        for (int field = 3; fp && field < 39; ++field) {
+            if (NULL != (fp = strchr(fp, ' '))) fp++;
+        }
+        if (!fp) continue;
+        if (running_only && 'R' != state) continue;
+        if (!hwloc_bitmap_isset(cpuset, (unsigned)atoi(fp))) ntasks++;
+    }
+    closedir(dir);
+    *out_ntasks = ntasks;
+    return QUO_SUCCESS;
+#else
+    QUO_UNUSED(cpuset);
+    QUO_UNUSED(running_only);
+    QUO_UNUSED(out_ntasks);
+    return QUO_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * set_cpubind, but records how long the binding took to take effect.
+ */
 static int
-rebind(const quo_hwloc_t *hwloc,
+set_cpubind_instrumented(quo_hwloc_t *hwloc,
+                         hwloc_const_cpuset_t cpuset,
+                         bool popping)
+{
+    QUO_bind_stats_t *bs = &hwloc->bstats;
+    int nout = 0;
+    /* threads outside of the new cpuset will be forced to move. if we can't
+     * look at /proc, then we can still time the system call. */
+    const bool have_proc =
+        (QUO_SUCCESS == ntasks_outside_cpuset(cpuset, false, &nout));
+
+    const double start = quo_utils_wtime();
+    if (-1 == hwloc_set_cpubind(hwloc->topo, cpuset, HWLOC_CPUBIND_PROCESS)) {
+        return QUO_ERR_NOT_SUPPORTED;
+    }
+    const double bound = quo_utils_wtime();
+    bump_bind_epoch(hwloc);
+    if (popping) bs->npops++;
+    else bs->npushes++;
+    bs->syscall_time += bound - start;
+    if (bound - start > bs->syscall_time_max) {
+        bs->syscall_time_max = bound - start;
+    }
+    if (!have_proc) return QUO_SUCCESS;
+    bs->nmigrations += (unsigned long long)nout;
+    /* wait for all running threads to show up inside of the new cpuset */
+    double now = bound;
+    for (;;) {
+        if (QUO_SUCCESS != ntasks_outside_cpuset(cpuset, true, &nout)) break;
+        now = quo_utils_wtime();
+        if (0 == nout) break;
+        if (now - bound > BIND_SETTLE_TIMEOUT) {
+            bs->nsettle_timeouts++;
+            break;
+        }
+        (void)sched_yield();
+    }
+    bs->settle_time += now - start;
+    if (now - start > bs->settle_time_max) bs->settle_time_max = now - start;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+set_cpubind(quo_hwloc_t *hwloc,
+            hwloc_const_cpuset_t cpuset,
+            bool popping)
+{
+    if (hwloc->bstats_enabled) {
+        return set_cpubind_instrumented(hwloc, cpuset, popping);
+    }
+    if (-1 == hwloc_set_cpubind(hwloc->topo, cpuset, HWLOC_CPUBIND_PROCESS)) {
+        return QUO_ERR_NOT_SUPPORTED;
+    }
+    bump_bind_epoch(hwloc);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Binds us to cpuset without touching the bind stack, the bind stats, or the
+ * node binding epoch. Only for short detours that the caller undoes before
+ * anyone could care (e.g., parking a sleeping process): as far as everyone
+ * else is concerned, our binding never changed.
+ */
+int
+quo_hwloc_set_cpubind_quiet(const quo_hwloc_t *hwloc,
+                            hwloc_const_cpuset_t cpuset)
+{
+    if (!hwloc || !cpuset) return QUO_ERR_INVLD_ARG;
+    if (-1 == hwloc_set_cpubind(hwloc->topo, cpuset, HWLOC_CPUBIND_PROCESS)) {
+        return QUO_ERR_NOT_SUPPORTED;
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Ends a detour started with quo_hwloc_set_cpubind_quiet: binds us to the top
+ * of the bind stack again, just as quietly.
+ */
+int
+quo_hwloc_bind_restore_quiet(quo_hwloc_t *hwloc)
+{
+    int rc = QUO_SUCCESS;
+    hwloc_cpuset_t topbind = NULL;
+
+    if (!hwloc) return QUO_ERR_INVLD_ARG;
+    if (QUO_SUCCESS != (rc = bind_stack_top(hwloc, &topbind))) return rc;
+    rc = quo_hwloc_set_cpubind_quiet(hwloc, topbind);
+    hwloc_bitmap_free(topbind);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+rebind(quo_hwloc_t *hwloc,
        QUO_bind_push_policy_t policy,
        QUO_obj_type_t type,
        unsigned obj_index)
 {
     int rc = QUO_SUCCESS;
     hwloc_obj_t target_obj = NULL;
-    hwloc_cpuset_t cpuset = NULL;
 
     if (!hwloc) return QUO_ERR_INVLD_ARG;
     /* now get the appropriate object based on the given policy */
     if (QUO_BIND_PUSH_PROVIDED == policy) {
         rc = get_obj_by_type(hwloc, type, obj_index, &target_obj);
     }
-    else if (QUO_BIND_PUSH_OBJ) {
+    else if (QUO_BIND_PUSH_OBJ == policy) {
         /* get_obj_covering_cur_bind ignores obj_index */
         rc = get_obj_covering_cur_bind(hwloc, type, &target_obj);
     }
     else {
+        /* QUO_BIND_PUSH_CPUSET has no object: see quo_hwloc_bind_push_cpuset */
         rc = QUO_ERR_INVLD_ARG;
     }
-    if (QUO_SUCCESS != rc) goto out;
-    /* now allocate and copy the given obj's cpuset */
+    if (QUO_SUCCESS != rc) return rc;
+    /* set the policy */
+    return set_cpubind(hwloc, target_obj->cpuset, false);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Parses either an hwloc list string (e.g., "0-5,24") or an hwloc bitmask
+ * string (e.g., "0x0100003f") and makes sure that the result is something that
+ * we can actually bind to.
+ *
+ * \note Caller is responsible for freeing returned resources.
+ */
+int
+quo_hwloc_cpuset_from_str(const quo_hwloc_t *hwloc,
+                          const char *str,
+                          hwloc_cpuset_t *out_cpuset)
+{
+    int rc = QUO_SUCCESS;
+    hwloc_cpuset_t cpuset = NULL;
+
+    if (!hwloc || !str || !out_cpuset) return QUO_ERR_INVLD_ARG;
+    *out_cpuset = NULL;
+
     if (NULL == (cpuset = hwloc_bitmap_alloc())) {
+        QUO_OOR_COMPLAIN();
         return QUO_ERR_OOR;
     }
-    /* make a copy of the obj's cpuset */
-    hwloc_bitmap_copy(cpuset, target_obj->cpuset);
-    /* set the policy */
-    if (-1 == hwloc_set_cpubind(hwloc->topo, cpuset, HWLOC_CPUBIND_PROCESS)) {
-        rc = QUO_ERR_NOT_SUPPORTED;
+    /* skip any leading whitespace so " 0x3" is treated like "0x3" */
+    while (' ' == *str || '\t' == *str) ++str;
+    /* bitmask strings always start with 0x, so use that as our hint */
+    const bool is_mask = ('0' == str[0] && ('x' == str[1] || 'X' == str[1]));
+    const int prc = is_mask ? hwloc_bitmap_sscanf(cpuset, str)
+                            : hwloc_bitmap_list_sscanf(cpuset, str);
+    if (0 != prc) {
+        fprintf(stderr, QUO_ERR_PREFIX"cannot parse cpuset string: %s\n", str);
+        rc = QUO_ERR_INVLD_ARG;
+        goto out;
+    }
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_validate(hwloc, cpuset))) {
         goto out;
     }
+    *out_cpuset = cpuset;
 out:
-    if (cpuset) hwloc_bitmap_free(cpuset);
+    if (QUO_SUCCESS != rc) {
+        if (cpuset) hwloc_bitmap_free(cpuset);
+    }
     return rc;
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * A cpuset is valid if it isn't empty and we are allowed to run on all of it.
+ */
+int
+quo_hwloc_cpuset_validate(const quo_hwloc_t *hwloc,
+                          hwloc_const_cpuset_t cpuset)
+{
+    if (!hwloc || !cpuset) return QUO_ERR_INVLD_ARG;
+
+    hwloc_const_cpuset_t allowed = hwloc_topology_get_allowed_cpuset(
+                                       hwloc->topo
+                                   );
+    if (hwloc_bitmap_iszero(cpuset) ||
+        !hwloc_bitmap_isincluded(cpuset, allowed) ||
+        !hwloc_bitmap_isincluded(cpuset, hwloc->widest_cpuset)) {
+        char *cstr = NULL;
+        (void)hwloc_bitmap_list_asprintf(&cstr, cpuset);
+        fprintf(stderr, QUO_ERR_PREFIX"invalid cpuset: '%s' is either empty "
+                "or not within the allowed cpuset.\n", cstr ? cstr : "?");
+        if (cstr) free(cstr);
+        return QUO_ERR_INVLD_ARG;
+    }
+    return QUO_SUCCESS;
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 int
 quo_hwloc_bind_push(quo_hwloc_t *hwloc,
@@ -804,6 +1677,10 @@ quo_hwloc_bind_push(quo_hwloc_t *hwloc,
         QUO_ERR_MSG("invalid policy");
         return QUO_ERR_INVLD_ARG;
     }
+    if (QUO_BIND_PUSH_CPUSET == policy) {
+        QUO_ERR_MSG("QUO_BIND_PUSH_CPUSET requires QUO_bind_push_cpuset");
+        return QUO_ERR_INVLD_ARG;
+    }
     /* change binding */
     if (QUO_SUCCESS != (rc = rebind(hwloc, policy, type, obj_index))) {
         return rc;
@@ -812,6 +1689,78 @@ quo_hwloc_bind_push(quo_hwloc_t *hwloc,
     return push_cur_bind(hwloc);
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_hwloc_bind_push_cpuset(quo_hwloc_t *hwloc,
+                           hwloc_const_cpuset_t cpuset)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!hwloc || !cpuset) return QUO_ERR_INVLD_ARG;
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_validate(hwloc, cpuset))) {
+        return rc;
+    }
+    /* fail early so we don't change our binding without recording it */
+    if (bind_stack_full(hwloc)) return QUO_ERR_OOR;
+    if (QUO_SUCCESS != (rc = set_cpubind(hwloc, cpuset, false))) return rc;
+    /* the cpuset was validated, so record it directly instead of asking the
+     * OS for what we just gave it. this saves a syscall per push. */
+    return bind_stack_push(hwloc, cpuset);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Replaces the top of the bind stack with the given cpuset and binds to it.
+ * Used to adopt a binding that was chosen by another node process.
+ */
+int
+quo_hwloc_bind_replace_top(quo_hwloc_t *hwloc,
+                           hwloc_const_cpuset_t cpuset)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!hwloc || !cpuset) return QUO_ERR_INVLD_ARG;
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_validate(hwloc, cpuset))) {
+        return rc;
+    }
+    /* stack is empty -- nothing to replace */
+    if (hwloc->bstack.top <= 0) return QUO_ERR_POP;
+    if (QUO_SUCCESS != (rc = set_cpubind(hwloc, cpuset, false))) return rc;
+    hwloc_bitmap_copy(hwloc->bstack.bind_stack[hwloc->bstack.top - 1], cpuset);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Binds (all threads of) process pid to the given cpuset. pid need not be us.
+ */
+int
+quo_hwloc_set_proc_cpubind(const quo_hwloc_t *hwloc,
+                           pid_t pid,
+                           hwloc_const_cpuset_t cpuset)
+{
+    if (!hwloc || !cpuset) return QUO_ERR_INVLD_ARG;
+    if (-1 == hwloc_set_proc_cpubind(hwloc->topo, pid, cpuset,
+                                     HWLOC_CPUBIND_PROCESS)) {
+        return QUO_ERR_NOT_SUPPORTED;
+    }
+    bump_bind_epoch(hwloc);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the number of bindings on the bind stack.
+ */
+int
+quo_hwloc_bind_stack_depth(const quo_hwloc_t *hwloc,
+                           int *out_depth)
+{
+    if (!hwloc || !out_depth) return QUO_ERR_INVLD_ARG;
+    *out_depth = (int)hwloc->bstack.top;
+    return QUO_SUCCESS;
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 int
 quo_hwloc_bind_pop(quo_hwloc_t *hwloc)
@@ -823,11 +1772,50 @@ quo_hwloc_bind_pop(quo_hwloc_t *hwloc)
     if (QUO_SUCCESS != (rc = bind_stack_pop(hwloc, NULL))) return rc;
     /* revert to the top binding after pop (the previous binding) */
     if (QUO_SUCCESS != (rc = bind_stack_top(hwloc, &topbind))) goto out;
-    if (-1 == hwloc_set_cpubind(hwloc->topo, topbind, HWLOC_CPUBIND_PROCESS)) {
-        rc = QUO_ERR_NOT_SUPPORTED;
-        goto out;
-    }
+    if (QUO_SUCCESS != (rc = set_cpubind(hwloc, topbind, true))) goto out;
 out:
     if (topbind) hwloc_bitmap_free(topbind);
     return rc;
 }
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_hwloc_bind_stats_enable(quo_hwloc_t *hwloc,
+                            bool enable)
+{
+    if (!hwloc) return QUO_ERR_INVLD_ARG;
+    hwloc->bstats_enabled = enable;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_hwloc_bind_stats(const quo_hwloc_t *hwloc,
+                     QUO_bind_stats_t *stats)
+{
+    if (!hwloc || !stats) return QUO_ERR_INVLD_ARG;
+    *stats = hwloc->bstats;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_hwloc_bind_stats_reset(quo_hwloc_t *hwloc)
+{
+    if (!hwloc) return QUO_ERR_INVLD_ARG;
+    (void)memset(&hwloc->bstats, 0, sizeof(hwloc->bstats));
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Sets the node-wide binding epoch that every binding change bumps.
+ */
+int
+quo_hwloc_set_bind_epoch(quo_hwloc_t *hwloc,
+                         uint64_t *bind_epoch)
+{
+    if (!hwloc) return QUO_ERR_INVLD_ARG;
+    hwloc->bind_epoch = bind_epoch;
+    return QUO_SUCCESS;
+}
@@ -26,6 +26,9 @@
 #ifdef HAVE_STDBOOL_H
 #include <stdbool.h>
 #endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
 
 #include "hwloc/include/hwloc.h"
 
@@ -69,6 +72,47 @@ quo_hwloc_stringify_cbind(const quo_hwloc_t *hwloc,
                           pid_t pid,
                           char **out_str);
 
+int
+quo_hwloc_get_cur_bind(const quo_hwloc_t *hwloc,
+                       hwloc_cpuset_t *out_cpuset);
+
+int
+quo_hwloc_get_obj_cpuset(const quo_hwloc_t *hwloc,
+                         QUO_obj_type_t type,
+                         unsigned type_index,
+                         hwloc_const_cpuset_t *out_cpuset);
+
+int
+quo_hwloc_get_objs_cpuset_touching_cur_bind(const quo_hwloc_t *hwloc,
+                                            QUO_obj_type_t type,
+                                            hwloc_cpuset_t *out_cpuset);
+
+int
+quo_hwloc_get_obj_index_containing(const quo_hwloc_t *hwloc,
+                                   QUO_obj_type_t type,
+                                   hwloc_const_cpuset_t cpuset,
+                                   int *out_index);
+
+int
+quo_hwloc_get_obj_index_covering_cur_bind(const quo_hwloc_t *hwloc,
+                                          QUO_obj_type_t type,
+                                          int *out_index);
+
+int
+quo_hwloc_get_nic_closeness(const quo_hwloc_t *hwloc,
+                            int *out_closeness);
+
+int
+quo_hwloc_get_split_cpuset(const quo_hwloc_t *hwloc,
+                           int nparts,
+                           int part,
+                           QUO_obj_type_t granularity,
+                           hwloc_cpuset_t *out_cpuset);
+
+int
+quo_hwloc_cpuset_nulongs(const quo_hwloc_t *hwloc,
+                         int *out_nulongs);
+
 int
 quo_hwloc_rebind(const quo_hwloc_t *hwloc,
                  QUO_obj_type_t type,
@@ -80,7 +124,65 @@ quo_hwloc_bind_push(quo_hwloc_t *hwloc,
                     QUO_obj_type_t type,
                     unsigned obj_index);
 
+int
+quo_hwloc_bind_push_cpuset(quo_hwloc_t *hwloc,
+                           hwloc_const_cpuset_t cpuset);
+
 int
 quo_hwloc_bind_pop(quo_hwloc_t *hwloc);
 
+int
+quo_hwloc_bind_stack_depth(const quo_hwloc_t *hwloc,
+                           int *out_depth);
+
+int
+quo_hwloc_bind_replace_top(quo_hwloc_t *hwloc,
+                           hwloc_const_cpuset_t cpuset);
+
+int
+quo_hwloc_set_proc_cpubind(const quo_hwloc_t *hwloc,
+                           pid_t pid,
+                           hwloc_const_cpuset_t cpuset);
+
+int
+quo_hwloc_cpuset_from_str(const quo_hwloc_t *hwloc,
+                          const char *str,
+                          hwloc_cpuset_t *out_cpuset);
+
+int
+quo_hwloc_cpuset_validate(const quo_hwloc_t *hwloc,
+                          hwloc_const_cpuset_t cpuset);
+
+int
+quo_hwloc_bind_stats_enable(quo_hwloc_t *hwloc,
+                            bool enable);
+
+int
+quo_hwloc_bind_stats(const quo_hwloc_t *hwloc,
+                     QUO_bind_stats_t *stats);
+
+int
+quo_hwloc_bind_stats_reset(quo_hwloc_t *hwloc);
+
+int
+quo_hwloc_set_cpubind_quiet(const quo_hwloc_t *hwloc,
+                            hwloc_const_cpuset_t cpuset);
+
+int
+quo_hwloc_bind_restore_quiet(quo_hwloc_t *hwloc);
+
+int
+quo_hwloc_set_bind_epoch(quo_hwloc_t *hwloc,
+                         uint64_t *bind_epoch);
+
+int
+quo_hwloc_init_synthetic(quo_hwloc_t *hwloc,
+                         const char *description);
+
+int
+quo_hwloc_policy_slots(const quo_hwloc_t *hwloc,
+                       const QUO_policy_t *policy,
+                       int *out_nslots,
+                       hwloc_cpuset_t **out_slots);
+
 #endif
@@ -27,6 +27,9 @@
 #ifdef HAVE_STDBOOL_H
 #include <stdbool.h>
 #endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
@@ -68,6 +71,23 @@
  * about checking if everything has been setup before continuing with the
  * operation. */
 
+/** Number of QUO_obj_type_t values. */
+#define QUO_MPI_NOBJ_TYPES (QUO_OBJ_L3CACHE + 1)
+/** Number of QUO_leader_policy_t values. */
+#define QUO_MPI_NLEADER_POLICIES (QUO_LEADER_NIC_CLOSEST + 1)
+
+/** A cached communicator (see quo_mpi_get_comm_by_type). */
+typedef struct quo_mpi_comm_cache_t {
+    /** The communicator. MPI_COMM_NULL if I'm not in it. */
+    MPI_Comm comm;
+    /** Whether or not comm has been set up. */
+    bool valid;
+    /** Node binding epoch that comm was set up in. */
+    uint64_t epoch;
+    /** Number of times that comm was lent out and not returned yet. */
+    int nborrowed;
+} quo_mpi_comm_cache_t;
+
 /** Pthread-based inter-process quiescence structure that is embedded in a
  * shared-memory segment (one per node per context). */
 typedef struct quo_shmem_barrier_segment_t {
@@ -98,6 +118,11 @@ struct quo_mpi_t {
     MPI_Comm commchan;
     /** Node communicator. */
     MPI_Comm smpcomm;
+    /**
+     * Node leader (smprank 0) communicator. MPI_COMM_NULL on everyone else.
+     * A leader's rank in it is its node's index.
+     */
+    MPI_Comm leadercomm;
     /** Number of nodes in the current job. */
     int nnodes;
     /** My rank in the user-provided communicator. */
@@ -118,6 +143,27 @@ struct quo_mpi_t {
     quo_shmem_barrier_segment_t *bsegp;
     /** Shared memory instance for node-local barrier. */
     quo_sm_t *barrier_sm;
+    /** If not NULL, used by quo_mpi_sm_barrier instead of the pthread one. */
+    quo_mpi_sm_barrier_fn_t sm_barrier_fn;
+    /** Argument passed to sm_barrier_fn. */
+    void *sm_barrier_arg;
+    /**
+     * Node communicators split by hardware object type (see
+     * get_type_comm). MPI_COMM_NULL if my binding doesn't fit in a single
+     * object of that type.
+     */
+    quo_mpi_comm_cache_t type_comms[QUO_MPI_NOBJ_TYPES];
+    /**
+     * Communicators of the leaders of type_comms[j] across the job, one set
+     * per leader policy i (see get_leader_comm). MPI_COMM_NULL on everyone
+     * else.
+     */
+    quo_mpi_comm_cache_t leader_comms[QUO_MPI_NLEADER_POLICIES]
+                                     [QUO_MPI_NOBJ_TYPES];
+    /** Number of retired communicators. */
+    int nretired;
+    /** Outdated communicators that were still lent out. */
+    quo_mpi_comm_cache_t *retired;
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -225,6 +271,13 @@ smprank_setup(quo_mpi_t *mpi)
         rc = QUO_ERR_MPI;
         goto out;
     }
+    /* node leaders get a communicator of their own */
+    if (MPI_SUCCESS != MPI_Comm_split(mpi->commchan,
+                                      (0 == mpi->smprank) ? 0 : MPI_UNDEFINED,
+                                      mpi->rank, &(mpi->leadercomm))) {
+        rc = QUO_ERR_MPI;
+        goto out;
+    }
 out:
     if (netnums) free(netnums);
     return rc;
@@ -595,6 +648,13 @@ quo_mpi_construct(quo_mpi_t **nmpi)
         QUO_OOR_COMPLAIN();
         return QUO_ERR_OOR;
     }
+    m->leadercomm = MPI_COMM_NULL;
+    for (int i = 0; i < QUO_MPI_NOBJ_TYPES; ++i) {
+        m->type_comms[i].comm = MPI_COMM_NULL;
+        for (int p = 0; p < QUO_MPI_NLEADER_POLICIES; ++p) {
+            m->leader_comms[p][i].comm = MPI_COMM_NULL;
+        }
+    }
     if (QUO_SUCCESS != (rc = quo_sm_construct(&(m->barrier_sm)))) {
         fprintf(stderr, QUO_ERR_PREFIX"%s failed. Cannot continue.\n",
                 "quo_sm_construct");
@@ -653,6 +713,29 @@ quo_mpi_destruct(quo_mpi_t *mpi)
     if (mpi->mpi_inited) {
         if (MPI_SUCCESS != MPI_Comm_free(&(mpi->commchan))) nerrs++;
         if (MPI_SUCCESS != MPI_Comm_free(&(mpi->smpcomm))) nerrs++;
+        if (MPI_COMM_NULL != mpi->leadercomm) {
+            if (MPI_SUCCESS != MPI_Comm_free(&(mpi->leadercomm))) nerrs++;
+        }
+        /* borrowed or not, they all go */
+        for (int i = 0; i < QUO_MPI_NOBJ_TYPES; ++i) {
+            for (int p = 0; p < QUO_MPI_NLEADER_POLICIES; ++p) {
+                MPI_Comm *lc = &(mpi->leader_comms[p][i].comm);
+                if (MPI_COMM_NULL == *lc) continue;
+                if (MPI_SUCCESS != MPI_Comm_free(lc)) nerrs++;
+            }
+            MPI_Comm *tc = &(mpi->type_comms[i].comm);
+            if (MPI_COMM_NULL == *tc) continue;
+            if (MPI_SUCCESS != MPI_Comm_free(tc)) nerrs++;
+        }
+        for (int i = 0; i < mpi->nretired; ++i) {
+            if (MPI_SUCCESS != MPI_Comm_free(&(mpi->retired[i].comm))) {
+                nerrs++;
+            }
+        }
+    }
+    if (mpi->retired) {
+        free(mpi->retired);
+        mpi->retired = NULL;
     }
     if (mpi->pid_smprank_map) {
         free(mpi->pid_smprank_map);
@@ -728,34 +811,327 @@ quo_mpi_sm_barrier(const quo_mpi_t *mpi)
 {
     int rc = 0;
     if (!mpi) return QUO_ERR_INVLD_ARG;
+    if (mpi->sm_barrier_fn) return mpi->sm_barrier_fn(mpi->sm_barrier_arg);
     rc = pthread_barrier_wait(&(mpi->bsegp->barrier));
     if (PTHREAD_BARRIER_SERIAL_THREAD != rc && 0 != rc) return QUO_ERR_SYS;
     return QUO_SUCCESS;
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Replaces the node barrier used by quo_mpi_sm_barrier. Collective over the
+ * node: everyone must switch at the same point. A NULL fn restores the pthread
+ * barrier.
+ */
 int
-quo_mpi_get_comm_by_type(const quo_mpi_t *mpi,
+quo_mpi_set_sm_barrier(quo_mpi_t *mpi,
+                       quo_mpi_sm_barrier_fn_t fn,
+                       void *arg)
+{
+    if (!mpi) return QUO_ERR_INVLD_ARG;
+    mpi->sm_barrier_fn = fn;
+    mpi->sm_barrier_arg = fn ? arg : NULL;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Checks whether or not the cached communicator can still be used
+ * (*out_valid): it can until the node binding epoch changes. Everyone in
+ * agree_comm agrees on the answer before anybody acts on it, since setting the
+ * communicator up again is collective (collective over agree_comm). If the
+ * communicator can't be used anymore, then it is freed, or
+ * retired if I still borrow it (quo_mpi_return_comm frees it once it's given
+ * back), and the caller must set it up again.
+ */
+static int
+cache_check(quo_mpi_t *mpi,
+            quo_mpi_comm_cache_t *cache,
+            uint64_t bind_epoch,
+            MPI_Comm agree_comm,
+            bool *out_valid)
+{
+    int valid = cache->valid && bind_epoch == cache->epoch, all = 0;
+
+    *out_valid = false;
+    /* the epoch may have moved between someone's calls, but not another's */
+    if (MPI_SUCCESS != MPI_Allreduce(&valid, &all, 1, MPI_INT, MPI_MIN,
+                                     agree_comm)) {
+        return QUO_ERR_MPI;
+    }
+    if (all) {
+        *out_valid = true;
+        return QUO_SUCCESS;
+    }
+    cache->valid = false;
+    if (MPI_COMM_NULL == cache->comm) return QUO_SUCCESS;
+    /* nobody uses a communicator that they haven't borrowed, so everyone can
+     * let go of theirs on their own time. */
+    if (cache->nborrowed > 0) {
+        quo_mpi_comm_cache_t *retired = realloc(
+            mpi->retired, (mpi->nretired + 1) * sizeof(*retired)
+        );
+        if (!retired) {
+            QUO_OOR_COMPLAIN();
+            return QUO_ERR_OOR;
+        }
+        mpi->retired = retired;
+        mpi->retired[mpi->nretired++] = *cache;
+    }
+    else if (MPI_SUCCESS != MPI_Comm_free(&(cache->comm))) {
+        return QUO_ERR_MPI;
+    }
+    cache->comm = MPI_COMM_NULL;
+    cache->nborrowed = 0;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns (in *out_cache) the node communicator of the processes whose
+ * bindings fall in the same target_type object as mine (obj_index, or -1 if
+ * my binding doesn't fit in a single one, in which case the communicator is
+ * MPI_COMM_NULL). Collective over the node.
+ *
+ * The split is cached until the node binding epoch changes. Node processes may
+ * read different epochs (e.g., someone rebound between two calls), so they
+ * agree on whether to split again before anybody does.
+ */
+static int
+get_type_comm(quo_mpi_t *mpi,
+              QUO_obj_type_t target_type,
+              int obj_index,
+              uint64_t bind_epoch,
+              quo_mpi_comm_cache_t **out_cache)
+{
+    int rc = QUO_SUCCESS;
+    bool valid = false;
+    quo_mpi_comm_cache_t *cache = &(mpi->type_comms[target_type]);
+
+    *out_cache = cache;
+    /* this case is easy. it's a dup of the smp communicator that we already
+     * have, and that never changes. */
+    if (QUO_OBJ_MACHINE == target_type) {
+        if (cache->valid) return QUO_SUCCESS;
+        if (MPI_SUCCESS != MPI_Comm_dup(mpi->smpcomm, &(cache->comm))) {
+            return QUO_ERR_MPI;
+        }
+        cache->valid = true;
+        return QUO_SUCCESS;
+    }
+    rc = cache_check(mpi, cache, bind_epoch, mpi->smpcomm, &valid);
+    if (QUO_SUCCESS != rc || valid) return rc;
+    const int color = (obj_index < 0) ? MPI_UNDEFINED : obj_index;
+    if (MPI_SUCCESS != MPI_Comm_split(mpi->smpcomm, color, mpi->smprank,
+                                      &(cache->comm))) {
+        return QUO_ERR_MPI;
+    }
+    /* processes that changed their own bindings on the way in may have seen
+     * different epochs. remember the newest, so that everyone looks for the
+     * same one next time. */
+    if (MPI_SUCCESS != MPI_Allreduce(&bind_epoch, &(cache->epoch), 1,
+                                     MPI_UINT64_T, MPI_MAX, mpi->smpcomm)) {
+        return QUO_ERR_MPI;
+    }
+    cache->valid = true;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns (in *out_cache) the communicator of the leaders of every
+ * target_type communicator (see get_type_comm) across the job, which is
+ * MPI_COMM_NULL if I'm not one of them. Processes whose bindings don't fit in
+ * a single target_type object lead themselves. Among the others, the one with
+ * the highest closeness wins (lowest node rank on ties), so everyone passes 0
+ * to get the lowest QID. Collective over the job.
+ *
+ * Like the target_type communicators, leader communicators are cached until
+ * the node binding epoch changes. A change on one node can't be seen from the
+ * others, so all processes agree on whether to split them again.
+ */
+static int
+get_leader_comm(quo_mpi_t *mpi,
+                QUO_obj_type_t target_type,
+                int obj_index,
+                QUO_leader_policy_t policy,
+                int closeness,
+                uint64_t bind_epoch,
+                quo_mpi_comm_cache_t **out_cache)
+{
+    int rc = QUO_SUCCESS, leader = 1;
+    bool valid = false;
+    quo_mpi_comm_cache_t *cache = &(mpi->leader_comms[policy][target_type]);
+    quo_mpi_comm_cache_t *type_cache = NULL;
+
+    *out_cache = cache;
+    /* node leaders already have a communicator of their own */
+    if (QUO_OBJ_MACHINE == target_type && QUO_LEADER_LOWEST_QID == policy) {
+        if (cache->valid) return QUO_SUCCESS;
+        if (MPI_COMM_NULL != mpi->leadercomm) {
+            if (MPI_SUCCESS != MPI_Comm_dup(mpi->leadercomm, &(cache->comm))) {
+                return QUO_ERR_MPI;
+            }
+        }
+        cache->valid = true;
+        return QUO_SUCCESS;
+    }
+    /* every node has its own epoch, but the split is over the whole job */
+    rc = cache_check(mpi, cache, bind_epoch, mpi->commchan, &valid);
+    if (QUO_SUCCESS != rc || valid) return rc;
+    rc = get_type_comm(mpi, target_type, obj_index, bind_epoch, &type_cache);
+    if (QUO_SUCCESS != rc) return rc;
+    if (MPI_COMM_NULL != type_cache->comm) {
+        struct { int closeness; int rank; } mine, best;
+        if (MPI_SUCCESS != MPI_Comm_rank(type_cache->comm, &mine.rank)) {
+            return QUO_ERR_MPI;
+        }
+        mine.closeness = (QUO_LEADER_NIC_CLOSEST == policy) ? closeness : 0;
+        if (MPI_SUCCESS != MPI_Allreduce(&mine, &best, 1, MPI_2INT,
+                                         MPI_MAXLOC, type_cache->comm)) {
+            return QUO_ERR_MPI;
+        }
+        leader = (best.rank == mine.rank);
+    }
+    if (MPI_SUCCESS != MPI_Comm_split(mpi->commchan,
+                                      leader ? 0 : MPI_UNDEFINED,
+                                      mpi->rank, &(cache->comm))) {
+        return QUO_ERR_MPI;
+    }
+    /* the epoch that the node agreed on, if there was anything to agree on */
+    cache->epoch = (QUO_OBJ_MACHINE == target_type) ? bind_epoch
+                                                    : type_cache->epoch;
+    cache->valid = true;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Hands out a cached communicator: either a dup that the caller frees, or the
+ * cached communicator itself, which the caller must give back with
+ * quo_mpi_return_comm.
+ */
+static int
+hand_out(quo_mpi_comm_cache_t *cache,
+         bool borrow,
+         MPI_Comm *out_comm)
+{
+    if (MPI_COMM_NULL == cache->comm) return QUO_SUCCESS;
+    if (borrow) {
+        cache->nborrowed++;
+        *out_comm = cache->comm;
+        return QUO_SUCCESS;
+    }
+    if (MPI_SUCCESS != MPI_Comm_dup(cache->comm, out_comm)) return QUO_ERR_MPI;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the node communicator of the processes whose bindings fall in the
+ * same target_type object as mine (see get_type_comm): a dup, or the cached
+ * communicator itself if borrow is set. Collective over the node.
+ */
+int
+quo_mpi_get_comm_by_type(quo_mpi_t *mpi,
                          QUO_obj_type_t target_type,
+                         int obj_index,
+                         uint64_t bind_epoch,
+                         bool borrow,
                          MPI_Comm *out_comm)
 {
+    int rc = QUO_SUCCESS;
+    quo_mpi_comm_cache_t *cache = NULL;
+
     if (!mpi || !out_comm) return QUO_ERR_INVLD_ARG;
+    *out_comm = MPI_COMM_NULL;
 
-    switch (target_type) {
-        case QUO_OBJ_MACHINE:
-        {
-            /* this case is easy. just return a dup of the smp communicator that
-             * we already maintain internally. */
-            if (MPI_SUCCESS != MPI_Comm_dup(mpi->smpcomm, out_comm)) {
-                return QUO_ERR_MPI;
-            }
+    if ((int)target_type < 0 || (int)target_type >= QUO_MPI_NOBJ_TYPES) {
+        return QUO_ERR_NOT_SUPPORTED;
+    }
+    rc = get_type_comm(mpi, target_type, obj_index, bind_epoch, &cache);
+    if (QUO_SUCCESS != rc) return rc;
+    return hand_out(cache, borrow, out_comm);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the communicator of the leaders of every target_type communicator
+ * across the job (see get_leader_comm): a dup, or the cached communicator
+ * itself if borrow is set. Collective over the job.
+ */
+int
+quo_mpi_get_leader_comm_by_type(quo_mpi_t *mpi,
+                                QUO_obj_type_t target_type,
+                                int obj_index,
+                                QUO_leader_policy_t policy,
+                                int closeness,
+                                uint64_t bind_epoch,
+                                bool borrow,
+                                MPI_Comm *out_comm)
+{
+    int rc = QUO_SUCCESS;
+    quo_mpi_comm_cache_t *cache = NULL;
+
+    if (!mpi || !out_comm) return QUO_ERR_INVLD_ARG;
+    *out_comm = MPI_COMM_NULL;
+
+    if ((int)target_type < 0 || (int)target_type >= QUO_MPI_NOBJ_TYPES) {
+        return QUO_ERR_NOT_SUPPORTED;
+    }
+    if ((int)policy < 0 || (int)policy >= QUO_MPI_NLEADER_POLICIES) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    rc = get_leader_comm(mpi, target_type, obj_index, policy, closeness,
+                         bind_epoch, &cache);
+    if (QUO_SUCCESS != rc) return rc;
+    return hand_out(cache, borrow, out_comm);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Gives back a communicator handed out by quo_mpi_get_comm_by_type or
+ * quo_mpi_get_leader_comm_by_type with borrow set, and sets *comm to
+ * MPI_COMM_NULL. Not collective, but the last return of a retired
+ * communicator frees it.
+ */
+int
+quo_mpi_return_comm(quo_mpi_t *mpi,
+                    MPI_Comm *comm)
+{
+    quo_mpi_comm_cache_t *cache = NULL;
+    int retired = -1;
+
+    if (!mpi || !comm) return QUO_ERR_INVLD_ARG;
+    if (MPI_COMM_NULL == *comm) return QUO_SUCCESS;
+
+    for (int i = 0; i < QUO_MPI_NOBJ_TYPES && !cache; ++i) {
+        if (*comm == mpi->type_comms[i].comm) {
+            cache = &(mpi->type_comms[i]);
             break;
         }
-        /* TODO add support for other obj types */
-        default:
-            return QUO_ERR_NOT_SUPPORTED;
+        for (int p = 0; p < QUO_MPI_NLEADER_POLICIES; ++p) {
+            if (*comm == mpi->leader_comms[p][i].comm) {
+                cache = &(mpi->leader_comms[p][i]);
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < mpi->nretired && !cache; ++i) {
+        if (*comm == mpi->retired[i].comm) {
+            cache = &(mpi->retired[i]);
+            retired = i;
+        }
+    }
+    if (!cache || cache->nborrowed <= 0) return QUO_ERR_NOT_FOUND;
+    cache->nborrowed--;
+    *comm = MPI_COMM_NULL;
+    /* nobody will hand out a retired communicator again, so the last one back
+     * turns off the lights. */
+    if (retired >= 0 && 0 == cache->nborrowed) {
+        if (MPI_SUCCESS != MPI_Comm_free(&(cache->comm))) return QUO_ERR_MPI;
+        mpi->retired[retired] = mpi->retired[--mpi->nretired];
     }
-
     return QUO_SUCCESS;
 }
 
@@ -811,3 +1187,81 @@ quo_mpi_get_node_comm(quo_mpi_t *mpi,
 
     return QUO_SUCCESS;
 }
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns libquo's dup of the initializing communicator. Not a dup, so don't
+ * free it.
+ */
+int
+quo_mpi_get_commchan(quo_mpi_t *mpi,
+                     MPI_Comm *comm)
+{
+    if (!mpi || !comm) return QUO_ERR_INVLD_ARG;
+
+    *comm = mpi->commchan;
+
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the node leader communicator: MPI_COMM_NULL if I'm not my node's
+ * leader (smprank 0). Not a dup, so don't free it.
+ */
+int
+quo_mpi_get_leader_comm(quo_mpi_t *mpi,
+                        MPI_Comm *comm)
+{
+    if (!mpi || !comm) return QUO_ERR_INVLD_ARG;
+
+    *comm = mpi->leadercomm;
+
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+quo_mpi_allreduce(const void *sendbuf,
+                  void *recvbuf,
+                  int count,
+                  MPI_Datatype datatype,
+                  MPI_Op op,
+                  MPI_Comm comm)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!sendbuf || !recvbuf) return QUO_ERR_INVLD_ARG;
+
+    if (MPI_SUCCESS != MPI_Allreduce(sendbuf, recvbuf, count, datatype,
+                                     op, comm)) {
+        rc = QUO_ERR_MPI;
+    }
+
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Exclusive scan. Unlike MPI_Exscan, recvbuf is zeroed on rank 0. Only
+ * supports MPI_SUM over MPI_INT.
+ */
+int
+quo_mpi_exscan_int_sum(const int *sendbuf,
+                       int *recvbuf,
+                       int count,
+                       MPI_Comm comm)
+{
+    int rank = 0;
+
+    if (!sendbuf || !recvbuf) return QUO_ERR_INVLD_ARG;
+
+    if (MPI_SUCCESS != MPI_Comm_rank(comm, &rank)) return QUO_ERR_MPI;
+    if (MPI_SUCCESS != MPI_Exscan(sendbuf, recvbuf, count, MPI_INT, MPI_SUM,
+                                  comm)) {
+        return QUO_ERR_MPI;
+    }
+    if (0 == rank) (void)memset(recvbuf, 0, count * sizeof(*recvbuf));
+
+    return QUO_SUCCESS;
+}
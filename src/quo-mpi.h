@@ -22,6 +22,9 @@
 
 #include "mpi.h"
 
+/** Alternative node barrier implementation (see quo_mpi_set_sm_barrier). */
+typedef int (*quo_mpi_sm_barrier_fn_t)(void *arg);
+
 int
 quo_mpi_construct(quo_mpi_t **nmpi);
 
@@ -66,6 +69,10 @@ int
 quo_mpi_get_node_comm(quo_mpi_t *mpi,
                       MPI_Comm *comm);
 
+int
+quo_mpi_get_commchan(quo_mpi_t *mpi,
+                     MPI_Comm *comm);
+
 int
 quo_mpi_bcast(void *buffer,
               int count,
@@ -82,7 +89,47 @@ quo_mpi_allgather(const void *sendbuf,
                   MPI_Datatype recvtype,
                   MPI_Comm comm);
 int
-quo_mpi_get_comm_by_type(const quo_mpi_t *mpi,
+quo_mpi_get_comm_by_type(quo_mpi_t *mpi,
                          QUO_obj_type_t target_type,
+                         int obj_index,
+                         uint64_t bind_epoch,
+                         bool borrow,
                          MPI_Comm *out_comm);
+
+int
+quo_mpi_get_leader_comm_by_type(quo_mpi_t *mpi,
+                                QUO_obj_type_t target_type,
+                                int obj_index,
+                                QUO_leader_policy_t policy,
+                                int closeness,
+                                uint64_t bind_epoch,
+                                bool borrow,
+                                MPI_Comm *out_comm);
+
+int
+quo_mpi_return_comm(quo_mpi_t *mpi,
+                    MPI_Comm *comm);
+
+int
+quo_mpi_get_leader_comm(quo_mpi_t *mpi,
+                        MPI_Comm *comm);
+
+int
+quo_mpi_allreduce(const void *sendbuf,
+                  void *recvbuf,
+                  int count,
+                  MPI_Datatype datatype,
+                  MPI_Op op,
+                  MPI_Comm comm);
+
+int
+quo_mpi_exscan_int_sum(const int *sendbuf,
+                       int *recvbuf,
+                       int count,
+                       MPI_Comm comm);
+
+int
+quo_mpi_set_sm_barrier(quo_mpi_t *mpi,
+                       quo_mpi_sm_barrier_fn_t fn,
+                       void *arg);
 #endif
@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-plan.c Precompiled binding plans.
+ */
+
+/* A plan is computed once (collectively) and then used to switch between
+ * phases cheaply. All the expensive bits (QUO_auto_distrib, topology queries,
+ * and the node-wide exchange of cpusets) happen in QUO_plan_set_phase. Entering
+ * a phase is a local cpubind plus an optional node barrier. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo.h"
+#include "quo-private.h"
+#include "quo-hwloc.h"
+#include "quo-mpi.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+/** Everything that we know about a single phase. */
+typedef struct quo_plan_phase_t {
+    /** Whether or not QUO_plan_set_phase was called for this phase. */
+    bool defined;
+    /** Whether or not I am a member of this phase. */
+    int selected;
+    /** Number of node processes that are members of this phase. */
+    int nmembers;
+    /** Sorted list of member QIDs. */
+    int *members;
+    /** Every node process' cpuset in this phase (indexed by QID). */
+    hwloc_cpuset_t *cpusets;
+} quo_plan_phase_t;
+
+/** Binding plan. */
+struct QUO_plan_t {
+    /** The context this plan was created with. */
+    QUO_t *q;
+    /** Number of phases. */
+    int nphases;
+    /** Array of phases. */
+    quo_plan_phase_t *phases;
+    /** The phase we are currently in (-1 if not in any). */
+    int cur_phase;
+    /** Whether or not entering cur_phase pushed a new binding. */
+    bool pushed;
+    /** Bind stack depth right after entering cur_phase pushed its binding. */
+    int depth;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+phase_reset(const QUO_plan_t *plan,
+            quo_plan_phase_t *phase)
+{
+    if (phase->members) free(phase->members);
+    if (phase->cpusets) {
+        for (int i = 0; i < plan->q->nqid; ++i) {
+            if (phase->cpusets[i]) hwloc_bitmap_free(phase->cpusets[i]);
+        }
+        free(phase->cpusets);
+    }
+    (void)memset(phase, 0, sizeof(*phase));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+valid_phase(const QUO_plan_t *plan,
+            int phase)
+{
+    return (phase >= 0 && phase < plan->nphases);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Exchanges every node process' selection flag and phase cpuset.
+ */
+static int
+phase_xchange(QUO_plan_t *plan,
+              quo_plan_phase_t *phase,
+              hwloc_const_cpuset_t my_cpuset)
+{
+    int rc = QUO_SUCCESS, nulongs = 0;
+    QUO_t *q = plan->q;
+    MPI_Comm node_comm;
+    unsigned long *my_masks = NULL, *all_masks = NULL;
+    int *all_selected = NULL;
+
+    if (QUO_SUCCESS != (rc = quo_mpi_get_node_comm(q->mpi, &node_comm))) {
+        return rc;
+    }
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
+        return rc;
+    }
+    my_masks = calloc(nulongs, sizeof(*my_masks));
+    all_masks = calloc((size_t)nulongs * q->nqid, sizeof(*all_masks));
+    all_selected = calloc(q->nqid, sizeof(*all_selected));
+    phase->cpusets = calloc(q->nqid, sizeof(*phase->cpusets));
+    if (!my_masks || !all_masks || !all_selected || !phase->cpusets) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    (void)hwloc_bitmap_to_ulongs(my_cpuset, (unsigned)nulongs, my_masks);
+    if (QUO_SUCCESS != (rc = quo_mpi_allgather(my_masks, nulongs,
+                                               MPI_UNSIGNED_LONG,
+                                               all_masks, nulongs,
+                                               MPI_UNSIGNED_LONG,
+                                               node_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allgather", rc);
+        goto out;
+    }
+    if (QUO_SUCCESS != (rc = quo_mpi_allgather(&phase->selected, 1, MPI_INT,
+                                               all_selected, 1, MPI_INT,
+                                               node_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allgather", rc);
+        goto out;
+    }
+    for (int qid = 0; qid < q->nqid; ++qid) {
+        if (NULL == (phase->cpusets[qid] = hwloc_bitmap_alloc())) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+        (void)hwloc_bitmap_from_ulongs(phase->cpusets[qid], (unsigned)nulongs,
+                                       &all_masks[(size_t)qid * nulongs]);
+        if (all_selected[qid]) phase->nmembers++;
+    }
+    if (phase->nmembers > 0) {
+        phase->members = calloc(phase->nmembers, sizeof(*phase->members));
+        if (!phase->members) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+        /* walking QIDs in order keeps the member list sorted */
+        for (int qid = 0, m = 0; qid < q->nqid; ++qid) {
+            if (all_selected[qid]) phase->members[m++] = qid;
+        }
+    }
+out:
+    if (my_masks) free(my_masks);
+    if (all_masks) free(all_masks);
+    if (all_selected) free(all_selected);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_plan_create(QUO_t *q,
+                int nphases,
+                QUO_plan_t **plan)
+{
+    QUO_plan_t *newp = NULL;
+
+    if (!q || !plan || nphases <= 0) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *plan = NULL;
+
+    if (NULL == (newp = calloc(1, sizeof(*newp)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (NULL == (newp->phases = calloc(nphases, sizeof(*newp->phases)))) {
+        QUO_OOR_COMPLAIN();
+        free(newp);
+        return QUO_ERR_OOR;
+    }
+    newp->q = q;
+    newp->nphases = nphases;
+    newp->cur_phase = -1;
+    *plan = newp;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_plan_free(QUO_plan_t *plan)
+{
+    /* okay to pass NULL here. just return success */
+    if (!plan) return QUO_SUCCESS;
+    for (int i = 0; i < plan->nphases; ++i) {
+        phase_reset(plan, &plan->phases[i]);
+    }
+    free(plan->phases);
+    free(plan);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_plan_set_phase(QUO_plan_t *plan,
+                   int phase,
+                   QUO_obj_type_t distrib_over_this,
+                   int max_qids_per_res_type)
+{
+    int rc = QUO_ERR, res = -1;
+    hwloc_cpuset_t my_cpuset = NULL;
+
+    if (!plan || !valid_phase(plan, phase)) return QUO_ERR_INVLD_ARG;
+
+    QUO_t *q = plan->q;
+    quo_plan_phase_t *p = &plan->phases[phase];
+    /* phases cannot be redefined while in use */
+    if (phase == plan->cur_phase) return QUO_ERR_INVLD_ARG;
+    phase_reset(plan, p);
+
+    rc = QUO_auto_distrib_assign(q, distrib_over_this, max_qids_per_res_type,
+                                 QUO_AUTO_DISTRIB_NO_FLAGS, &res, NULL);
+    if (QUO_SUCCESS != rc) goto out;
+    p->selected = (-1 != res);
+    /* members get exactly the resource they were assigned to. everyone else
+     * keeps whatever they have now. */
+    if (p->selected) {
+        hwloc_const_cpuset_t res_cpuset = NULL;
+        rc = quo_hwloc_get_obj_cpuset(q->hwloc, distrib_over_this,
+                                      (unsigned)res, &res_cpuset);
+        if (QUO_SUCCESS != rc) goto out;
+        if (NULL == (my_cpuset = hwloc_bitmap_dup(res_cpuset))) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+    }
+    else {
+        rc = quo_hwloc_get_cur_bind(q->hwloc, &my_cpuset);
+    }
+    if (QUO_SUCCESS != rc) goto out;
+    if (QUO_SUCCESS != (rc = phase_xchange(plan, p, my_cpuset))) goto out;
+    p->defined = true;
+out:
+    if (my_cpuset) hwloc_bitmap_free(my_cpuset);
+    if (QUO_SUCCESS != rc) phase_reset(plan, p);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_plan_leave(QUO_plan_t *plan,
+               int sync)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!plan) return QUO_ERR_INVLD_ARG;
+    if (plan->pushed) {
+        int depth = 0;
+        /* only pop what QUO_plan_enter pushed */
+        rc = quo_hwloc_bind_stack_depth(plan->q->hwloc, &depth);
+        if (QUO_SUCCESS != rc) return rc;
+        if (depth != plan->depth) return QUO_ERR_INVLD_ARG;
+        if (QUO_SUCCESS != (rc = quo_rebind_sync(plan->q, NULL))) return rc;
+        if (QUO_SUCCESS != (rc = quo_hwloc_bind_pop(plan->q->hwloc))) {
+            return rc;
+        }
+    }
+    plan->pushed = false;
+    plan->cur_phase = -1;
+    if (sync) return quo_mpi_sm_barrier(plan->q->mpi);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_plan_enter(QUO_plan_t *plan,
+               int phase,
+               int sync,
+               int *out_selected)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!plan || !valid_phase(plan, phase)) return QUO_ERR_INVLD_ARG;
+    const quo_plan_phase_t *p = &plan->phases[phase];
+    if (!p->defined) return QUO_ERR_INVLD_ARG;
+    /* leaving the previous phase is local. only sync once below. */
+    if (-1 != plan->cur_phase) {
+        if (QUO_SUCCESS != (rc = QUO_plan_leave(plan, 0))) return rc;
+    }
+    /* non-members keep their current binding, so there is nothing to do */
+    if (p->selected) {
+        if (QUO_SUCCESS != (rc = quo_rebind_sync(plan->q, NULL))) return rc;
+        rc = quo_hwloc_bind_push_cpuset(plan->q->hwloc,
+                                        p->cpusets[plan->q->qid]);
+        if (QUO_SUCCESS != rc) return rc;
+        plan->pushed = true;
+        rc = quo_hwloc_bind_stack_depth(plan->q->hwloc, &plan->depth);
+        if (QUO_SUCCESS != rc) return rc;
+    }
+    plan->cur_phase = phase;
+    if (out_selected) *out_selected = p->selected;
+    if (sync) return quo_mpi_sm_barrier(plan->q->mpi);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * caller is responsible for freeing *out_qids.
+ */
+int
+QUO_plan_members(const QUO_plan_t *plan,
+                 int phase,
+                 int *out_nqids,
+                 int **out_qids)
+{
+    if (!plan || !out_nqids || !out_qids) return QUO_ERR_INVLD_ARG;
+    if (!valid_phase(plan, phase)) return QUO_ERR_INVLD_ARG;
+    const quo_plan_phase_t *p = &plan->phases[phase];
+    if (!p->defined) return QUO_ERR_INVLD_ARG;
+
+    *out_nqids = 0; *out_qids = NULL;
+    if (0 == p->nmembers) return QUO_SUCCESS;
+    if (NULL == (*out_qids = calloc(p->nmembers, sizeof(int)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    (void)memmove(*out_qids, p->members, p->nmembers * sizeof(int));
+    *out_nqids = p->nmembers;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_plan_stringify_cbind(const QUO_plan_t *plan,
+                         int phase,
+                         int qid,
+                         char **cbind_str)
+{
+    if (!plan || !cbind_str) return QUO_ERR_INVLD_ARG;
+    if (!valid_phase(plan, phase)) return QUO_ERR_INVLD_ARG;
+    if (qid < 0 || qid >= plan->q->nqid) return QUO_ERR_INVLD_ARG;
+    const quo_plan_phase_t *p = &plan->phases[phase];
+    if (!p->defined) return QUO_ERR_INVLD_ARG;
+
+    if (-1 == hwloc_bitmap_list_asprintf(cbind_str, p->cpusets[qid])) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    return QUO_SUCCESS;
+}
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-policy.c Hierarchical distribution policies.
+ */
+
+/* A policy is first turned into a list of slots (one cpuset per process that
+ * it places, see quo_hwloc_policy_slots). Node processes are then matched to
+ * slots: a process keeps to the ppr_type object that its current binding is
+ * in when that object has room, so that memory it already touched stays
+ * close. Everyone else fills the remaining slots in QID order. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo-policy.h"
+#include "quo-private.h"
+#include "quo-hwloc.h"
+#include "quo-mpi.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+free_cpusets(int n,
+             hwloc_cpuset_t *cpusets)
+{
+    if (!cpusets) return;
+    for (int i = 0; i < n; ++i) {
+        if (cpusets[i]) hwloc_bitmap_free(cpusets[i]);
+    }
+    free(cpusets);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Matches nqid processes (with the given current bindings) to the policy's
+ * slots. slot_of_qid[qid] is the slot that qid was matched to, or -1.
+ */
+static int
+policy_match(const quo_hwloc_t *hwloc,
+             const QUO_policy_t *policy,
+             int nslots,
+             int nqid,
+             hwloc_cpuset_t *binds,
+             int *slot_of_qid)
+{
+    int rc = QUO_SUCCESS, nppr = 0;
+    int *next_free = NULL;
+
+    if (QUO_SUCCESS != (rc = quo_hwloc_get_nobjs_by_type(hwloc,
+                                                         policy->ppr_type,
+                                                         &nppr))) {
+        return rc;
+    }
+    /* slots come in groups of ppr, one group per ppr_type object */
+    if (nppr * policy->ppr != nslots) return QUO_ERR_TOPO;
+    if (NULL == (next_free = calloc(nppr, sizeof(*next_free)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    for (int qid = 0; qid < nqid; ++qid) slot_of_qid[qid] = -1;
+    /* first, processes that already live inside a ppr_type object stay */
+    for (int qid = 0; qid < nqid; ++qid) {
+        for (int o = 0; o < nppr; ++o) {
+            hwloc_const_cpuset_t obj_cpuset = NULL;
+            rc = quo_hwloc_get_obj_cpuset(hwloc, policy->ppr_type,
+                                          (unsigned)o, &obj_cpuset);
+            if (QUO_SUCCESS != rc) goto out;
+            if (hwloc_bitmap_iszero(binds[qid]) ||
+                !hwloc_bitmap_isincluded(binds[qid], obj_cpuset)) continue;
+            if (next_free[o] < policy->ppr) {
+                slot_of_qid[qid] = o * policy->ppr + next_free[o]++;
+            }
+            break;
+        }
+    }
+    /* then, everyone else takes what's left */
+    for (int qid = 0, o = 0; qid < nqid; ++qid) {
+        if (-1 != slot_of_qid[qid]) continue;
+        while (o < nppr && next_free[o] >= policy->ppr) ++o;
+        if (o == nppr) break;
+        slot_of_qid[qid] = o * policy->ppr + next_free[o]++;
+    }
+out:
+    if (next_free) free(next_free);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Gathers every node process' current binding.
+ *
+ * \note Caller is responsible for freeing returned resources.
+ */
+static int
+xchange_binds(QUO_t *q,
+              hwloc_cpuset_t **out_binds)
+{
+    int rc = QUO_SUCCESS, nulongs = 0;
+    MPI_Comm node_comm;
+    unsigned long *my_masks = NULL, *all_masks = NULL;
+    hwloc_cpuset_t cur_bind = NULL, *binds = NULL;
+
+    *out_binds = NULL;
+    if (QUO_SUCCESS != (rc = quo_mpi_get_node_comm(q->mpi, &node_comm))) {
+        return rc;
+    }
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
+        return rc;
+    }
+    my_masks = calloc(nulongs, sizeof(*my_masks));
+    all_masks = calloc((size_t)nulongs * q->nqid, sizeof(*all_masks));
+    binds = calloc(q->nqid, sizeof(*binds));
+    if (!my_masks || !all_masks || !binds) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    if (QUO_SUCCESS != (rc = quo_hwloc_get_cur_bind(q->hwloc, &cur_bind))) {
+        goto out;
+    }
+    (void)hwloc_bitmap_to_ulongs(cur_bind, (unsigned)nulongs, my_masks);
+    if (QUO_SUCCESS != (rc = quo_mpi_allgather(my_masks, nulongs,
+                                               MPI_UNSIGNED_LONG,
+                                               all_masks, nulongs,
+                                               MPI_UNSIGNED_LONG,
+                                               node_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allgather", rc);
+        goto out;
+    }
+    for (int qid = 0; qid < q->nqid; ++qid) {
+        if (NULL == (binds[qid] = hwloc_bitmap_alloc())) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+        (void)hwloc_bitmap_from_ulongs(binds[qid], (unsigned)nulongs,
+                                       &all_masks[(size_t)qid * nulongs]);
+    }
+    *out_binds = binds;
+out:
+    if (my_masks) free(my_masks);
+    if (all_masks) free(all_masks);
+    if (cur_bind) hwloc_bitmap_free(cur_bind);
+    if (QUO_SUCCESS != rc) free_cpusets(q->nqid, binds);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_policy_distrib(QUO_t *q,
+                   const QUO_policy_t *policy,
+                   int flags,
+                   int *out_selected,
+                   char **out_cbind)
+{
+    int rc = QUO_ERR, nslots = 0;
+    hwloc_cpuset_t *slots = NULL, *binds = NULL;
+    int *slot_of_qid = NULL;
+
+    if (!q || !policy || !out_selected) return QUO_ERR_INVLD_ARG;
+    if (0 != (flags & ~QUO_AUTO_DISTRIB_BIND_PUSH)) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *out_selected = 0; /* set defaults */
+    if (out_cbind) *out_cbind = NULL;
+
+    /* everyone evaluates the same policy against the same topology, so the
+     * only thing that we need to share is current bindings. */
+    rc = quo_hwloc_policy_slots(q->hwloc, policy, &nslots, &slots);
+    /* still take part in the exchange so nobody is left waiting */
+    int xrc = xchange_binds(q, &binds);
+    if (QUO_SUCCESS != rc) goto out;
+    if (QUO_SUCCESS != (rc = xrc)) goto out;
+    if (NULL == (slot_of_qid = calloc(q->nqid, sizeof(*slot_of_qid)))) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    rc = policy_match(q->hwloc, policy, nslots, q->nqid, binds, slot_of_qid);
+    if (QUO_SUCCESS != rc) goto out;
+    const int my_slot = slot_of_qid[q->qid];
+    if (-1 == my_slot) goto out;
+    if (out_cbind) {
+        if (-1 == hwloc_bitmap_list_asprintf(out_cbind, slots[my_slot])) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+    }
+    if (flags & QUO_AUTO_DISTRIB_BIND_PUSH) {
+        if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) goto out;
+        rc = quo_hwloc_bind_push_cpuset(q->hwloc, slots[my_slot]);
+        if (QUO_SUCCESS != rc) goto out;
+    }
+    *out_selected = 1;
+out:
+    if (QUO_SUCCESS != rc && out_cbind && *out_cbind) {
+        free(*out_cbind);
+        *out_cbind = NULL;
+    }
+    free_cpusets(nslots, slots);
+    free_cpusets(q->nqid, binds);
+    if (slot_of_qid) free(slot_of_qid);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Evaluates a policy offline, against a synthetic topology (see
+ * quo_hwloc_init_synthetic), for nqid processes with the given bindings (hwloc
+ * list strings; NULL means that nobody is bound). Returns the slots as hwloc
+ * list strings and, if out_slot_of_qid isn't NULL, the slot that every
+ * process was matched to (or -1).
+ *
+ * \note Caller is responsible for freeing *out_slots and its strings.
+ */
+int
+quo_policy_eval_synthetic(const char *synthetic,
+                          const QUO_policy_t *policy,
+                          int nqid,
+                          const char *const *binds,
+                          int *out_nslots,
+                          char ***out_slots,
+                          int *out_slot_of_qid)
+{
+    int rc = QUO_ERR, nslots = 0;
+    quo_hwloc_t *hwloc = NULL;
+    hwloc_cpuset_t *slots = NULL, *bind_sets = NULL;
+    char **strs = NULL;
+
+    if (!synthetic || !policy || !out_nslots || !out_slots || nqid < 0) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    *out_nslots = 0; *out_slots = NULL;
+
+    if (QUO_SUCCESS != (rc = quo_hwloc_construct(&hwloc))) return rc;
+    /* on failure, hwloc is destructed for us */
+    if (QUO_SUCCESS != (rc = quo_hwloc_init_synthetic(hwloc, synthetic))) {
+        return rc;
+    }
+    rc = quo_hwloc_policy_slots(hwloc, policy, &nslots, &slots);
+    if (QUO_SUCCESS != rc) goto out;
+    if (out_slot_of_qid && nqid > 0) {
+        if (NULL == (bind_sets = calloc(nqid, sizeof(*bind_sets)))) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+        for (int qid = 0; qid < nqid; ++qid) {
+            if (NULL == (bind_sets[qid] = hwloc_bitmap_alloc())) {
+                QUO_OOR_COMPLAIN();
+                rc = QUO_ERR_OOR;
+                goto out;
+            }
+            if (!binds || !binds[qid]) {
+                hwloc_bitmap_fill(bind_sets[qid]);
+            }
+            else if (0 != hwloc_bitmap_list_sscanf(bind_sets[qid],
+                                                   binds[qid])) {
+                rc = QUO_ERR_INVLD_ARG;
+                goto out;
+            }
+        }
+        rc = policy_match(hwloc, policy, nslots, nqid, bind_sets,
+                          out_slot_of_qid);
+        if (QUO_SUCCESS != rc) goto out;
+    }
+    if (nslots > 0) {
+        if (NULL == (strs = calloc(nslots, sizeof(*strs)))) {
+            QUO_OOR_COMPLAIN();
+            rc = QUO_ERR_OOR;
+            goto out;
+        }
+        for (int i = 0; i < nslots; ++i) {
+            if (-1 == hwloc_bitmap_list_asprintf(&strs[i], slots[i])) {
+                QUO_OOR_COMPLAIN();
+                rc = QUO_ERR_OOR;
+                goto out;
+            }
+        }
+    }
+    *out_nslots = nslots;
+    *out_slots = strs;
+out:
+    if (QUO_SUCCESS != rc && strs) {
+        for (int i = 0; i < nslots; ++i) {
+            if (strs[i]) free(strs[i]);
+        }
+        free(strs);
+    }
+    free_cpusets(nslots, slots);
+    free_cpusets(nqid, bind_sets);
+    (void)quo_hwloc_destruct(hwloc);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns, against a synthetic topology, the logical index of the object of
+ * the given type that a process bound to bind (an hwloc list string; NULL
+ * means unbound) belongs to, or -1 if it doesn't belong to exactly one. This
+ * is the index that QUO_get_mpi_comm_by_type splits on.
+ */
+int
+quo_policy_obj_index_synthetic(const char *synthetic,
+                               QUO_obj_type_t type,
+                               const char *bind,
+                               int *out_index)
+{
+    int rc = QUO_ERR;
+    quo_hwloc_t *hwloc = NULL;
+    hwloc_cpuset_t bind_set = NULL;
+
+    if (!synthetic || !out_index) return QUO_ERR_INVLD_ARG;
+    *out_index = -1;
+
+    if (QUO_SUCCESS != (rc = quo_hwloc_construct(&hwloc))) return rc;
+    /* on failure, hwloc is destructed for us */
+    if (QUO_SUCCESS != (rc = quo_hwloc_init_synthetic(hwloc, synthetic))) {
+        return rc;
+    }
+    if (NULL == (bind_set = hwloc_bitmap_alloc())) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    if (!bind) {
+        hwloc_bitmap_fill(bind_set);
+    }
+    else if (0 != hwloc_bitmap_list_sscanf(bind_set, bind)) {
+        rc = QUO_ERR_INVLD_ARG;
+        goto out;
+    }
+    rc = quo_hwloc_get_obj_index_containing(hwloc, type, bind_set, out_index);
+out:
+    if (bind_set) hwloc_bitmap_free(bind_set);
+    (void)quo_hwloc_destruct(hwloc);
+    return rc;
+}
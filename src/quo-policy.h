@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-policy.h
+ */
+
+#ifndef QUO_POLICY_H_INCLUDED
+#define QUO_POLICY_H_INCLUDED
+
+#include "quo.h"
+
+int
+quo_policy_eval_synthetic(const char *synthetic,
+                          const QUO_policy_t *policy,
+                          int nqid,
+                          const char *const *binds,
+                          int *out_nslots,
+                          char ***out_slots,
+                          int *out_slot_of_qid);
+
+int
+quo_policy_obj_index_synthetic(const char *synthetic,
+                               QUO_obj_type_t type,
+                               const char *bind,
+                               int *out_index);
+
+#endif
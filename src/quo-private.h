@@ -25,6 +25,9 @@
 #ifdef HAVE_STDBOOL_H
 #include <stdbool.h>
 #endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
 
 /** Library version. */
 #define QUO_VER    QUO_VERSION_CURRENT
@@ -115,6 +118,31 @@ typedef struct quo_hwloc_t quo_hwloc_t;
 struct quo_mpi_t;
 typedef struct quo_mpi_t quo_mpi_t;
 
+struct quo_ctrl_t;
+typedef struct quo_ctrl_t quo_ctrl_t;
+
+struct quo_coll_t;
+typedef struct quo_coll_t quo_coll_t;
+
+/** Memoized QUO_auto_distrib state. */
+typedef struct quo_auto_distrib_memo_t {
+    /** Whether or not the cached result is usable. */
+    bool valid;
+    /** Cached arguments. */
+    int type;
+    int max_qids_per_res_type;
+    /** Node binding epoch the cached result was computed at. */
+    uint64_t epoch;
+    /** Cached result: every node process' resource, or -1 (indexed by QID).
+     * Also used as scratch space by uncached (weighted) distributions. */
+    int *assign;
+    /** Whether or not my_masks is usable. */
+    bool my_masks_valid;
+    /** My binding as of my_masks_epoch (saves a syscall per call). */
+    unsigned long *my_masks;
+    uint64_t my_masks_epoch;
+} quo_auto_distrib_memo_t;
+
 /** QUO_t type definition. */
 struct QUO_t {
     /** Whether or not a context has been initialized. */
@@ -125,11 +153,23 @@ struct QUO_t {
     quo_hwloc_t *hwloc;
     /** Handle to MPI instance. */
     quo_mpi_t *mpi;
+    /** Handle to the node control region. */
+    quo_ctrl_t *ctrl;
+    /** Handle to node collectives (initialized on first use). */
+    quo_coll_t *coll;
     /* Information cache. */
     /** My unique QUO ID (node-local). */
     int qid;
     /** Number of processes that share a node with me. */
     int nqid;
+    /** QUO_auto_distrib cache. */
+    quo_auto_distrib_memo_t ad_memo;
+    /** Bind stack depth right after QUO_borrow pushed its binding. */
+    int borrow_depth;
 };
 
+int
+quo_rebind_sync(struct QUO_t *q,
+                bool *out_rebound);
+
 #endif
@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-reorder.c Topology-aware rank reordering.
+ */
+
+/* Reordering only permutes ranks among the processes of a node, so traffic
+ * between nodes stays where it was. On every node, the processes' subdomains
+ * (their original ranks) are handed out to sockets, and then to L3 caches
+ * inside of them, by growing one group at a time around its heaviest
+ * neighbors. Every node process gathers the whole node graph and computes the
+ * same assignment, so no one has to broadcast it. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo.h"
+#include "quo-private.h"
+#include "quo-reorder.h"
+#include "quo-hwloc.h"
+#include "quo-mpi.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+
+/** Number of topology levels considered: sockets, then L3 caches. */
+#define QUO_REORDER_NLEVELS 2
+
+/** Node graph and process locality. */
+typedef struct reorder_t {
+    /** Number of node processes (and subdomains). */
+    int n;
+    /** n x n symmetric subdomain traffic. */
+    const int64_t *weights;
+    /** Per-process object index at every level (-1 if none). */
+    const int *keys[QUO_REORDER_NLEVELS];
+} reorder_t;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static inline int64_t
+traffic(const reorder_t *r,
+        int i,
+        int j)
+{
+    return r->weights[(size_t)i * r->n + j];
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Hands out items to procs (both nprocs long) so that items that talk a lot end
+ * up on processes that share keys[level] (and then deeper levels). Item i
+ * started out on process i, which wins ties, so nothing moves without a
+ * reason. A key of -1 means no locality at that level: such processes share it
+ * with nobody, and they are served after the real groups have picked their
+ * items. Sets owner[item] for every item.
+ */
+static int
+assign(const reorder_t *r,
+       int level,
+       int nprocs,
+       const int *procs,
+       const int *items,
+       int *owner)
+{
+    int rc = QUO_SUCCESS;
+    int *gprocs = NULL, *gitems = NULL;
+    bool *pdone = NULL, *idone = NULL, *ingroup = NULL;
+    int64_t *conn = NULL;
+
+    pdone = calloc(nprocs, sizeof(*pdone));
+    idone = calloc(nprocs, sizeof(*idone));
+    ingroup = calloc(r->n, sizeof(*ingroup));
+    if (!pdone || !idone || !ingroup) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    if (QUO_REORDER_NLEVELS == level) {
+        /* items stay home if they can, and the rest are paired up in order */
+        for (int p = 0; p < nprocs; ++p) ingroup[procs[p]] = true;
+        for (int i = 0; i < nprocs; ++i) {
+            if (!ingroup[items[i]]) continue;
+            owner[items[i]] = items[i];
+            idone[i] = true;
+            ingroup[items[i]] = false;
+        }
+        for (int i = 0, p = 0; i < nprocs; ++i) {
+            if (idone[i]) continue;
+            while (!ingroup[procs[p]]) ++p;
+            owner[items[i]] = procs[p];
+            ingroup[procs[p]] = false;
+        }
+        goto out;
+    }
+    gprocs = calloc(nprocs, sizeof(*gprocs));
+    gitems = calloc(nprocs, sizeof(*gitems));
+    conn = calloc(nprocs, sizeof(*conn));
+    if (!gprocs || !gitems || !conn) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    for (int p = 0; p < 2 * nprocs; ++p) {
+        int ng = 0;
+        const int pp = p % nprocs;
+        const int key = r->keys[level][procs[pp]];
+
+        /* first pass: processes with a key; second: the ones without */
+        if (pdone[pp] || (key < 0) != (p >= nprocs)) continue;
+        (void)memset(ingroup, 0, r->n * sizeof(*ingroup));
+        for (int x = pp; x < nprocs; ++x) {
+            if (pdone[x] || r->keys[level][procs[x]] != key) continue;
+            if (key < 0 && x != pp) continue;
+            pdone[x] = true;
+            gprocs[ng++] = procs[x];
+            ingroup[procs[x]] = true;
+        }
+        /* grow the group around whatever talks to it the most */
+        (void)memset(conn, 0, nprocs * sizeof(*conn));
+        for (int k = 0; k < ng; ++k) {
+            int best = -1;
+            for (int y = 0; y < nprocs; ++y) {
+                if (idone[y]) continue;
+                if (best < 0 || conn[y] > conn[best] ||
+                    (conn[y] == conn[best] &&
+                     ingroup[items[y]] && !ingroup[items[best]])) {
+                    best = y;
+                }
+            }
+            idone[best] = true;
+            gitems[k] = items[best];
+            for (int y = 0; y < nprocs; ++y) {
+                if (!idone[y]) conn[y] += traffic(r, items[y], items[best]);
+            }
+        }
+        rc = assign(r, level + 1, ng, gprocs, gitems, owner);
+        if (QUO_SUCCESS != rc) goto out;
+    }
+out:
+    if (gprocs) free(gprocs);
+    if (gitems) free(gitems);
+    if (pdone) free(pdone);
+    if (idone) free(idone);
+    if (ingroup) free(ingroup);
+    if (conn) free(conn);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the traffic between subdomains whose owners don't share a socket.
+ */
+static int64_t
+cross_socket(const reorder_t *r,
+             const int *owner)
+{
+    int64_t cross = 0;
+
+    for (int i = 0; i < r->n; ++i) {
+        for (int j = i + 1; j < r->n; ++j) {
+            const int64_t w = traffic(r, i, j);
+            if (0 == w) continue;
+            const int si = r->keys[0][owner[i]], sj = r->keys[0][owner[j]];
+            if (si < 0 || si != sj) cross += w;
+        }
+    }
+    return cross;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Assigns n subdomains to n processes given their traffic (n x n, symmetric)
+ * and the sockets and L3 caches that the processes are bound to (-1 if none).
+ * Subdomain i starts out on process i. On return, out_owner[i] is the process
+ * that subdomain i moved to, and the cross-socket traffic is reported before
+ * and after. The result never has more cross-socket traffic than the start.
+ */
+int
+quo_reorder_assign(int n,
+                   const int64_t *weights,
+                   const int *sockets,
+                   const int *l3s,
+                   int *out_owner,
+                   int64_t *out_cross_before,
+                   int64_t *out_cross_after)
+{
+    int rc = QUO_SUCCESS;
+    int *ids = NULL;
+    int64_t before = 0, after = 0;
+    const reorder_t r = {n, weights, {sockets, l3s}};
+
+    if (n <= 0 || !weights || !sockets || !l3s || !out_owner) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    if (NULL == (ids = calloc(n, sizeof(*ids)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    for (int i = 0; i < n; ++i) ids[i] = out_owner[i] = i;
+    before = cross_socket(&r, out_owner);
+    if (QUO_SUCCESS != (rc = assign(&r, 0, n, ids, ids, out_owner))) goto out;
+    after = cross_socket(&r, out_owner);
+    /* greedy isn't always better */
+    if (after > before) {
+        for (int i = 0; i < n; ++i) out_owner[i] = i;
+        after = before;
+    }
+    if (out_cross_before) *out_cross_before = before;
+    if (out_cross_after) *out_cross_after = after;
+out:
+    free(ids);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+int_cmp(const void *a,
+        const void *b)
+{
+    const int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns the worst of everyone's lrc in comm (collective over comm), so that
+ * nobody goes on into a collective that somebody else skips.
+ */
+static int
+agree(MPI_Comm comm,
+      int lrc)
+{
+    int rc = QUO_SUCCESS;
+
+    if (MPI_SUCCESS != MPI_Allreduce(&lrc, &rc, 1, MPI_INT, MPI_MAX, comm)) {
+        return QUO_ERR_MPI;
+    }
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Reorders the initializing communicator given every process' neighbors. Edge
+ * weights default to 1 if weights is NULL. Collective over the initializing
+ * communicator. lrc is my error so far, if any: then I only go along with the
+ * collectives (ignoring my neighbors), and everyone returns an error.
+ */
+static int
+reorder(QUO_t *q,
+        int lrc,
+        int degree,
+        const int *neighbors,
+        const int *weights,
+        MPI_Comm *out_comm,
+        QUO_reorder_info_t *out_info)
+{
+    int rc = QUO_SUCCESS, rank = 0, nranks = 0, mine = -1;
+    const int n = q->nqid;
+    /* rank, socket, L3, and degree of every node process */
+    int me[4] = {0, -1, -1, degree};
+    int *procs = NULL, *ranks = NULL, *sockets = NULL, *l3s = NULL;
+    int *counts = NULL, *displs = NULL, *edges = NULL, *myedges = NULL;
+    int *owner = NULL, *nbrs = NULL, *wts = NULL;
+    int64_t *w = NULL, cross[2] = {0, 0}, sums[2] = {0, 0};
+    MPI_Comm commchan = MPI_COMM_NULL, node_comm = MPI_COMM_NULL;
+    MPI_Comm reordered = MPI_COMM_NULL;
+
+    *out_comm = MPI_COMM_NULL;
+    if (QUO_SUCCESS != (rc = quo_mpi_get_commchan(q->mpi, &commchan))) {
+        return rc;
+    }
+    if (QUO_SUCCESS != (rc = quo_mpi_get_node_comm(q->mpi, &node_comm))) {
+        return rc;
+    }
+    if (MPI_SUCCESS != MPI_Comm_rank(commchan, &rank) ||
+        MPI_SUCCESS != MPI_Comm_size(commchan, &nranks)) {
+        return QUO_ERR_MPI;
+    }
+    for (int i = 0; QUO_SUCCESS == lrc && i < degree; ++i) {
+        if (neighbors[i] < 0 || neighbors[i] >= nranks ||
+            (weights && weights[i] < 0)) {
+            lrc = QUO_ERR_INVLD_ARG;
+        }
+    }
+    if (QUO_SUCCESS != lrc) degree = me[3] = 0;
+    me[0] = rank;
+    /* -1 (unbound, spanning, or failed lookup) means no locality; don't bail
+     * out here, the others are already headed into the collectives below */
+    if (QUO_SUCCESS != quo_hwloc_get_obj_index_covering_cur_bind(
+                           q->hwloc, QUO_OBJ_PACKAGE, &me[1])) {
+        me[1] = -1;
+    }
+    if (QUO_SUCCESS != quo_hwloc_get_obj_index_covering_cur_bind(
+                           q->hwloc, QUO_OBJ_L3CACHE, &me[2])) {
+        me[2] = -1;
+    }
+
+    procs = calloc(4 * n, sizeof(*procs));
+    ranks = calloc(n, sizeof(*ranks));
+    sockets = calloc(n, sizeof(*sockets));
+    l3s = calloc(n, sizeof(*l3s));
+    counts = calloc(n, sizeof(*counts));
+    displs = calloc(n, sizeof(*displs));
+    owner = calloc(n, sizeof(*owner));
+    myedges = calloc(2 * degree + 1, sizeof(*myedges));
+    w = calloc((size_t)n * n, sizeof(*w));
+    if ((!procs || !ranks || !sockets || !l3s || !counts || !displs ||
+         !owner || !myedges || !w) && QUO_SUCCESS == lrc) {
+        QUO_OOR_COMPLAIN();
+        lrc = QUO_ERR_OOR;
+    }
+    /* local errors (bad neighbors, allocations) are only local up to here */
+    if (QUO_SUCCESS != (rc = agree(commchan, lrc))) goto out;
+    rc = quo_mpi_allgather(me, 4, MPI_INT, procs, 4, MPI_INT, node_comm);
+    if (QUO_SUCCESS != rc) goto out;
+    int nedges = 0;
+    for (int i = 0; i < n; ++i) {
+        ranks[i] = procs[4 * i];
+        sockets[i] = procs[4 * i + 1];
+        l3s[i] = procs[4 * i + 2];
+        counts[i] = 2 * procs[4 * i + 3];
+        displs[i] = nedges;
+        nedges += counts[i];
+    }
+    if (NULL == (edges = calloc(nedges + 1, sizeof(*edges)))) {
+        QUO_OOR_COMPLAIN();
+        lrc = QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = agree(commchan, lrc))) goto out;
+    for (int i = 0; i < degree; ++i) {
+        myedges[2 * i] = neighbors[i];
+        myedges[2 * i + 1] = weights ? weights[i] : 1;
+    }
+    if (MPI_SUCCESS != MPI_Allgatherv(myedges, 2 * degree, MPI_INT, edges,
+                                      counts, displs, MPI_INT, node_comm)) {
+        rc = QUO_ERR_MPI;
+        goto out;
+    }
+    /* node processes are ordered by rank, so subdomains are too */
+    for (int i = 0; i < n; ++i) {
+        for (int e = displs[i]; e < displs[i] + counts[i]; e += 2) {
+            const int *found = bsearch(&edges[e], ranks, n, sizeof(int),
+                                       int_cmp);
+            if (!found) continue;
+            const int j = (int)(found - ranks);
+            if (j == i) continue;
+            w[(size_t)i * n + j] += edges[e + 1];
+            w[(size_t)j * n + i] += edges[e + 1];
+        }
+    }
+    lrc = quo_reorder_assign(n, w, sockets, l3s, owner, &cross[0], &cross[1]);
+    for (int i = 0; QUO_SUCCESS == lrc && i < n; ++i) {
+        if (owner[i] == q->qid) mine = i;
+    }
+    const int mydegree = (-1 == mine) ? 0 : counts[mine] / 2;
+    nbrs = calloc(mydegree + 1, sizeof(*nbrs));
+    wts = calloc(mydegree + 1, sizeof(*wts));
+    if ((!nbrs || !wts) && QUO_SUCCESS == lrc) {
+        QUO_OOR_COMPLAIN();
+        lrc = QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = agree(commchan, lrc))) goto out;
+    /* my new rank is the subdomain that I took over */
+    if (MPI_SUCCESS != MPI_Comm_split(commchan, 0, ranks[mine], &reordered)) {
+        rc = QUO_ERR_MPI;
+        goto out;
+    }
+    /* and so are my neighbors */
+    for (int i = 0; i < mydegree; ++i) {
+        nbrs[i] = edges[displs[mine] + 2 * i];
+        wts[i] = edges[displs[mine] + 2 * i + 1];
+    }
+    int *graph_wts = MPI_UNWEIGHTED;
+    if (weights) graph_wts = (mydegree > 0) ? wts : MPI_WEIGHTS_EMPTY;
+    if (MPI_SUCCESS != MPI_Dist_graph_create_adjacent(reordered, mydegree,
+                                                      nbrs, graph_wts,
+                                                      mydegree, nbrs,
+                                                      graph_wts, MPI_INFO_NULL,
+                                                      0, out_comm)) {
+        rc = QUO_ERR_MPI;
+        goto out;
+    }
+    /* every node process has the node's numbers, so only count them once */
+    if (0 != q->qid) cross[0] = cross[1] = 0;
+    rc = quo_mpi_allreduce(cross, sums, 2, MPI_INT64_T, MPI_SUM, commchan);
+    if (QUO_SUCCESS != rc) goto out;
+    if (out_info) {
+        out_info->cross_socket_before = sums[0];
+        out_info->cross_socket_after = sums[1];
+    }
+out:
+    if (MPI_COMM_NULL != reordered) MPI_Comm_free(&reordered);
+    if (QUO_SUCCESS != rc && MPI_COMM_NULL != *out_comm) {
+        MPI_Comm_free(out_comm);
+    }
+    if (procs) free(procs);
+    if (ranks) free(ranks);
+    if (sockets) free(sockets);
+    if (l3s) free(l3s);
+    if (counts) free(counts);
+    if (displs) free(displs);
+    if (edges) free(edges);
+    if (myedges) free(myedges);
+    if (owner) free(owner);
+    if (nbrs) free(nbrs);
+    if (wts) free(wts);
+    if (w) free(w);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_reorder_comm_graph(QUO_t *q,
+                       int degree,
+                       const int *neighbors,
+                       const int *weights,
+                       MPI_Comm *out_comm,
+                       QUO_reorder_info_t *out_info)
+{
+    int lrc = QUO_SUCCESS;
+
+    if (!q || !out_comm) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    /* everyone else is headed into reorder, so go along (see there) */
+    if (degree < 0 || (degree > 0 && !neighbors)) lrc = QUO_ERR_INVLD_ARG;
+
+    return reorder(q, lrc, degree, neighbors, weights, out_comm, out_info);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_reorder_comm_cart(QUO_t *q,
+                      int ndims,
+                      const int *dims,
+                      const int *periods,
+                      MPI_Comm *out_comm,
+                      QUO_reorder_info_t *out_info)
+{
+    int rc = QUO_SUCCESS, rank = 0, nranks = 0, size = 1, degree = 0;
+    int *neighbors = NULL;
+    MPI_Comm commchan = MPI_COMM_NULL;
+
+    if (!q || ndims <= 0 || !dims || !out_comm) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+
+    if (QUO_SUCCESS != (rc = quo_mpi_get_commchan(q->mpi, &commchan))) {
+        return rc;
+    }
+    if (MPI_SUCCESS != MPI_Comm_rank(commchan, &rank) ||
+        MPI_SUCCESS != MPI_Comm_size(commchan, &nranks)) {
+        return QUO_ERR_MPI;
+    }
+    for (int d = 0; d < ndims; ++d) {
+        if (dims[d] <= 0) return QUO_ERR_INVLD_ARG;
+        size *= dims[d];
+    }
+    if (size != nranks) return QUO_ERR_INVLD_ARG;
+    /* everyone else is headed into reorder, so go along (see there) */
+    if (NULL == (neighbors = calloc(2 * ndims, sizeof(*neighbors)))) {
+        QUO_OOR_COMPLAIN();
+        return reorder(q, QUO_ERR_OOR, 0, NULL, NULL, out_comm, out_info);
+    }
+    /* row-major, like MPI_Cart_create */
+    for (int d = ndims - 1, stride = 1; d >= 0; stride *= dims[d--]) {
+        const int c = (rank / stride) % dims[d];
+        const bool periodic = periods && periods[d];
+        for (int dir = -1; dir <= 1; dir += 2) {
+            int nc = c + dir;
+            if (nc < 0 || nc >= dims[d]) {
+                if (!periodic) continue;
+                nc = (nc + dims[d]) % dims[d];
+            }
+            if (nc == c) continue;
+            neighbors[degree++] = rank + (nc - c) * stride;
+        }
+    }
+    rc = reorder(q, QUO_SUCCESS, degree, neighbors, NULL, out_comm, out_info);
+    free(neighbors);
+    return rc;
+}
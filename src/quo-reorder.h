@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-reorder.h
+ */
+
+#ifndef QUO_REORDER_H_INCLUDED
+#define QUO_REORDER_H_INCLUDED
+
+#include "quo.h"
+
+int
+quo_reorder_assign(int n,
+                   const int64_t *weights,
+                   const int *sockets,
+                   const int *l3s,
+                   int *out_owner,
+                   int64_t *out_cross_before,
+                   int64_t *out_cross_after);
+
+#endif
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-ring.c Node-local ring buffers.
+ */
+
+/* Every ring has a segment of its own: the consumer's head, the producers' tail,
+ * and the consumer's wake-up word (each on its own cache line), then (for rings
+ * with many producers) one sequence number per slot, then the slots.
+ *
+ * Head and tail are free-running element counts, so the ring is empty when they
+ * are equal and full when they are capacity apart. With a single producer, the
+ * tail is also the publication point: the producer copies elements in, then
+ * moves the tail. With many producers, a producer reserves slots by moving the
+ * tail and then publishes every slot by setting its sequence number to the
+ * slot's index plus one, so the consumer never reads a reserved slot that is
+ * still being filled. Both ends remember the last index they read from the
+ * other end and only go back to the shared line when that isn't enough. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo.h"
+#include "quo-private.h"
+#include "quo-ctrl.h"
+#include "quo-atomic.h"
+#include "quo-mpi.h"
+#include "quo-sm.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+/** Consumer's wake-up word. */
+typedef struct quo_ring_wake_t {
+    /** Bumped by producers that find the consumer asleep. */
+    uint32_t seq;
+    /** Whether or not the consumer is (about to go) sleeping. */
+    uint32_t sleeping;
+} quo_ring_wake_t;
+
+/** Node-local ring buffer. */
+struct QUO_ring_t {
+    /** The context this ring was created with. */
+    QUO_t *q;
+    /** Shared-memory instance backing the ring. */
+    quo_sm_t *sm;
+    /** Whether or not sm is mapped. */
+    bool mapped;
+    /** The producer's QID, or QUO_RING_ANY_PRODUCER. */
+    int producer;
+    /** The consumer's QID. */
+    int consumer;
+    /** Size of an element in bytes. */
+    size_t elem_size;
+    /** Number of slots (a power of two). */
+    uint64_t capacity;
+    /** Consumer's index. */
+    uint64_t *head;
+    /** Producers' index. */
+    uint64_t *tail;
+    /** Consumer's wake-up word. */
+    quo_ring_wake_t *wake;
+    /** Per-slot sequence numbers (many producers only). */
+    uint64_t *seqs;
+    /** The slots. */
+    char *slots;
+    /** Last head that this process read. */
+    uint64_t cached_head;
+    /** Last tail that this process read. */
+    uint64_t cached_tail;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static size_t
+seqs_size(bool mpsc,
+          uint64_t capacity)
+{
+    if (!mpsc) return 0;
+    return QUO_CACHE_LINE_ROUNDUP((size_t)capacity * sizeof(uint64_t));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Creates (qid 0) or attaches to (everyone else) a ring's segment. Collective
+ * over the node.
+ */
+static int
+ring_map(QUO_ring_t *ring,
+         size_t seg_size)
+{
+    int rc = QUO_SUCCESS;
+    char *seg_path = NULL;
+    quo_mpi_t *mpi = ring->q->mpi;
+
+    /* Generate and agree upon a unique (node-local) path name. */
+    if (QUO_SUCCESS != (rc = quo_mpi_xchange_uniq_path(mpi, "ring",
+                                                       &seg_path))) {
+        QUO_ERR_MSGRC("quo_mpi_xchange_uniq_path", rc);
+        goto out;
+    }
+    if (0 == ring->q->qid) {
+        /* ftruncate zero-fills, so the ring starts out empty. */
+        rc = quo_sm_segment_create(ring->sm, seg_path, seg_size);
+        if (QUO_SUCCESS != rc) {
+            QUO_ERR_MSGRC("quo_sm_segment_create", rc);
+            goto out;
+        }
+        ring->mapped = true;
+        /* Signal completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        /* Wait for attach completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        /* Cleanup after everyone is done. */
+        (void)quo_sm_unlink(ring->sm);
+    }
+    else {
+        /* Wait for the segment to be created. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+        rc = quo_sm_segment_attach(ring->sm, seg_path, seg_size);
+        if (QUO_SUCCESS != rc) {
+            QUO_ERR_MSGRC("quo_sm_segment_attach", rc);
+            goto out;
+        }
+        ring->mapped = true;
+        /* Signal attach completion. */
+        if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(mpi))) goto out;
+    }
+out:
+    if (seg_path) free(seg_path);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+ring_destruct(QUO_ring_t *ring)
+{
+    if (!ring) return;
+    /* quo_sm_destruct unmaps, so only call it when there is a mapping. */
+    if (ring->mapped) {
+        (void)quo_sm_destruct(ring->sm);
+    }
+    else if (ring->sm) {
+        free(ring->sm);
+    }
+    free(ring);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_ring_create(QUO_t *q,
+                int producer,
+                int consumer,
+                size_t elem_size,
+                int capacity,
+                QUO_ring_t **ring)
+{
+    int rc = QUO_SUCCESS;
+    QUO_ring_t *newr = NULL;
+
+    if (!q || !ring || 0 == elem_size || capacity <= 0) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    QUO_NO_INIT_ACTION(q);
+    *ring = NULL;
+    if (consumer < 0 || consumer >= q->nqid) return QUO_ERR_INVLD_ARG;
+    if (QUO_RING_ANY_PRODUCER != producer &&
+        (producer < 0 || producer >= q->nqid)) return QUO_ERR_INVLD_ARG;
+
+    if (NULL == (newr = calloc(1, sizeof(*newr)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    newr->q = q;
+    newr->producer = producer;
+    newr->consumer = consumer;
+    newr->elem_size = elem_size;
+    newr->capacity = 1;
+    while (newr->capacity < (uint64_t)capacity) newr->capacity <<= 1;
+    if (QUO_SUCCESS != (rc = quo_sm_construct(&newr->sm))) goto out;
+
+    const bool mpsc = (QUO_RING_ANY_PRODUCER == producer);
+    const size_t hdr_size = 3 * QUO_CACHE_LINE_SIZE;
+    const size_t sq_size = seqs_size(mpsc, newr->capacity);
+    const size_t seg_size = hdr_size + sq_size +
+                            (size_t)newr->capacity * elem_size;
+    if (QUO_SUCCESS != (rc = ring_map(newr, seg_size))) goto out;
+
+    char *basep = quo_sm_get_basep(newr->sm);
+    newr->head = (uint64_t *)basep;
+    newr->tail = (uint64_t *)(basep + QUO_CACHE_LINE_SIZE);
+    newr->wake = (quo_ring_wake_t *)(basep + 2 * QUO_CACHE_LINE_SIZE);
+    newr->seqs = mpsc ? (uint64_t *)(basep + hdr_size) : NULL;
+    newr->slots = basep + hdr_size + sq_size;
+out:
+    if (QUO_SUCCESS != rc) {
+        ring_destruct(newr);
+        return rc;
+    }
+    *ring = newr;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_ring_free(QUO_ring_t *ring)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!ring) return QUO_ERR_INVLD_ARG;
+    /* make sure that everyone is done with it */
+    rc = quo_mpi_sm_barrier(ring->q->mpi);
+    ring_destruct(ring);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Copies n elements between buf and the slots starting at index, wrapping
+ * around the end of the ring if needed.
+ */
+static void
+ring_copy(QUO_ring_t *ring,
+          uint64_t index,
+          void *buf,
+          uint64_t n,
+          bool to_ring)
+{
+    const uint64_t first = index & (ring->capacity - 1);
+    const uint64_t n1 = (first + n > ring->capacity) ? ring->capacity - first
+                                                     : n;
+    const size_t es = ring->elem_size;
+    char *b = buf;
+
+    if (to_ring) {
+        (void)memcpy(ring->slots + first * es, b, n1 * es);
+        (void)memcpy(ring->slots, b + n1 * es, (n - n1) * es);
+    }
+    else {
+        (void)memcpy(b, ring->slots + first * es, n1 * es);
+        (void)memcpy(b + n1 * es, ring->slots, (n - n1) * es);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Wakes up the consumer if it went to sleep.
+ */
+static void
+ring_wake(QUO_ring_t *ring)
+{
+    /* pairs with the fence in QUO_ring_dequeue_wait: either the consumer sees
+     * our elements, or we see it sleeping. */
+    quo_atomic_fence();
+    if (0 != quo_atomic_load_u32(&ring->wake->sleeping)) {
+        (void)quo_atomic_fetch_add_u32(&ring->wake->seq, 1);
+        quo_futex_wake(&ring->wake->seq, 1);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_ring_enqueue(QUO_ring_t *ring,
+                 const void *elems,
+                 int nelems,
+                 int *out_nenqueued)
+{
+    uint64_t t = 0, n = 0;
+
+    if (!ring || (!elems && nelems > 0) || nelems < 0 || !out_nenqueued) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    *out_nenqueued = 0;
+
+    if (QUO_RING_ANY_PRODUCER != ring->producer) {
+        if (ring->q->qid != ring->producer) return QUO_ERR_INVLD_ARG;
+        /* only we write the tail */
+        t = *ring->tail;
+        if (ring->capacity - (t - ring->cached_head) < (uint64_t)nelems) {
+            ring->cached_head = quo_atomic_load_u64(ring->head);
+        }
+        n = ring->capacity - (t - ring->cached_head);
+        if (n > (uint64_t)nelems) n = (uint64_t)nelems;
+        if (0 == n) return QUO_SUCCESS;
+        ring_copy(ring, t, (void *)elems, n, true);
+        quo_atomic_store_u64(ring->tail, t + n);
+    }
+    else {
+        /* reserve as many slots as we can get */
+        while (true) {
+            t = quo_atomic_load_u64(ring->tail);
+            /* our head may be from before other producers moved the tail */
+            if (t - ring->cached_head > ring->capacity ||
+                ring->capacity - (t - ring->cached_head) < (uint64_t)nelems) {
+                ring->cached_head = quo_atomic_load_u64(ring->head);
+            }
+            /* and the consumer may be past what we think the tail is */
+            if (ring->cached_head > t) continue;
+            n = ring->capacity - (t - ring->cached_head);
+            if (n > (uint64_t)nelems) n = (uint64_t)nelems;
+            if (0 == n) return QUO_SUCCESS;
+            if (quo_atomic_cas_u64(ring->tail, t, t + n)) break;
+        }
+        ring_copy(ring, t, (void *)elems, n, true);
+        for (uint64_t i = 0; i < n; ++i) {
+            const uint64_t idx = t + i;
+            quo_atomic_store_u64(&ring->seqs[idx & (ring->capacity - 1)],
+                                 idx + 1);
+        }
+    }
+    ring_wake(ring);
+    *out_nenqueued = (int)n;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_ring_dequeue(QUO_ring_t *ring,
+                 void *elems,
+                 int nelems,
+                 int *out_ndequeued)
+{
+    uint64_t n = 0;
+
+    if (!ring || (!elems && nelems > 0) || nelems < 0 || !out_ndequeued) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    *out_ndequeued = 0;
+    if (ring->q->qid != ring->consumer) return QUO_ERR_INVLD_ARG;
+
+    /* only we write the head */
+    const uint64_t h = *ring->head;
+    if (QUO_RING_ANY_PRODUCER != ring->producer) {
+        if (ring->cached_tail - h < (uint64_t)nelems) {
+            ring->cached_tail = quo_atomic_load_u64(ring->tail);
+        }
+        n = ring->cached_tail - h;
+        if (n > (uint64_t)nelems) n = (uint64_t)nelems;
+    }
+    else {
+        /* stop at the first slot that isn't published yet */
+        while (n < (uint64_t)nelems) {
+            const uint64_t idx = h + n;
+            const uint64_t *seq = &ring->seqs[idx & (ring->capacity - 1)];
+            if (quo_atomic_load_u64(seq) != idx + 1) break;
+            ++n;
+        }
+    }
+    if (0 == n) return QUO_SUCCESS;
+    ring_copy(ring, h, elems, n, false);
+    quo_atomic_store_u64(ring->head, h + n);
+    *out_ndequeued = (int)n;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_ring_dequeue_wait(QUO_ring_t *ring,
+                      void *elems,
+                      int nelems,
+                      int *out_ndequeued)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!ring || !elems || nelems <= 0 || !out_ndequeued) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    const int spins = quo_ctrl_spin_limit(ring->q->ctrl);
+    for (int i = 0; i < spins; ++i) {
+        rc = QUO_ring_dequeue(ring, elems, nelems, out_ndequeued);
+        if (QUO_SUCCESS != rc || *out_ndequeued > 0) return rc;
+        quo_atomic_cpu_relax();
+    }
+    while (true) {
+        const uint32_t seq = quo_atomic_load_u32(&ring->wake->seq);
+        quo_atomic_store_u32(&ring->wake->sleeping, 1);
+        quo_atomic_fence();
+        rc = QUO_ring_dequeue(ring, elems, nelems, out_ndequeued);
+        if (QUO_SUCCESS != rc || *out_ndequeued > 0) break;
+        quo_futex_wait(&ring->wake->seq, seq);
+    }
+    quo_atomic_store_u32(&ring->wake->sleeping, 0);
+    return rc;
+}
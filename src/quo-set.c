@@ -30,12 +30,24 @@
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
 #include <errno.h>
 
+/** Number of bits in a bitset word. */
+#define WORD_BITS 64
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /**
- * This is a naive algorithm to compute the intersection of k sets. if this
- * approach ever becomes a performance bottleneck, then implement Baeza-Yates.
+ * Returns the elements that are members of at least two of the provided sets,
+ * i.e., the elements that some pair of sets has in common.
+ *
+ * Every set is streamed once into two word-packed bitsets: seen (elements
+ * encountered so far) and dup (elements encountered more than once). That is
+ * O(total number of elements + max value / 64), instead of merging all O(k^2)
+ * pairs of sets. The result length is a popcount over dup and the (sorted)
+ * result is recovered by scanning dup's set bits in order.
  *
  * Caller is responsible for freeing returned resources.
  */
@@ -48,12 +60,12 @@ quo_set_get_k_set_intersection(int nsets,
 {
     /* all set data are positive, so we don't have to worry about that */
     int global_max = -1;
-    /* "hash table" large enough to hold the largest set value. */
-    int *big_htab = NULL;
+    /* bitsets large enough to hold the largest set value. */
+    uint64_t *seen = NULL, *dup = NULL;
     /* length of the k set intersection */
     int ilen = 0;
-    /* size of big_htab */
-    size_t big_htab_size = 0;
+    /* number of words in each bitset */
+    size_t nwords = 0;
 
     if (!set_lens || !sets || !res || !res_len) return QUO_ERR_INVLD_ARG;
     *res = NULL; *res_len = 0;
@@ -76,61 +88,54 @@ quo_set_get_k_set_intersection(int nsets,
             if (global_max < curval) global_max = curval;
         }
     }
-    /* now that we know the global max, allocate an array large enough to
-     * accommodate that range. remember, values here should be from
-     * 0 - global_max. */
-    big_htab_size = (global_max + 1) * sizeof(*big_htab);
-    if (NULL == (big_htab = malloc(big_htab_size))) {
+    /* all sets are empty */
+    if (global_max < 0) return QUO_SUCCESS;
+    nwords = ((size_t)global_max / WORD_BITS) + 1;
+    seen = calloc(nwords, sizeof(*seen));
+    dup = calloc(nwords, sizeof(*dup));
+    if (!seen || !dup) {
         QUO_OOR_COMPLAIN();
+        if (seen) free(seen);
+        if (dup) free(dup);
         return QUO_ERR_OOR;
     }
-    /* -1 indicates that the hash location has not yet been taken */
-    (void)memset(big_htab, -1, big_htab_size);
     /* ////////////////////////////////////////////////////////////////////// */
-    /* start the naive k set intersection */
+    /* stream every element through seen and dup (branch free) */
     /* ////////////////////////////////////////////////////////////////////// */
-    for (int seta = 0; seta < nsets; ++seta) {
-        for (int setb = 0; setb < nsets; ++setb) {
-            int i = 0, j = 0;
-            if (seta == setb) continue;
-            while (i < set_lens[seta] && j < set_lens[setb]) {
-                /* no possible intersection */
-                if (0 == set_lens[seta] || 0 == set_lens[setb]) break;
-                while (i < set_lens[seta] && sets[seta][i] < sets[setb][j]) ++i;
-                if (i == set_lens[seta]) break;
-                while (j < set_lens[setb] && sets[setb][j] < sets[seta][i]) ++j;
-                if (j == set_lens[setb]) break;
-                if (sets[seta][i] == sets[setb][j]) {
-                    /* new entry */
-                    if (-1 == big_htab[sets[seta][i]]) {
-                        big_htab[sets[seta][i]] = sets[seta][i];
-                        ++ilen;
-                    }
-                }
-                ++i; ++j;
-            }
+    for (int set = 0; set < nsets; ++set) {
+        const int *setp = sets[set];
+        for (int elem = 0; elem < set_lens[set]; ++elem) {
+            const size_t w = (size_t)setp[elem] / WORD_BITS;
+            const uint64_t bit = UINT64_C(1) << (setp[elem] % WORD_BITS);
+            dup[w] |= seen[w] & bit;
+            seen[w] |= bit;
         }
     }
+    for (size_t w = 0; w < nwords; ++w) {
+        ilen += __builtin_popcountll(dup[w]);
+    }
     /* if no intersections found, we are done! */
     if (0 == ilen) goto done;
     /* else return the set */
     if (NULL == (*res = calloc(ilen, sizeof(int)))) {
-        free(big_htab); big_htab = NULL;
         QUO_OOR_COMPLAIN();
+        free(seen);
+        free(dup);
         return QUO_ERR_OOR;
     }
     /* populate the result array - note this will always be sorted */
-    for (int i = 0, j = 0; i < global_max + 1; ++i) {
-        if (-1 != big_htab[i]) (*res)[j++] = big_htab[i];
+    for (size_t w = 0, j = 0; w < nwords; ++w) {
+        uint64_t word = dup[w];
+        while (word) {
+            (*res)[j++] = (int)(w * WORD_BITS) + __builtin_ctzll(word);
+            /* clear the lowest set bit */
+            word &= word - 1;
+        }
     }
     /* return result array length */
     *res_len = ilen;
-#if 0 /* debug */
-    for (int i = 0; i < ilen; ++i) {
-        printf("%d%s", (*res)[i], i + 1 == ilen ? "\n" : " ");
-    }
-#endif
 done:
-    if (big_htab) free(big_htab);
+    free(seen);
+    free(dup);
     return QUO_SUCCESS;
 }
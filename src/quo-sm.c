@@ -84,7 +84,8 @@ quo_sm_destruct(quo_sm_t *sm)
     if (!sm) return QUO_ERR_INVLD_ARG;
 
     if (sm->path) free(sm->path);
-    if (0 != munmap(sm->seg_basep, sm->seg_size)) {
+    /* nothing was ever mapped (e.g., a segment that was never created) */
+    if (sm->seg_basep && 0 != munmap(sm->seg_basep, sm->seg_size)) {
         int errc = errno;
         fprintf(stderr, QUO_WARN_PREFIX"%s failure. errno: %d (%s.)\n",
                 "munmap", errc, strerror(errc));
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-subset.c Node process subsets.
+ */
+
+/* Subsets synchronize over barriers in the control region (see
+ * quo_ctrl_subset_join), so creating one doesn't involve non-members or MPI. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo.h"
+#include "quo-private.h"
+#include "quo-ctrl.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+
+/** Process subset. */
+struct QUO_subset_t {
+    /** The context this subset was created with. */
+    QUO_t *q;
+    /** Number of members. */
+    int nmembers;
+    /** Sorted list of member QIDs. */
+    int *members;
+    /** The subset's barrier. */
+    quo_ctrl_subset_t barrier;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+int_cmp(const void *a,
+        const void *b)
+{
+    const int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_subset_create(QUO_t *q,
+                  int nqids,
+                  const int *qids,
+                  QUO_subset_t **subset)
+{
+    int rc = QUO_SUCCESS, n = 0;
+    bool member = false;
+    QUO_subset_t *news = NULL;
+
+    if (!q || nqids <= 0 || !qids || !subset) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *subset = NULL;
+
+    if (NULL == (news = calloc(1, sizeof(*news)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (NULL == (news->members = calloc(nqids, sizeof(int)))) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    for (int i = 0; i < nqids; ++i) {
+        if (qids[i] < 0 || qids[i] >= q->nqid) {
+            rc = QUO_ERR_INVLD_ARG;
+            goto out;
+        }
+        news->members[i] = qids[i];
+    }
+    /* everyone must end up with the same list */
+    qsort(news->members, nqids, sizeof(int), int_cmp);
+    for (int i = 0; i < nqids; ++i) {
+        if (n > 0 && news->members[n - 1] == news->members[i]) continue;
+        news->members[n++] = news->members[i];
+        if (news->members[i] == q->qid) member = true;
+    }
+    if (!member) {
+        rc = QUO_ERR_INVLD_ARG;
+        goto out;
+    }
+    news->q = q;
+    news->nmembers = n;
+    rc = quo_ctrl_subset_join(q->ctrl, n, news->members, &news->barrier);
+    if (QUO_SUCCESS != rc) goto out;
+    *subset = news;
+out:
+    if (QUO_SUCCESS != rc) {
+        if (news->members) free(news->members);
+        free(news);
+    }
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_subset_create_in_type(QUO_t *q,
+                          QUO_obj_type_t type,
+                          int in_type_index,
+                          QUO_subset_t **subset)
+{
+    int rc = QUO_SUCCESS, nqids = 0;
+    int *qids = NULL;
+
+    if (!q || !subset) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *subset = NULL;
+
+    rc = QUO_qids_in_type(q, type, in_type_index, &nqids, &qids);
+    if (QUO_SUCCESS != rc) return rc;
+    if (0 == nqids) rc = QUO_ERR_INVLD_ARG;
+    else rc = QUO_subset_create(q, nqids, qids, subset);
+    if (qids) free(qids);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_subset_free(QUO_subset_t *subset)
+{
+    int rc = QUO_SUCCESS;
+
+    /* okay to pass NULL here. just return success */
+    if (!subset) return QUO_SUCCESS;
+    rc = quo_ctrl_subset_leave(subset->q->ctrl, &subset->barrier);
+    free(subset->members);
+    free(subset);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_subset_barrier(QUO_subset_t *subset)
+{
+    if (!subset) return QUO_ERR_INVLD_ARG;
+    return quo_ctrl_subset_barrier(subset->q->ctrl, &subset->barrier);
+}
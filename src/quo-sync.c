@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-sync.c Node-wide locks, semaphores, and counters.
+ */
+
+/* Every object is one cache line in the control region (see
+ * quo_ctrl_obj_alloc). Creation and destruction are collective over the node,
+ * so everyone allocates the same line without having to talk about it.
+ *
+ * Locks are ticket locks: a waiter only reads the line while it waits, backs
+ * off in proportion to its distance from the head of the queue, and the lock
+ * is handed out in FIFO order. Semaphore waiters spin for a little while and
+ * then sleep on the semaphore's value. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo.h"
+#include "quo-private.h"
+#include "quo-ctrl.h"
+#include "quo-atomic.h"
+#include "quo-mpi.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+#ifdef HAVE_SCHED_H
+#include <sched.h>
+#endif
+
+/** Number of relax instructions per ticket between us and the lock holder. */
+#define QUO_SYNC_LOCK_BACKOFF 64
+
+/** Node-wide lock. */
+struct QUO_lock_t {
+    /** The context this lock was created with. */
+    QUO_t *q;
+    /** Control region object. */
+    int obj;
+    /** Next ticket to hand out. */
+    uint32_t *next;
+    /** Ticket that holds the lock. */
+    uint32_t *serving;
+};
+
+/** Node-wide counting semaphore. */
+struct QUO_sem_t {
+    /** The context this semaphore was created with. */
+    QUO_t *q;
+    /** Control region object. */
+    int obj;
+    /** Current value. */
+    uint32_t *value;
+    /** Number of processes that are (about to go) sleeping on value. */
+    uint32_t *nwaiters;
+};
+
+/** Node-wide counter. */
+struct QUO_counter_t {
+    /** The context this counter was created with. */
+    QUO_t *q;
+    /** Control region object. */
+    int obj;
+    /** Current value. */
+    uint64_t *value;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Allocates a synchronization object. Collective over the node. Before
+ * returning, the caller has to initialize the object (from qid 0 only) and run
+ * a node barrier.
+ */
+static int
+obj_alloc(QUO_t *q,
+          int *obj,
+          void **line)
+{
+    /* everyone allocates in the same order, so everyone runs out together */
+    int rc = quo_ctrl_obj_alloc(q->ctrl, obj, line);
+    if (QUO_ERR_OOR == rc) QUO_ERR_MSG("out of synchronization objects");
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+obj_free(QUO_t *q,
+         int obj)
+{
+    int rc = QUO_SUCCESS;
+    /* make sure that everyone is done with it */
+    if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) return rc;
+    return quo_ctrl_obj_free(q->ctrl, obj);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_lock_create(QUO_t *q,
+                QUO_lock_t **lock)
+{
+    int rc = QUO_SUCCESS;
+    uint32_t *line = NULL;
+    QUO_lock_t *newl = NULL;
+
+    if (!q || !lock) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *lock = NULL;
+
+    if (NULL == (newl = calloc(1, sizeof(*newl)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = obj_alloc(q, &newl->obj, (void **)&line))) {
+        free(newl);
+        return rc;
+    }
+    newl->q = q;
+    newl->next = &line[0];
+    newl->serving = &line[1];
+    /* the line is zeroed, and that's an unlocked lock */
+    if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
+        (void)quo_ctrl_obj_free(q->ctrl, newl->obj);
+        free(newl);
+        return rc;
+    }
+    *lock = newl;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_lock_free(QUO_lock_t *lock)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!lock) return QUO_ERR_INVLD_ARG;
+    rc = obj_free(lock->q, lock->obj);
+    free(lock);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_lock_acquire(QUO_lock_t *lock)
+{
+    if (!lock) return QUO_ERR_INVLD_ARG;
+
+    const uint32_t ticket = quo_atomic_fetch_add_u32(lock->next, 1);
+    const int spins = quo_ctrl_spin_limit(lock->q->ctrl);
+    uint32_t serving;
+    while (ticket != (serving = quo_atomic_load_u32(lock->serving))) {
+        if (0 == spins) {
+            (void)sched_yield();
+            continue;
+        }
+        /* the further back in line we are, the longer we stay off the line */
+        const uint32_t ahead = ticket - serving;
+        for (uint32_t i = 0; i < ahead * QUO_SYNC_LOCK_BACKOFF; ++i) {
+            quo_atomic_cpu_relax();
+        }
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_lock_try(QUO_lock_t *lock,
+             int *out_acquired)
+{
+    if (!lock || !out_acquired) return QUO_ERR_INVLD_ARG;
+
+    /* only take a ticket if it would be served right away */
+    const uint32_t serving = quo_atomic_load_u32(lock->serving);
+    *out_acquired = quo_atomic_cas_u32(lock->next, serving, serving + 1);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_lock_release(QUO_lock_t *lock)
+{
+    if (!lock) return QUO_ERR_INVLD_ARG;
+
+    /* only the holder writes serving */
+    const uint32_t serving = quo_atomic_load_u32(lock->serving);
+    quo_atomic_store_u32(lock->serving, serving + 1);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_sem_create(QUO_t *q,
+               int value,
+               QUO_sem_t **sem)
+{
+    int rc = QUO_SUCCESS;
+    uint32_t *line = NULL;
+    QUO_sem_t *news = NULL;
+
+    if (!q || value < 0 || !sem) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *sem = NULL;
+
+    if (NULL == (news = calloc(1, sizeof(*news)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = obj_alloc(q, &news->obj, (void **)&line))) {
+        free(news);
+        return rc;
+    }
+    news->q = q;
+    news->value = &line[0];
+    news->nwaiters = &line[1];
+    if (0 == q->qid) quo_atomic_store_u32(news->value, (uint32_t)value);
+    if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
+        (void)quo_ctrl_obj_free(q->ctrl, news->obj);
+        free(news);
+        return rc;
+    }
+    *sem = news;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_sem_free(QUO_sem_t *sem)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!sem) return QUO_ERR_INVLD_ARG;
+    rc = obj_free(sem->q, sem->obj);
+    free(sem);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Takes one from the semaphore if it isn't zero. Returns whether or not it did.
+ */
+static bool
+sem_take(QUO_sem_t *sem)
+{
+    uint32_t v;
+    while (0 != (v = quo_atomic_load_u32(sem->value))) {
+        if (quo_atomic_cas_u32(sem->value, v, v - 1)) return true;
+    }
+    return false;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_sem_wait(QUO_sem_t *sem)
+{
+    if (!sem) return QUO_ERR_INVLD_ARG;
+
+    const int spins = quo_ctrl_spin_limit(sem->q->ctrl);
+    for (int i = 0; i < spins; ++i) {
+        if (sem_take(sem)) return QUO_SUCCESS;
+        quo_atomic_cpu_relax();
+    }
+    while (!sem_take(sem)) {
+        (void)quo_atomic_fetch_add_u32(sem->nwaiters, 1);
+        /* pairs with the fence in QUO_sem_post: either it sees us waiting, or
+         * we see its post. */
+        quo_atomic_fence();
+        if (0 == quo_atomic_load_u32(sem->value)) {
+            quo_futex_wait(sem->value, 0);
+        }
+        (void)quo_atomic_fetch_add_u32(sem->nwaiters, (uint32_t)-1);
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_sem_trywait(QUO_sem_t *sem,
+                int *out_acquired)
+{
+    if (!sem || !out_acquired) return QUO_ERR_INVLD_ARG;
+
+    *out_acquired = sem_take(sem);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_sem_post(QUO_sem_t *sem)
+{
+    if (!sem) return QUO_ERR_INVLD_ARG;
+
+    (void)quo_atomic_fetch_add_u32(sem->value, 1);
+    quo_atomic_fence();
+    if (0 != quo_atomic_load_u32(sem->nwaiters)) {
+        quo_futex_wake(sem->value, 1);
+    }
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_counter_create(QUO_t *q,
+                   int64_t value,
+                   QUO_counter_t **counter)
+{
+    int rc = QUO_SUCCESS;
+    uint64_t *line = NULL;
+    QUO_counter_t *newc = NULL;
+
+    if (!q || !counter) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *counter = NULL;
+
+    if (NULL == (newc = calloc(1, sizeof(*newc)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = obj_alloc(q, &newc->obj, (void **)&line))) {
+        free(newc);
+        return rc;
+    }
+    newc->q = q;
+    newc->value = line;
+    if (0 == q->qid) quo_atomic_store_u64(newc->value, (uint64_t)value);
+    if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) {
+        (void)quo_ctrl_obj_free(q->ctrl, newc->obj);
+        free(newc);
+        return rc;
+    }
+    *counter = newc;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_counter_free(QUO_counter_t *counter)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!counter) return QUO_ERR_INVLD_ARG;
+    rc = obj_free(counter->q, counter->obj);
+    free(counter);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_counter_fetch_add(QUO_counter_t *counter,
+                      int64_t inc,
+                      int64_t *out_old)
+{
+    if (!counter) return QUO_ERR_INVLD_ARG;
+
+    /* two's complement wrap-around does the right thing for negative incs */
+    const uint64_t old = quo_atomic_fetch_add_u64(counter->value,
+                                                  (uint64_t)inc);
+    if (out_old) *out_old = (int64_t)old;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_counter_load(QUO_counter_t *counter,
+                 int64_t *out_value)
+{
+    if (!counter || !out_value) return QUO_ERR_INVLD_ARG;
+
+    *out_value = (int64_t)quo_atomic_load_u64(counter->value);
+    return QUO_SUCCESS;
+}
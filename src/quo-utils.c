@@ -34,6 +34,9 @@
 #ifdef HAVE_STDDEF_H
 #include <stddef.h>
 #endif
+#ifdef HAVE_TIME_H
+#include <time.h>
+#endif
 #include <errno.h>
 
 #define QUO_TMPDIR_ENV_VAR_STR "QUO_TMPDIR"
@@ -90,3 +93,15 @@ quo_utils_envvar_set(const char *the_envvar,
 
     return QUO_SUCCESS;
 }
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns a monotonic time stamp in seconds.
+ */
+double
+quo_utils_wtime(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
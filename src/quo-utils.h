@@ -37,4 +37,7 @@ int
 quo_utils_envvar_set(const char *the_envvar,
                      bool *set);
 
+double
+quo_utils_wtime(void);
+
 #endif
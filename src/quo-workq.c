@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file quo-workq.c Node-wide dynamic work queues.
+ */
+
+/* A work queue hands out chunks of the task range [0, ntasks) to whoever asks
+ * first. The range is split into one or more sub-queues, each a control
+ * region object (see quo_ctrl_obj_alloc) holding the next task to hand out and
+ * the end of its range. Taking a chunk is a single atomic operation on the
+ * sub-queue's next task. With QUO_WORKQ_NUMA, there is one sub-queue per NUMA
+ * node, sized by the number of node processes bound inside of it, and a
+ * process first drains its own NUMA node's sub-queue and then steals from the
+ * others. A sub-queue that is found empty stays empty until the next reset, so
+ * every process remembers how far it got. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "quo.h"
+#include "quo-private.h"
+#include "quo-ctrl.h"
+#include "quo-atomic.h"
+#include "quo-hwloc.h"
+#include "quo-mpi.h"
+#include "quo-distrib.h"
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_STDBOOL_H
+#include <stdbool.h>
+#endif
+
+/** Sub-queue. One control region object each. */
+typedef struct quo_workq_sub_t {
+    /** Next task to hand out. */
+    uint64_t next;
+    /** One past the last task of the sub-queue's range. */
+    uint64_t end;
+} quo_workq_sub_t;
+
+/** Node-wide work queue. */
+struct QUO_workq_t {
+    /** The context this queue was created with. */
+    QUO_t *q;
+    /** How chunks are sized. */
+    QUO_workq_schedule_t schedule;
+    /** (Minimum) chunk size. */
+    int64_t chunk_size;
+    /** Number of sub-queues. */
+    int nsubs;
+    /** Control region objects backing the sub-queues. */
+    int *objs;
+    /** The sub-queues. */
+    quo_workq_sub_t **subs;
+    /** Number of node processes that call a sub-queue home. */
+    int *nworkers;
+    /** Index of our home sub-queue. */
+    int home;
+    /** Number of sub-queues (starting at home) that we found empty. */
+    int nempty;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+workq_destruct(QUO_workq_t *wq,
+               int nobjs)
+{
+    for (int i = 0; i < nobjs; ++i) {
+        (void)quo_ctrl_obj_free(wq->q->ctrl, wq->objs[i]);
+    }
+    if (wq->objs) free(wq->objs);
+    if (wq->subs) free(wq->subs);
+    if (wq->nworkers) free(wq->nworkers);
+    free(wq);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Picks our home sub-queue and counts everyone's. Collective over the node.
+ */
+static int
+workq_homes(QUO_workq_t *wq)
+{
+    int rc = QUO_SUCCESS, numa = -1;
+    int *mine = NULL;
+    MPI_Comm node_comm;
+    QUO_t *q = wq->q;
+
+    if (1 == wq->nsubs) {
+        wq->home = 0;
+        wq->nworkers[0] = q->nqid;
+        return QUO_SUCCESS;
+    }
+    if (QUO_SUCCESS != (rc = quo_mpi_get_node_comm(q->mpi, &node_comm))) {
+        return rc;
+    }
+    rc = quo_hwloc_get_obj_index_covering_cur_bind(q->hwloc, QUO_OBJ_NUMANODE,
+                                                   &numa);
+    /* everyone else is headed for the allreduce, so don't bail out here */
+    if (QUO_SUCCESS != rc) numa = -1;
+    /* unbound (or spanning) processes are spread over the sub-queues */
+    numa = quo_distrib_home(wq->nsubs, q->qid, numa);
+    wq->home = numa;
+    if (NULL == (mine = calloc(wq->nsubs, sizeof(*mine)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    mine[numa] = 1;
+    if (QUO_SUCCESS != (rc = quo_mpi_allreduce(mine, wq->nworkers, wq->nsubs,
+                                               MPI_INT, MPI_SUM, node_comm))) {
+        QUO_ERR_MSGRC("quo_mpi_allreduce", rc);
+    }
+    free(mine);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_workq_create(QUO_t *q,
+                 int64_t ntasks,
+                 QUO_workq_schedule_t schedule,
+                 int64_t chunk_size,
+                 int flags,
+                 QUO_workq_t **workq)
+{
+    int rc = QUO_SUCCESS, nobjs = 0;
+    QUO_workq_t *wq = NULL;
+
+    if (!q || ntasks < 0 || chunk_size <= 0 || !workq) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    if (QUO_WORKQ_DYNAMIC != schedule && QUO_WORKQ_GUIDED != schedule) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    if (0 != (flags & ~QUO_WORKQ_NUMA)) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *workq = NULL;
+
+    if (NULL == (wq = calloc(1, sizeof(*wq)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    wq->q = q;
+    wq->schedule = schedule;
+    wq->chunk_size = chunk_size;
+    wq->nsubs = 1;
+    if (flags & QUO_WORKQ_NUMA) {
+        int nnuma = 0;
+        rc = quo_hwloc_get_nobjs_by_type(q->hwloc, QUO_OBJ_NUMANODE, &nnuma);
+        if (QUO_SUCCESS != rc) goto out;
+        if (nnuma > 1) wq->nsubs = nnuma;
+    }
+    wq->objs = calloc(wq->nsubs, sizeof(*wq->objs));
+    wq->subs = calloc(wq->nsubs, sizeof(*wq->subs));
+    wq->nworkers = calloc(wq->nsubs, sizeof(*wq->nworkers));
+    if (!wq->objs || !wq->subs || !wq->nworkers) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    /* everyone allocates in the same order, so everyone fails together */
+    for (nobjs = 0; nobjs < wq->nsubs; ++nobjs) {
+        rc = quo_ctrl_obj_alloc(q->ctrl, &wq->objs[nobjs],
+                                (void **)&wq->subs[nobjs]);
+        if (QUO_SUCCESS != rc) {
+            QUO_ERR_MSG("out of synchronization objects");
+            goto out;
+        }
+    }
+    if (QUO_SUCCESS != (rc = workq_homes(wq))) goto out;
+    rc = QUO_workq_reset(wq, ntasks);
+out:
+    if (QUO_SUCCESS != rc) {
+        workq_destruct(wq, nobjs);
+        return rc;
+    }
+    *workq = wq;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_workq_reset(QUO_workq_t *wq,
+                int64_t ntasks)
+{
+    int rc = QUO_SUCCESS;
+    QUO_t *q = NULL;
+
+    if (!wq || ntasks < 0) return QUO_ERR_INVLD_ARG;
+    q = wq->q;
+    /* make sure that everyone is done with the last round */
+    if (QUO_SUCCESS != (rc = quo_mpi_sm_barrier(q->mpi))) return rc;
+    if (0 == q->qid) {
+        /* split the range in proportion to the number of workers */
+        int64_t begin = 0, nhomed = 0;
+        for (int i = 0; i < wq->nsubs; ++i) nhomed += wq->nworkers[i];
+        for (int i = 0, seen = 0; i < wq->nsubs; ++i) {
+            seen += wq->nworkers[i];
+            /* ntasks * seen / nhomed, without overflowing */
+            const int64_t end = (ntasks / nhomed) * seen +
+                                (ntasks % nhomed) * seen / nhomed;
+            quo_atomic_store_u64(&wq->subs[i]->next, (uint64_t)begin);
+            quo_atomic_store_u64(&wq->subs[i]->end, (uint64_t)end);
+            begin = end;
+        }
+    }
+    wq->nempty = 0;
+    return quo_mpi_sm_barrier(q->mpi);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_workq_free(QUO_workq_t *wq)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!wq) return QUO_ERR_INVLD_ARG;
+    /* make sure that everyone is done with it */
+    rc = quo_mpi_sm_barrier(wq->q->mpi);
+    workq_destruct(wq, wq->nsubs);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Takes a chunk from sub-queue i. Returns false if it is empty.
+ */
+static bool
+workq_take(QUO_workq_t *wq,
+           int i,
+           int64_t *begin,
+           int64_t *end)
+{
+    quo_workq_sub_t *sub = wq->subs[i];
+    const uint64_t qend = sub->end; /* only changes between rounds */
+    uint64_t next = quo_atomic_load_u64(&sub->next), chunk = 0;
+
+    if (next >= qend) return false;
+    if (QUO_WORKQ_DYNAMIC == wq->schedule) {
+        next = quo_atomic_fetch_add_u64(&sub->next, (uint64_t)wq->chunk_size);
+        if (next >= qend) return false;
+        chunk = (uint64_t)wq->chunk_size;
+    }
+    else {
+        const uint64_t nworkers = wq->nworkers[i] > 0 ? wq->nworkers[i] : 1;
+        while (true) {
+            if (next >= qend) return false;
+            /* a share of what is left, but no less than chunk_size */
+            chunk = (qend - next + nworkers - 1) / nworkers;
+            if (chunk < (uint64_t)wq->chunk_size) {
+                chunk = (uint64_t)wq->chunk_size;
+            }
+            if (quo_atomic_cas_u64(&sub->next, next, next + chunk)) break;
+            next = quo_atomic_load_u64(&sub->next);
+        }
+    }
+    *begin = (int64_t)next;
+    *end = (int64_t)(next + chunk > qend ? qend : next + chunk);
+    return true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_workq_next(QUO_workq_t *wq,
+               int64_t *out_begin,
+               int64_t *out_end)
+{
+    if (!wq || !out_begin || !out_end) return QUO_ERR_INVLD_ARG;
+    *out_begin = *out_end = 0;
+
+    /* home first, then everyone else's, in order */
+    for (; wq->nempty < wq->nsubs; ++wq->nempty) {
+        const int i = (wq->home + wq->nempty) % wq->nsubs;
+        if (workq_take(wq, i, out_begin, out_end)) return QUO_SUCCESS;
+    }
+    return QUO_SUCCESS;
+}
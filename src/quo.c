@@ -19,6 +19,8 @@
 #include "quo-set.h"
 #include "quo-hwloc.h"
 #include "quo-mpi.h"
+#include "quo-ctrl.h"
+#include "quo-coll.h"
 
 #ifdef HAVE_STDLIB_H
 #include <stdlib.h>
@@ -35,6 +37,12 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+/** Selects the node barrier implementation: "tree" (default) or "pthread". */
+#define QUO_BARRIER_IMPL_ENV_VAR_STR "QUO_BARRIER_IMPL"
 
 /* ////////////////////////////////////////////////////////////////////////// */
 static int
@@ -58,6 +66,63 @@ out:
     return rc;
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+ctrl_barrier(void *ctrl)
+{
+    return quo_ctrl_barrier((quo_ctrl_t *)ctrl);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Returns whether or not there are more node processes than PUs, in which case
+ * spinning doesn't pay off.
+ */
+static int
+node_oversubscribed(QUO_t *q,
+                    bool *out_oversubscribed)
+{
+    int rc = QUO_SUCCESS, npus = 0, nqid = 0;
+
+    rc = quo_hwloc_get_nobjs_by_type(q->hwloc, QUO_OBJ_PU, &npus);
+    if (QUO_SUCCESS != rc) return rc;
+    if (QUO_SUCCESS != (rc = quo_mpi_nnoderanks(q->mpi, &nqid))) return rc;
+    *out_oversubscribed = (nqid > npus);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Switches the node barrier over to the control region's tree barrier, unless
+ * the pthread one was asked for. Barrier groups are sockets, or none at all if
+ * some process isn't bound within a single socket.
+ */
+static int
+init_barrier(QUO_t *q)
+{
+    int rc = QUO_SUCCESS, group = -1;
+    bool oversubscribed = false;
+    const char *impl = getenv(QUO_BARRIER_IMPL_ENV_VAR_STR);
+
+    /* spinning only pays off when everyone has a PU of their own */
+    if (QUO_SUCCESS != (rc = node_oversubscribed(q, &oversubscribed))) {
+        return rc;
+    }
+    rc = quo_ctrl_set_oversubscribed(q->ctrl, oversubscribed);
+    if (QUO_SUCCESS != rc) return rc;
+    if (impl && 0 == strcmp(impl, "pthread")) return QUO_SUCCESS;
+
+    /* -1 if I'm not within a single socket: the barrier tree then goes flat.
+     * a failed lookup is treated the same, since the setup is collective */
+    if (QUO_SUCCESS != quo_hwloc_get_obj_index_covering_cur_bind(
+                           q->hwloc, QUO_OBJ_SOCKET, &group)) {
+        group = -1;
+    }
+    rc = quo_ctrl_barrier_setup(q->ctrl, q->mpi, group);
+    if (QUO_SUCCESS != rc) return rc;
+    return quo_mpi_set_sm_barrier(q->mpi, ctrl_barrier, q->ctrl);
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 static int
 construct_quoc(QUO_t **q)
@@ -79,6 +144,14 @@ construct_quoc(QUO_t **q)
         QUO_ERR_MSGRC("quo_mpi_construct", qrc);
         goto out;
     }
+    if (QUO_SUCCESS != (qrc = quo_ctrl_construct(&newq->ctrl))) {
+        QUO_ERR_MSGRC("quo_ctrl_construct", qrc);
+        goto out;
+    }
+    if (QUO_SUCCESS != (qrc = quo_coll_construct(&newq->coll))) {
+        QUO_ERR_MSGRC("quo_coll_construct", qrc);
+        goto out;
+    }
 out:
     if (QUO_SUCCESS != qrc) {
         QUO_free(newq);
@@ -88,6 +161,49 @@ out:
     return qrc;
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Adopts a binding posted by QUO_rebind_node, if any. Everything that pushes
+ * onto or pops off the bind stack calls this first, so that a rebinding never
+ * replaces the wrong entry.
+ */
+int
+quo_rebind_sync(QUO_t *q,
+                bool *out_rebound)
+{
+    int rc = QUO_SUCCESS, nulongs = 0;
+    bool posted = false;
+    unsigned long *masks = NULL;
+    hwloc_cpuset_t cpuset = NULL;
+
+    if (out_rebound) *out_rebound = false;
+    /* fast path: nothing was posted since we last looked */
+    if (!quo_ctrl_rebind_pending(q->ctrl)) return QUO_SUCCESS;
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
+        return rc;
+    }
+    if (NULL == (masks = calloc(nulongs, sizeof(*masks)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    rc = quo_ctrl_rebind_fetch(q->ctrl, masks, &posted);
+    if (QUO_SUCCESS != rc || !posted) goto out;
+    if (NULL == (cpuset = hwloc_bitmap_alloc())) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    (void)hwloc_bitmap_from_ulongs(cpuset, (unsigned)nulongs, masks);
+    if (QUO_SUCCESS != (rc = quo_hwloc_bind_replace_top(q->hwloc, cpuset))) {
+        goto out;
+    }
+    if (out_rebound) *out_rebound = true;
+out:
+    if (masks) free(masks);
+    if (cpuset) hwloc_bitmap_free(cpuset);
+    return rc;
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* public api routines */
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -131,6 +247,23 @@ QUO_create_with_flags(QUO_context *q,
         QUO_ERR_MSGRC("quo_hwloc_init", rc);
         goto out;
     }
+    /* The control region's slots hold cpusets, so hwloc must be ready. */
+    int nulongs = 0;
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(tq->hwloc, &nulongs))) {
+        QUO_ERR_MSGRC("quo_hwloc_cpuset_nulongs", rc);
+        goto out;
+    }
+    if (QUO_SUCCESS != (rc = quo_ctrl_init(tq->ctrl, tq->mpi, nulongs))) {
+        QUO_ERR_MSGRC("quo_ctrl_init", rc);
+        goto out;
+    }
+    rc = quo_hwloc_set_bind_epoch(tq->hwloc,
+                                  quo_ctrl_bind_epoch_ptr(tq->ctrl));
+    if (QUO_SUCCESS != rc) goto out;
+    if (QUO_SUCCESS != (rc = init_barrier(tq))) {
+        QUO_ERR_MSGRC("init_barrier", rc);
+        goto out;
+    }
     tq->initialized = true;
     /* Since we use internal QUO_ calls that require an initialized context, do
      * this after we set the initialized flag to true. */
@@ -155,6 +288,16 @@ QUO_free(QUO_t *q)
     if (q->hwloc) {
         if (QUO_SUCCESS != quo_hwloc_destruct(q->hwloc)) nerrs++;
     }
+    if (q->ad_memo.my_masks) free(q->ad_memo.my_masks);
+    if (q->ad_memo.assign) free(q->ad_memo.assign);
+    if (q->coll) {
+        if (QUO_SUCCESS != quo_coll_destruct(q->coll)) nerrs++;
+    }
+    if (q->ctrl) {
+        /* the node barrier may live in the control region */
+        if (q->mpi) (void)quo_mpi_set_sm_barrier(q->mpi, NULL, NULL);
+        if (QUO_SUCCESS != quo_ctrl_destruct(q->ctrl)) nerrs++;
+    }
     if (q->mpi) {
         if (QUO_SUCCESS != quo_mpi_destruct(q->mpi)) nerrs++;
     }
@@ -374,20 +517,316 @@ QUO_bind_push(QUO_t *q,
               QUO_obj_type_t type,
               int obj_index)
 {
+    int rc = QUO_SUCCESS;
+
     if (!q) return QUO_ERR_INVLD_ARG;
     QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
     return quo_hwloc_bind_push(q->hwloc, policy, type, (unsigned)obj_index);
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_bind_push_cpuset(QUO_t *q,
+                     const char *cpuset)
+{
+    int rc = QUO_ERR;
+    hwloc_cpuset_t target = NULL;
+
+    if (!q || !cpuset) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
+    rc = quo_hwloc_cpuset_from_str(q->hwloc, cpuset, &target);
+    if (QUO_SUCCESS != rc) return rc;
+    rc = quo_hwloc_bind_push_cpuset(q->hwloc, target);
+    hwloc_bitmap_free(target);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_bind_push_split(QUO_t *q,
+                    int nparts,
+                    int part,
+                    QUO_obj_type_t granularity)
+{
+    int rc = QUO_ERR;
+    hwloc_cpuset_t target = NULL;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
+    rc = quo_hwloc_get_split_cpuset(q->hwloc, nparts, part, granularity,
+                                    &target);
+    if (QUO_SUCCESS != rc) return rc;
+    rc = quo_hwloc_bind_push_cpuset(q->hwloc, target);
+    hwloc_bitmap_free(target);
+    return rc;
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 int
 QUO_bind_pop(QUO_t *q)
 {
+    int rc = QUO_SUCCESS;
+
     if (!q) return QUO_ERR_INVLD_ARG;
     QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
     return quo_hwloc_bind_pop(q->hwloc);
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_bind_stats_enable(QUO_t *q,
+                      int enable)
+{
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    return quo_hwloc_bind_stats_enable(q->hwloc, 0 != enable);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_bind_stats(QUO_t *q,
+               QUO_bind_stats_t *stats)
+{
+    if (!q || !stats) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    return quo_hwloc_bind_stats(q->hwloc, stats);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_bind_stats_reset(QUO_t *q)
+{
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    return quo_hwloc_bind_stats_reset(q->hwloc);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_rebind_node(QUO_t *q,
+                const char *const *cpusets)
+{
+    int rc = QUO_SUCCESS, nulongs = 0;
+    hwloc_cpuset_t *targets = NULL;
+    unsigned long *masks = NULL;
+
+    if (!q || !cpusets) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
+        return rc;
+    }
+    targets = calloc(q->nqid, sizeof(*targets));
+    masks = calloc(nulongs, sizeof(*masks));
+    if (!targets || !masks) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    /* validate everything before touching anyone's binding */
+    for (int qid = 0; qid < q->nqid; ++qid) {
+        if (!cpusets[qid]) continue;
+        rc = quo_hwloc_cpuset_from_str(q->hwloc, cpusets[qid], &targets[qid]);
+        if (QUO_SUCCESS != rc) goto out;
+    }
+    for (int qid = 0; qid < q->nqid; ++qid) {
+        pid_t pid;
+        if (!targets[qid]) continue;
+        if (QUO_SUCCESS != (rc = quo_mpi_smprank2pid(q->mpi, qid, &pid))) {
+            goto out;
+        }
+        /* bind first so the target's binding is already in effect by the
+         * time it sees the request. */
+        rc = quo_hwloc_set_proc_cpubind(q->hwloc, pid, targets[qid]);
+        if (QUO_SUCCESS != rc) goto out;
+        (void)hwloc_bitmap_to_ulongs(targets[qid], (unsigned)nulongs, masks);
+        if (QUO_SUCCESS != (rc = quo_ctrl_rebind_post(q->ctrl, qid, masks))) {
+            goto out;
+        }
+    }
+    /* if we rebound ourselves, then adopt it now */
+    if (targets[q->qid]) rc = quo_rebind_sync(q, NULL);
+out:
+    if (targets) {
+        for (int qid = 0; qid < q->nqid; ++qid) {
+            if (targets[qid]) hwloc_bitmap_free(targets[qid]);
+        }
+        free(targets);
+    }
+    if (masks) free(masks);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_rebind_poll(QUO_t *q,
+                int *out_rebound)
+{
+    int rc = QUO_SUCCESS;
+    bool rebound = false;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, &rebound))) return rc;
+    if (out_rebound) *out_rebound = rebound ? 1 : 0;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_lend(QUO_t *q)
+{
+    int rc = QUO_SUCCESS, nulongs = 0;
+    unsigned long *masks = NULL;
+    hwloc_cpuset_t cur_bind = NULL;
+    hwloc_const_cpuset_t machine = NULL;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
+        return rc;
+    }
+    if (NULL == (masks = calloc(nulongs, sizeof(*masks)))) {
+        QUO_OOR_COMPLAIN();
+        return QUO_ERR_OOR;
+    }
+    if (QUO_SUCCESS != (rc = quo_hwloc_get_cur_bind(q->hwloc, &cur_bind))) {
+        goto out;
+    }
+    /* an unbound process' cpuset is infinite, so only lend what exists */
+    rc = quo_hwloc_get_obj_cpuset(q->hwloc, QUO_OBJ_MACHINE, 0, &machine);
+    if (QUO_SUCCESS != rc) goto out;
+    hwloc_bitmap_and(cur_bind, cur_bind, machine);
+    (void)hwloc_bitmap_to_ulongs(cur_bind, (unsigned)nulongs, masks);
+    rc = quo_ctrl_lend(q->ctrl, masks);
+out:
+    if (masks) free(masks);
+    if (cur_bind) hwloc_bitmap_free(cur_bind);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_lend_reclaim(QUO_t *q)
+{
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    return quo_ctrl_lend_reclaim(q->ctrl);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_borrow(QUO_t *q,
+           QUO_obj_type_t within,
+           int max_lenders,
+           int *out_nborrowed,
+           int *out_npus)
+{
+    int rc = QUO_SUCCESS, nulongs = 0;
+    unsigned long *masks = NULL;
+    hwloc_cpuset_t target = NULL, lent = NULL, near = NULL;
+    hwloc_const_cpuset_t machine = NULL;
+
+    if (!q || max_lenders < 0 || !out_nborrowed) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *out_nborrowed = 0; /* set defaults */
+    if (out_npus) *out_npus = 0;
+    /* one borrow at a time */
+    if (0 != quo_ctrl_lend_nborrowed(q->ctrl)) return QUO_ERR_INVLD_ARG;
+
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
+    if (QUO_SUCCESS != (rc = quo_hwloc_cpuset_nulongs(q->hwloc, &nulongs))) {
+        return rc;
+    }
+    if (QUO_SUCCESS != (rc = quo_hwloc_get_cur_bind(q->hwloc, &target))) {
+        return rc;
+    }
+    rc = quo_hwloc_get_obj_cpuset(q->hwloc, QUO_OBJ_MACHINE, 0, &machine);
+    if (QUO_SUCCESS != rc) goto out;
+    hwloc_bitmap_and(target, target, machine);
+    /* if we span more than one within object, then all of them are near */
+    rc = quo_hwloc_get_objs_cpuset_touching_cur_bind(q->hwloc, within, &near);
+    if (QUO_SUCCESS != rc) goto out;
+    masks = calloc(nulongs, sizeof(*masks));
+    lent = hwloc_bitmap_alloc();
+    if (!masks || !lent) {
+        QUO_OOR_COMPLAIN();
+        rc = QUO_ERR_OOR;
+        goto out;
+    }
+    for (int qid = 0; qid < q->nqid && *out_nborrowed < max_lenders; ++qid) {
+        uint32_t ticket = 0;
+        bool taken = false;
+        if (qid == q->qid) continue;
+        rc = quo_ctrl_lend_peek(q->ctrl, qid, masks, &ticket);
+        if (QUO_ERR_NOT_FOUND == rc) continue;
+        if (QUO_SUCCESS != rc) goto out;
+        (void)hwloc_bitmap_from_ulongs(lent, (unsigned)nulongs, masks);
+        if (!hwloc_bitmap_isincluded(lent, near)) continue;
+        rc = quo_ctrl_lend_take(q->ctrl, qid, ticket, &taken);
+        if (QUO_SUCCESS != rc) goto out;
+        if (!taken) continue;
+        hwloc_bitmap_or(target, target, lent);
+        ++*out_nborrowed;
+    }
+    rc = QUO_SUCCESS;
+    if (0 == *out_nborrowed) goto out;
+    if (QUO_SUCCESS != (rc = quo_hwloc_bind_push_cpuset(q->hwloc, target))) {
+        goto out;
+    }
+    rc = quo_hwloc_bind_stack_depth(q->hwloc, &q->borrow_depth);
+out:
+    /* nothing was pushed, so don't keep anything that we took */
+    if (QUO_SUCCESS != rc && *out_nborrowed > 0) {
+        (void)quo_ctrl_lend_return(q->ctrl);
+        *out_nborrowed = 0;
+    }
+    if (QUO_SUCCESS == rc && out_npus) {
+        *out_npus = hwloc_bitmap_weight(target);
+    }
+    if (masks) free(masks);
+    if (target) hwloc_bitmap_free(target);
+    if (lent) hwloc_bitmap_free(lent);
+    if (near) hwloc_bitmap_free(near);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_borrow_recalled(QUO_t *q,
+                    int *out_recalled)
+{
+    if (!q || !out_recalled) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    *out_recalled = quo_ctrl_lend_recalled(q->ctrl) ? 1 : 0;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_borrow_return(QUO_t *q)
+{
+    int rc = QUO_SUCCESS, depth = 0;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (0 == quo_ctrl_lend_nborrowed(q->ctrl)) return QUO_SUCCESS;
+    /* only pop what QUO_borrow pushed */
+    if (QUO_SUCCESS != (rc = quo_hwloc_bind_stack_depth(q->hwloc, &depth))) {
+        return rc;
+    }
+    if (depth != q->borrow_depth) return QUO_ERR_POP;
+    if (QUO_SUCCESS != (rc = quo_rebind_sync(q, NULL))) return rc;
+    /* stop running on the lenders' cores before they get them back */
+    if (QUO_SUCCESS != (rc = quo_hwloc_bind_pop(q->hwloc))) return rc;
+    return quo_ctrl_lend_return(q->ctrl);
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 int
 QUO_barrier(QUO_t *q)
@@ -397,15 +836,254 @@ QUO_barrier(QUO_t *q)
     return quo_mpi_sm_barrier(q->mpi);
 }
 
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_barrier_arrive(QUO_t *q)
+{
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    return quo_ctrl_barrier_arrive(q->ctrl);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_barrier_test(QUO_t *q,
+                 int *out_done)
+{
+    int rc = QUO_SUCCESS;
+    bool done = false;
+
+    if (!q || !out_done) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = quo_ctrl_barrier_test(q->ctrl, &done))) return rc;
+    *out_done = done ? 1 : 0;
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_barrier_wait(QUO_t *q)
+{
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    return quo_ctrl_barrier_wait(q->ctrl);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Sets up node collectives the first time that they are used. Everyone calls
+ * node collectives together, so this is collective too.
+ */
+static int
+coll_ready(QUO_t *q)
+{
+    int rc = QUO_SUCCESS;
+    bool oversubscribed = false;
+
+    if (quo_coll_initialized(q->coll)) return QUO_SUCCESS;
+    if (QUO_SUCCESS != (rc = node_oversubscribed(q, &oversubscribed))) {
+        return rc;
+    }
+    if (QUO_SUCCESS != (rc = quo_coll_init(q->coll, q->mpi, oversubscribed))) {
+        QUO_ERR_MSGRC("quo_coll_init", rc);
+    }
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_node_bcast(QUO_t *q,
+               void *buffer,
+               int count,
+               QUO_datatype_t datatype,
+               int root)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = coll_ready(q))) return rc;
+    return quo_coll_bcast(q->coll, buffer, count, datatype, root);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_node_reduce(QUO_t *q,
+                const void *sendbuf,
+                void *recvbuf,
+                int count,
+                QUO_datatype_t datatype,
+                QUO_op_t op,
+                int root)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = coll_ready(q))) return rc;
+    return quo_coll_reduce(q->coll, sendbuf, recvbuf, count, datatype, op,
+                           root, false);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_node_allreduce(QUO_t *q,
+                   const void *sendbuf,
+                   void *recvbuf,
+                   int count,
+                   QUO_datatype_t datatype,
+                   QUO_op_t op)
+{
+    int rc = QUO_SUCCESS;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (QUO_SUCCESS != (rc = coll_ready(q))) return rc;
+    return quo_coll_reduce(q->coll, sendbuf, recvbuf, count, datatype, op, 0,
+                           true);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_quiesce(QUO_t *q,
+            int parking_pu)
+{
+    int rc = QUO_SUCCESS, npus = 0;
+    hwloc_const_cpuset_t parking = NULL;
+
+    if (!q) return QUO_ERR_INVLD_ARG;
+    QUO_NO_INIT_ACTION(q);
+    if (parking_pu < 0) return quo_ctrl_quiesce(q->ctrl);
+
+    if (QUO_SUCCESS != (rc = QUO_npus(q, &npus))) return rc;
+    if (parking_pu >= npus) return QUO_ERR_INVLD_ARG;
+    rc = quo_hwloc_get_obj_cpuset(q->hwloc, QUO_OBJ_PU, (unsigned)parking_pu,
+                                  &parking);
+    if (QUO_SUCCESS != rc) return rc;
+    /* parking isn't a binding change anyone should know about: going through
+     * the bind stack would bump the node binding epoch twice, and with it
+     * invalidate everything that was computed from the current bindings. */
+    rc = quo_hwloc_set_cpubind_quiet(q->hwloc, parking);
+    if (QUO_SUCCESS != rc) return rc;
+    rc = quo_ctrl_quiesce(q->ctrl);
+    /* unpark to the top of the bind stack, not to a copy taken before we
+     * slept, then adopt whatever QUO_rebind_node posted in the meantime */
+    const int prc = quo_hwloc_bind_restore_quiet(q->hwloc);
+    if (QUO_SUCCESS == rc) rc = prc;
+    if (QUO_SUCCESS == rc) rc = quo_rebind_sync(q, NULL);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Common path for QUO_get_mpi_comm_by_type and QUO_borrow_mpi_comm_by_type.
+ */
+static int
+comm_by_type(QUO_t *q,
+             QUO_obj_type_t target_type,
+             bool borrow,
+             MPI_Comm *out_comm)
+{
+    int rc = QUO_SUCCESS, obj_index = -1;
+
+    if (!q || !out_comm) return QUO_ERR_INVLD_ARG;
+    /* make sure we are initialized before we continue */
+    QUO_NO_INIT_ACTION(q);
+
+    if (QUO_OBJ_MACHINE != target_type) {
+        rc = quo_hwloc_get_obj_index_covering_cur_bind(q->hwloc, target_type,
+                                                       &obj_index);
+        if (QUO_ERR_INVLD_ARG == rc) return QUO_ERR_NOT_SUPPORTED;
+        if (QUO_SUCCESS != rc) return rc;
+    }
+    return quo_mpi_get_comm_by_type(q->mpi, target_type, obj_index,
+                                    quo_ctrl_bind_epoch(q->ctrl), borrow,
+                                    out_comm);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Common path for QUO_get_mpi_leader_comm_by_type and
+ * QUO_borrow_mpi_leader_comm_by_type.
+ */
+static int
+leader_comm_by_type(QUO_t *q,
+                    QUO_obj_type_t target_type,
+                    QUO_leader_policy_t policy,
+                    bool borrow,
+                    MPI_Comm *out_comm)
+{
+    int rc = QUO_SUCCESS, obj_index = -1, closeness = 0;
+
+    if (!q || !out_comm) return QUO_ERR_INVLD_ARG;
+    if (QUO_LEADER_LOWEST_QID != policy && QUO_LEADER_NIC_CLOSEST != policy) {
+        return QUO_ERR_INVLD_ARG;
+    }
+    /* make sure we are initialized before we continue */
+    QUO_NO_INIT_ACTION(q);
+
+    if (QUO_OBJ_MACHINE != target_type) {
+        rc = quo_hwloc_get_obj_index_covering_cur_bind(q->hwloc, target_type,
+                                                       &obj_index);
+        if (QUO_ERR_INVLD_ARG == rc) return QUO_ERR_NOT_SUPPORTED;
+        if (QUO_SUCCESS != rc) return rc;
+    }
+    if (QUO_LEADER_NIC_CLOSEST == policy) {
+        rc = quo_hwloc_get_nic_closeness(q->hwloc, &closeness);
+        if (QUO_SUCCESS != rc) return rc;
+    }
+    return quo_mpi_get_leader_comm_by_type(q->mpi, target_type, obj_index,
+                                           policy, closeness,
+                                           quo_ctrl_bind_epoch(q->ctrl),
+                                           borrow, out_comm);
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 int
 QUO_get_mpi_comm_by_type(QUO_t *q,
                          QUO_obj_type_t target_type,
                          MPI_Comm *out_comm)
 {
-    if (!q || !out_comm) return QUO_ERR_INVLD_ARG;
+    return comm_by_type(q, target_type, false, out_comm);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_get_mpi_leader_comm_by_type(QUO_t *q,
+                                QUO_obj_type_t target_type,
+                                QUO_leader_policy_t policy,
+                                MPI_Comm *out_comm)
+{
+    return leader_comm_by_type(q, target_type, policy, false, out_comm);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_borrow_mpi_comm_by_type(QUO_t *q,
+                            QUO_obj_type_t target_type,
+                            MPI_Comm *out_comm)
+{
+    return comm_by_type(q, target_type, true, out_comm);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_borrow_mpi_leader_comm_by_type(QUO_t *q,
+                                   QUO_obj_type_t target_type,
+                                   QUO_leader_policy_t policy,
+                                   MPI_Comm *out_comm)
+{
+    return leader_comm_by_type(q, target_type, policy, true, out_comm);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+QUO_return_mpi_comm(QUO_t *q,
+                    MPI_Comm *comm)
+{
+    if (!q || !comm) return QUO_ERR_INVLD_ARG;
     /* make sure we are initialized before we continue */
     QUO_NO_INIT_ACTION(q);
 
-    return quo_mpi_get_comm_by_type(q->mpi, target_type, out_comm);
+    return quo_mpi_return_comm(q->mpi, comm);
 }
@@ -20,6 +20,9 @@
 /* For MPI_Comm type */
 #include "mpi.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +50,49 @@ typedef struct QUO_t QUO_t;
 /** External QUO context type. */
 typedef QUO_t * QUO_context;
 
+/** Opaque QUO binding plan. */
+struct QUO_plan_t;
+/** Convenience typedef. */
+typedef struct QUO_plan_t QUO_plan_t;
+/** External QUO binding plan type. */
+typedef QUO_plan_t * QUO_plan;
+/** Opaque QUO process subset. */
+struct QUO_subset_t;
+/** Convenience typedef. */
+typedef struct QUO_subset_t QUO_subset_t;
+/** External QUO process subset type. */
+typedef QUO_subset_t * QUO_subset;
+/** Opaque QUO node-wide lock. */
+struct QUO_lock_t;
+/** Convenience typedef. */
+typedef struct QUO_lock_t QUO_lock_t;
+/** External QUO node-wide lock type. */
+typedef QUO_lock_t * QUO_lock;
+/** Opaque QUO node-wide semaphore. */
+struct QUO_sem_t;
+/** Convenience typedef. */
+typedef struct QUO_sem_t QUO_sem_t;
+/** External QUO node-wide semaphore type. */
+typedef QUO_sem_t * QUO_sem;
+/** Opaque QUO node-wide counter. */
+struct QUO_counter_t;
+/** Convenience typedef. */
+typedef struct QUO_counter_t QUO_counter_t;
+/** External QUO node-wide counter type. */
+typedef QUO_counter_t * QUO_counter;
+/** Opaque QUO node-local ring buffer. */
+struct QUO_ring_t;
+/** Convenience typedef. */
+typedef struct QUO_ring_t QUO_ring_t;
+/** External QUO node-local ring buffer type. */
+typedef QUO_ring_t * QUO_ring;
+/** Opaque QUO node-wide work queue. */
+struct QUO_workq_t;
+/** Convenience typedef. */
+typedef struct QUO_workq_t QUO_workq_t;
+/** External QUO node-wide work queue type. */
+typedef QUO_workq_t * QUO_workq;
+
 /**
  * QUO return codes:
  * - fatal = libquo can no longer function.
@@ -92,7 +138,9 @@ typedef enum {
     /** Core. */
     QUO_OBJ_CORE,
     /** Processing unit (e.g. hardware thread). */
-    QUO_OBJ_PU
+    QUO_OBJ_PU,
+    /** Level 3 (data or unified) cache. */
+    QUO_OBJ_L3CACHE
 } QUO_obj_type_t;
 
 /** Push policies that influence QUO_bind_push behavior. */
@@ -100,9 +148,19 @@ typedef enum {
     /** Push the exact binding policy that was provided. */
     QUO_BIND_PUSH_PROVIDED = 0,
     /** Push to the enclosing QUO_obj_type_t provided. */
-    QUO_BIND_PUSH_OBJ
+    QUO_BIND_PUSH_OBJ,
+    /** Push an arbitrary cpuset. Only valid via QUO_bind_push_cpuset. */
+    QUO_BIND_PUSH_CPUSET
 } QUO_bind_push_policy_t;
 
+/** How QUO_get_mpi_leader_comm_by_type picks leaders. */
+typedef enum {
+    /** The process with the lowest QID leads. */
+    QUO_LEADER_LOWEST_QID = 0,
+    /** The process bound closest to the node's network interface leads. */
+    QUO_LEADER_NIC_CLOSEST
+} QUO_leader_policy_t;
+
 /** Context-specific flags that influence how QUO behaves. */
 typedef enum {
     /** No flags. If provided, behaves like QUO_create(). */
@@ -111,6 +169,129 @@ typedef enum {
     QUO_CREATE_NO_MT
 } QUO_create_flags_t;
 
+/** Flags that influence QUO_auto_distrib_assign behavior. */
+typedef enum {
+    /** No flags. */
+    QUO_AUTO_DISTRIB_NO_FLAGS = 0,
+    /** Selected processes push a binding to their assigned resource. */
+    QUO_AUTO_DISTRIB_BIND_PUSH = 1
+} QUO_auto_distrib_flags_t;
+
+/** Element types supported by node collectives (e.g., QUO_node_allreduce). */
+typedef enum {
+    /** int */
+    QUO_INT = 0,
+    /** long */
+    QUO_LONG,
+    /** unsigned long */
+    QUO_UNSIGNED_LONG,
+    /** int64_t */
+    QUO_INT64,
+    /** uint64_t */
+    QUO_UINT64,
+    /** float */
+    QUO_FLOAT,
+    /** double */
+    QUO_DOUBLE
+} QUO_datatype_t;
+
+/** Reduction operations supported by node collectives. */
+typedef enum {
+    /** Sum. */
+    QUO_SUM = 0,
+    /** Product. */
+    QUO_PROD,
+    /** Minimum. */
+    QUO_MIN,
+    /** Maximum. */
+    QUO_MAX
+} QUO_op_t;
+
+/** How a work queue sizes the chunks that it hands out. */
+typedef enum {
+    /** Every chunk has chunk_size tasks. */
+    QUO_WORKQ_DYNAMIC = 0,
+    /** Chunks shrink with the remaining work, down to chunk_size tasks. */
+    QUO_WORKQ_GUIDED
+} QUO_workq_schedule_t;
+
+/** Work queue flags. See QUO_workq_create. */
+typedef enum {
+    /** No flags. */
+    QUO_WORKQ_NO_FLAGS = 0,
+    /** One sub-queue per NUMA node; processes steal once theirs is empty. */
+    QUO_WORKQ_NUMA = 1
+} QUO_workq_flags_t;
+
+/** Ring buffer producers. See QUO_ring_create. */
+enum {
+    /** Any node process may enqueue. */
+    QUO_RING_ANY_PRODUCER = -1
+};
+
+/**
+ * Traffic estimates reported by QUO_reorder_comm_graph and
+ * QUO_reorder_comm_cart, summed over the whole job.
+ */
+typedef struct QUO_reorder_info_t {
+    /** Edge weight between processes on different sockets before reordering. */
+    int64_t cross_socket_before;
+    /** Edge weight between processes on different sockets after reordering. */
+    int64_t cross_socket_after;
+} QUO_reorder_info_t;
+
+/** How processes are distributed over the objects of a policy level. */
+typedef enum {
+    /** Round-robin over the objects (most resources per process). */
+    QUO_POLICY_SPREAD = 0,
+    /** Fill the objects one after the other (most sharing). */
+    QUO_POLICY_PACK
+} QUO_policy_mode_t;
+
+/** One level of a hierarchical distribution policy. */
+typedef struct QUO_policy_level_t {
+    /** Object type at this level. */
+    QUO_obj_type_t type;
+    /** How processes are distributed over the objects at this level. */
+    QUO_policy_mode_t mode;
+} QUO_policy_level_t;
+
+/** Hierarchical distribution policy. See QUO_policy_distrib. */
+typedef struct QUO_policy_t {
+    /** Object type that processes are counted against (e.g., sockets). */
+    QUO_obj_type_t ppr_type;
+    /** Number of processes per ppr_type object. */
+    int ppr;
+    /** Number of entries in levels (may be 0). */
+    int nlevels;
+    /** Levels nested inside ppr_type objects, outermost first. */
+    const QUO_policy_level_t *levels;
+    /** Type of the objects that every process is bound to (e.g., cores). */
+    QUO_obj_type_t pe_type;
+    /** Number of pe_type objects that every process is bound to. */
+    int pe;
+} QUO_policy_t;
+
+/** Binding instrumentation counters. See QUO_bind_stats_enable. */
+typedef struct QUO_bind_stats_t {
+    /** Number of instrumented binding changes made by pushes. */
+    unsigned long long npushes;
+    /** Number of instrumented binding changes made by pops. */
+    unsigned long long npops;
+    /** Total time spent in the binding system call (seconds). */
+    double syscall_time;
+    /** Longest time spent in the binding system call (seconds). */
+    double syscall_time_max;
+    /** Total time until all running threads ran inside the new cpuset. */
+    double settle_time;
+    /** Longest time until all running threads ran inside the new cpuset. */
+    double settle_time_max;
+    /** Number of binding changes that did not settle before timing out. */
+    unsigned long long nsettle_timeouts;
+    /** Number of threads that a binding change forced off of their PU. */
+    unsigned long long nmigrations;
+} QUO_bind_stats_t;
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 /* QUO API */
@@ -511,6 +692,75 @@ QUO_bind_push(QUO_context q,
               QUO_obj_type_t type,
               int obj_index);
 
+/**
+ * Similar to QUO_bind_push, but binds the caller to an arbitrary cpuset
+ * (QUO_BIND_PUSH_CPUSET policy). Useful for placements that cannot be expressed
+ * as a single hardware object (e.g., cores 0-5 of socket 0 plus core 24). The
+ * new policy is maintained in the current context's stack, so QUO_bind_pop
+ * reverts to the previous binding policy.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] cpuset The cpuset to bind to. Either an hwloc list string (e.g.,
+ *                   "0-5,24", the format returned by QUO_stringify_cbind) or an
+ *                   hwloc bitmask string starting with 0x (e.g., "0x0100003f").
+ *                   PU indices are OS indices.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the cpuset cannot be parsed, is empty, or is not
+ *                           within the caller's allowed cpuset.
+ *
+ * \code{.c}
+ * if (QUO_SUCCESS != QUO_bind_push_cpuset(q, "0-5,24")) {
+ *     // error handling //
+ * }
+ * // revert to previous process binding policy //
+ * if (QUO_SUCCESS != QUO_bind_pop(q)) {
+ *     // error handling //
+ * }
+ * \endcode
+ */
+int
+QUO_bind_push_cpuset(QUO_context q,
+                     const char *cpuset);
+
+/**
+ * Similar to QUO_bind_push, but splits the caller's current binding into nparts
+ * contiguous, near-equal chunks along topology boundaries and binds to chunk
+ * part. Chunks are built from objects of type granularity in logical order, so
+ * neighboring chunks share as much cache as possible. If there are fewer such
+ * objects than nparts, cores are used and then PUs. If there are fewer PUs than
+ * nparts, some parts share a PU. QUO_bind_pop reverts to the previous binding
+ * policy.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] nparts Number of parts to split the current binding into.
+ *
+ * @param[in] part Which part to bind to (0 <= part < nparts).
+ *
+ * @param[in] granularity Coarsest object type that chunks are made of.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ * // bind each of my 4 sub-tasks to a quarter of my cores //
+ * if (QUO_SUCCESS != QUO_bind_push_split(q, 4, task_id, QUO_OBJ_CORE)) {
+ *     // error handling //
+ * }
+ * // revert to previous process binding policy //
+ * if (QUO_SUCCESS != QUO_bind_pop(q)) {
+ *     // error handling //
+ * }
+ * \endcode
+ */
+int
+QUO_bind_push_split(QUO_context q,
+                    int nparts,
+                    int part,
+                    QUO_obj_type_t granularity);
+
 /**
  * Routine that changes the caller's process binding policy by replacing
  * it with the policy at the top of the provided context's process bind stack.
@@ -534,6 +784,220 @@ QUO_bind_push(QUO_context q,
 int
 QUO_bind_pop(QUO_context q);
 
+/**
+ * Enables or disables binding instrumentation for the provided context. When
+ * enabled, every binding change made through the context's bind stack (pushes,
+ * pops, and adopted remote rebinds) records the time spent in the binding
+ * system call and the time until all of the process' running threads were
+ * observed running inside the new cpuset (sampled from /proc/self/task), as
+ * well as the number of threads the change forced to migrate. Instrumentation
+ * adds overhead to every binding change, so it is disabled by default. Setting
+ * the QUO_BIND_STATS environment variable enables it at context creation.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] enable Non-zero enables instrumentation, zero disables it.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_bind_stats_enable(QUO_context q,
+                      int enable);
+
+/**
+ * Returns a copy of the context's binding instrumentation counters.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[out] stats Binding instrumentation counters.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ * QUO_bind_stats_t stats;
+ * if (QUO_SUCCESS != QUO_bind_stats(q, &stats)) {
+ *     // error handling //
+ * }
+ * printf("forced migrations: %llu\n", stats.nmigrations);
+ * \endcode
+ */
+int
+QUO_bind_stats(QUO_context q,
+               QUO_bind_stats_t *stats);
+
+/**
+ * Zeros the context's binding instrumentation counters.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_bind_stats_reset(QUO_context q);
+
+/**
+ * Non-collective routine that lets a single node process (e.g., QID 0) change
+ * the bindings of any node process without their participation. Targets are
+ * rebound immediately by the caller; their bind stacks are updated through
+ * shared memory the next time they call QUO_rebind_poll or anything that pushes
+ * onto or pops off their bind stack (e.g., QUO_bind_push, QUO_bind_pop,
+ * QUO_plan_enter, or QUO_auto_distrib_assign with QUO_AUTO_DISTRIB_BIND_PUSH).
+ * A remote rebinding replaces the target's
+ * current binding (the top of its bind stack) instead of pushing a new one, so
+ * that targets can be rebound any number of times. It follows that a target's
+ * next QUO_bind_pop undoes the rebinding along with the target's last push: it
+ * reverts to whatever the target was bound to before that push, not to what it
+ * was bound to right before the rebinding. Until a target notices, its bind
+ * stack still has the old binding on top; that is never acted upon, since every
+ * call that uses the stack adopts pending bindings first. If a target is
+ * rebound more than once before it notices, only the latest binding is adopted.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] cpusets Array of length QUO_nqids indexed by QID. Each entry is
+ *                    either NULL (leave that process alone) or a cpuset string
+ *                    accepted by QUO_bind_push_cpuset.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if any provided cpuset is invalid. Nothing is
+ *                           rebound in that case.
+ *
+ * @retval QUO_ERR_NOT_SUPPORTED if another process' binding cannot be changed.
+ *
+ * \code{.c}
+ * // QID 0 moves QID 1 to PUs 2-3 //
+ * const char *cpusets[2] = {NULL, "2-3"};
+ * if (0 == qid) {
+ *     if (QUO_SUCCESS != QUO_rebind_node(q, cpusets)) {
+ *         // error handling //
+ *     }
+ * }
+ * \endcode
+ */
+int
+QUO_rebind_node(QUO_context q,
+                const char *const *cpusets);
+
+/**
+ * Adopts a pending binding set by another node process via QUO_rebind_node, if
+ * any. Cheap enough to call from within a compute loop: when nothing is pending
+ * this is a single load from shared memory.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[out] out_rebound Flag indicating whether or not a new binding was
+ *                         adopted (1 if so, 0 otherwise). May be NULL.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_rebind_poll(QUO_context q,
+                int *out_rebound);
+
+/**
+ * Lends the caller's current binding to other node processes, which can then
+ * take it over with QUO_borrow while the caller is idle. Not collective. Must
+ * be followed by a call to QUO_lend_reclaim before the caller runs work of its
+ * own again.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller is already lending or borrowing.
+ *
+ * \code{.c}
+ * // Idle process.
+ * QUO_lend(q);
+ * // ... wait for the rest of the phase, e.g., in QUO_quiesce ... //
+ * QUO_lend_reclaim(q);
+ *
+ * // Busy process.
+ * int nborrowed = 0, npus = 0;
+ * QUO_borrow(q, QUO_OBJ_SOCKET, INT_MAX, &nborrowed, &npus);
+ * // ... use npus threads ... //
+ * QUO_borrow_return(q);
+ * \endcode
+ */
+int
+QUO_lend(QUO_context q);
+
+/**
+ * Takes back what QUO_lend lent. If another process borrowed it, asks that
+ * process to give it back (see QUO_borrow_recalled) and waits until it does.
+ * Waiters spin for a little while and then sleep. Does nothing if the caller
+ * isn't lending.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_lend_reclaim(QUO_context q);
+
+/**
+ * Borrows the cores that other node processes lent (see QUO_lend) and pushes a
+ * binding to the union of those cores and the caller's current binding. Not
+ * collective, and never waits for lenders. Must be followed by a call to
+ * QUO_borrow_return, with the binding stack as QUO_borrow left it.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] within Only borrow cores that lie inside the objects of this
+ *                   type that the caller's current binding touches (e.g.,
+ *                   QUO_OBJ_SOCKET to stay close to the caller's memory, or
+ *                   QUO_OBJ_MACHINE for anything on the node).
+ *
+ * @param[in] max_lenders Maximum number of lenders to borrow from.
+ *
+ * @param[out] out_nborrowed Number of lenders borrowed from. If 0, the
+ *                           caller's binding is left alone.
+ *
+ * @param[out] out_npus Number of PUs in the caller's binding after the call
+ *                      (e.g., for sizing a thread team). May be NULL.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller is lending or already borrowing.
+ */
+int
+QUO_borrow(QUO_context q,
+           QUO_obj_type_t within,
+           int max_lenders,
+           int *out_nborrowed,
+           int *out_npus);
+
+/**
+ * Returns whether or not a lender that the caller borrowed from wants its
+ * cores back. Cheap enough to be polled between chunks of work.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[out] out_recalled Flag indicating whether or not a lender is waiting
+ *                          in QUO_lend_reclaim. 1 if so, 0 otherwise.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_borrow_recalled(QUO_context q,
+                    int *out_recalled);
+
+/**
+ * Pops the binding pushed by QUO_borrow and gives all borrowed cores back to
+ * their lenders. Does nothing if the caller didn't borrow anything.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_POP if bindings were pushed or popped since QUO_borrow. Pop
+ *                     (or push) back to where QUO_borrow left the binding
+ *                     stack and try again: the cores are still borrowed.
+ */
+int
+QUO_borrow_return(QUO_context q);
+
 /**
  * Routine that acts as a compute node barrier. All context-initializing
  * processes on a node MUST call this in order for everyone to proceed past the
@@ -562,11 +1026,113 @@ QUO_bind_pop(QUO_context q);
 int
 QUO_barrier(QUO_context q);
 
+/**
+ * Compute node barrier whose waiters don't use any CPU: everyone but the last
+ * arriver sleeps (on a futex in node shared memory, where available) until the
+ * last arriver wakes them all up. Meant for processes that wait while others
+ * run threads on their cores. All context-initializing processes on a node MUST
+ * call this in order for everyone to proceed past the barrier.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] parking_pu If not negative, the logical index of a PU that a
+ *                       waiter binds itself to while it sleeps (on wake-up,
+ *                       it goes back to its binding, or to the one that
+ *                       QUO_rebind_node gave it in the meantime). That keeps
+ *                       waiters out of the way of the workers' threads.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ *  if (working) {
+ *      // *** do work with threads on everyone's cores *** //
+ *      if (QUO_SUCCESS != QUO_quiesce(q, -1)) {
+ *          // error handling //
+ *      }
+ *  } else {
+ *      // non workers sleep on PU 0 //
+ *      if (QUO_SUCCESS != QUO_quiesce(q, 0)) {
+ *          // error handling //
+ *      }
+ *  }
+ *  \endcode
+ */
+int
+QUO_quiesce(QUO_context q,
+            int parking_pu);
+
+/**
+ * First half of a split-phase compute node barrier: signals that the caller
+ * reached the barrier without waiting for anybody else. The caller can then do
+ * independent work (e.g., progress MPI) and only block in QUO_barrier_wait (or
+ * poll with QUO_barrier_test) when it needs the others. All
+ * context-initializing processes on a node MUST arrive in order for the phase
+ * to complete. A process can't arrive again before it saw the phase complete.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller's previous phase is still pending.
+ *
+ * \code{.c}
+ *  if (QUO_SUCCESS != QUO_barrier_arrive(q)) {
+ *      // error handling //
+ *  }
+ *  int done = 0;
+ *  while (!done) {
+ *      // *** do independent work *** //
+ *      if (QUO_SUCCESS != QUO_barrier_test(q, &done)) {
+ *          // error handling //
+ *      }
+ *  }
+ *  \endcode
+ */
+int
+QUO_barrier_arrive(QUO_context q);
+
+/**
+ * Checks whether or not every node process arrived at the caller's current
+ * split-phase barrier phase (see QUO_barrier_arrive). Never blocks.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[out] out_done Flag indicating whether or not the phase is complete
+ *                      (1 if so, 0 otherwise).
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller has no pending phase.
+ */
+int
+QUO_barrier_test(QUO_context q,
+                 int *out_done);
+
+/**
+ * Waits until every node process arrived at the caller's current split-phase
+ * barrier phase (see QUO_barrier_arrive). QUO_barrier_arrive followed by
+ * QUO_barrier_wait acts like QUO_barrier. Waiters spin for a little while and
+ * then sleep.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller has no pending phase.
+ */
+int
+QUO_barrier_wait(QUO_context q);
+
 /**
  * Collective routine that helps evenly distribute processes across hardware
  * resources.  The total number of processes assigned to a particular resource
  * will not exceed max_qids_per_res_type.
  *
+ * Results are cached: if no node process changed its binding through libquo
+ * (e.g., QUO_bind_push or QUO_bind_pop) since the last call with the same
+ * arguments, then the previous answer is returned after a single node barrier.
+ * Bindings changed outside of libquo are not detected.
+ *
  * @param[in] q Constructed and initialized QUO_context.
  *
  * @param[in] distrib_over_this The target hardware resource on which processes
@@ -606,20 +1172,1227 @@ QUO_auto_distrib(QUO_context q,
                  int *out_selected);
 
 /**
+ * Weighted version of QUO_auto_distrib. Every node process provides an estimate
+ * of how much work it has (its weight), and processes are picked (heaviest
+ * first) and spread over the target resources so that the total weight per
+ * resource is as balanced as possible. A process is only ever assigned to a
+ * resource that its current binding covers, and no resource is assigned more
+ * than max_qids_per_res_type processes. Results are never cached.
+ *
  * @param[in] q Constructed and initialized QUO_context.
  *
- * @param[in] target_type Target hardware object type.
+ * @param[in] distrib_over_this See QUO_auto_distrib.
  *
- * @param[out] out_comm MPI_Comm_dup'd communicator containing processes that
- *                      match the target request. Returned resources must be
- *                      freed with a call to MPI_Comm_free.
+ * @param[in] max_qids_per_res_type See QUO_auto_distrib.
+ *
+ * @param[in] weight The calling process' (finite, non-negative) weight. Units
+ *                   don't matter as long as all node processes agree on them.
+ *
+ * @param[out] out_selected Flag indicating whether or not i was chosen in the
+ *                          work distribution. 1 means I was chosen, 0
+ *                          otherwise.
  *
  * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if any node process provided an invalid weight.
+ *
+ * \code{.c}
+ * int res_assigned = 0;
+ * if (QUO_SUCCESS != QUO_auto_distrib_weighted(q, QUO_OBJ_SOCKET, 2,
+ *                                              (double)my_ncells,
+ *                                              &res_assigned)) {
+ *     // error handling //
+ * }
+ * \endcode
  */
 int
-QUO_get_mpi_comm_by_type(QUO_context q,
-                         QUO_obj_type_t target_type,
-                         MPI_Comm *out_comm);
+QUO_auto_distrib_weighted(QUO_context q,
+                          QUO_obj_type_t distrib_over_this,
+                          int max_qids_per_res_type,
+                          double weight,
+                          int *out_selected);
+
+/**
+ * Extended version of QUO_auto_distrib that returns which resource every
+ * selected process was assigned to, and that can bind selected processes to
+ * that resource in the same call. Same selection, cost, and caching as
+ * QUO_auto_distrib.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] distrib_over_this See QUO_auto_distrib.
+ *
+ * @param[in] max_qids_per_res_type See QUO_auto_distrib.
+ *
+ * @param[in] flags Either QUO_AUTO_DISTRIB_NO_FLAGS or
+ *                  QUO_AUTO_DISTRIB_BIND_PUSH. If QUO_AUTO_DISTRIB_BIND_PUSH is
+ *                  provided, then selected processes push a binding to their
+ *                  assigned resource (as if by QUO_bind_push with
+ *                  QUO_BIND_PUSH_PROVIDED) and are responsible for the matching
+ *                  QUO_bind_pop. Other processes keep their binding.
+ *
+ * @param[out] out_res Index of the distrib_over_this resource I was assigned
+ *                     to, or -1 if I wasn't selected.
+ *
+ * @param[out] out_assign If not NULL, every node process' resource (or -1)
+ *                        indexed by QID. Must be large enough to hold
+ *                        QUO_nqids elements.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ * int res = -1;
+ * if (QUO_SUCCESS != QUO_auto_distrib_assign(q, QUO_OBJ_SOCKET, 2,
+ *                                            QUO_AUTO_DISTRIB_BIND_PUSH,
+ *                                            &res, NULL)) {
+ *     // error handling //
+ * }
+ * if (-1 != res) {
+ *     // do work on socket res, then //
+ *     QUO_bind_pop(q);
+ * }
+ * \endcode
+ */
+int
+QUO_auto_distrib_assign(QUO_context q,
+                        QUO_obj_type_t distrib_over_this,
+                        int max_qids_per_res_type,
+                        int flags,
+                        int *out_res,
+                        int *out_assign);
+
+/**
+ * Job-wide version of QUO_auto_distrib_assign. Collective over the
+ * communicator used to initialize the context. Picks nworkers processes across
+ * all nodes so that the workers are spread as evenly as possible over every
+ * node's distrib_over_this resources (e.g., QUO_OBJ_NUMANODE): no resource
+ * gets a second worker before every resource that can have one got one, and so
+ * on. Ties are broken by resource index and then by node, so a job with
+ * identical nodes gets the same number of workers (give or take one) per node.
+ * Within a node, the candidates for a resource are the processes that
+ * QUO_auto_distrib_assign would assign to it. Every worker gets a job-wide
+ * worker ID in [0, nworkers), and all processes agree on the assignment.
+ *
+ * Only node leaders (QID 0) communicate across nodes, with small reductions
+ * that don't depend on the number of processes per node.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] distrib_over_this See QUO_auto_distrib.
+ *
+ * @param[in] max_qids_per_res_type See QUO_auto_distrib.
+ *
+ * @param[in] nworkers Number of workers to pick job-wide. If fewer processes
+ *                     can be placed, then all that can be are picked.
+ *
+ * @param[in] flags See QUO_auto_distrib_assign.
+ *
+ * @param[out] out_res Index of the distrib_over_this resource (on my node) I
+ *                     was assigned to, or -1 if I wasn't picked.
+ *
+ * @param[out] out_worker_id My job-wide worker ID, or -1 if I wasn't picked.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ * int res = -1, wid = -1;
+ * // keep 16 workers job-wide, balanced over NUMA domains
+ * if (QUO_SUCCESS != QUO_global_place(q, QUO_OBJ_NUMANODE, 4, 16,
+ *                                     QUO_AUTO_DISTRIB_NO_FLAGS,
+ *                                     &res, &wid)) {
+ *     // error handling //
+ * }
+ * \endcode
+ */
+int
+QUO_global_place(QUO_context q,
+                 QUO_obj_type_t distrib_over_this,
+                 int max_qids_per_res_type,
+                 int nworkers,
+                 int flags,
+                 int *out_res,
+                 int *out_worker_id);
+
+/**
+ * Collective routine that distributes node processes according to a
+ * hierarchical policy, in the spirit of launcher mappings like
+ * --map-by ppr:2:socket:pe=4. For example, "2 processes per socket, spread over
+ * the NUMA nodes of every socket, packed onto 4 cores each":
+ *
+ * \code{.c}
+ * const QUO_policy_level_t levels[] = {
+ *     {QUO_OBJ_NUMANODE, QUO_POLICY_SPREAD},
+ *     {QUO_OBJ_CORE, QUO_POLICY_PACK}
+ * };
+ * const QUO_policy_t policy = {
+ *     QUO_OBJ_SOCKET, 2,  // ppr_type, ppr
+ *     2, levels,          // nlevels, levels
+ *     QUO_OBJ_CORE, 4     // pe_type, pe
+ * };
+ * int selected = 0;
+ * if (QUO_SUCCESS != QUO_policy_distrib(q, &policy,
+ *                                       QUO_AUTO_DISTRIB_BIND_PUSH,
+ *                                       &selected, NULL)) {
+ *     // error handling //
+ * }
+ * \endcode
+ *
+ * Every ppr_type object gets ppr processes. At every level, the processes of
+ * an object are spread (round-robin) or packed over the level's objects inside
+ * it, and every process ends up with pe consecutive pe_type objects inside the
+ * innermost object. A last level of type pe_type only decides whether those
+ * groups are packed or spread out inside their object. Processes already
+ * bound inside a ppr_type object stay there if it has room; the others take
+ * the remaining places in QID order. Processes beyond the number of places
+ * are not selected.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] policy The distribution policy. Must be the same on all node
+ *                   processes.
+ *
+ * @param[in] flags See QUO_auto_distrib_assign.
+ *
+ * @param[out] out_selected Flag indicating whether or not i was chosen. 1 means
+ *                          I was chosen, 0 otherwise.
+ *
+ * @param[out] out_cbind If not NULL and I was chosen, the binding that the
+ *                       policy gives me in string form (hwloc list format).
+ *                       *out_cbind must be freed by call to free(3). NULL
+ *                       otherwise.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the policy is malformed or doesn't fit the
+ *                           hardware.
+ */
+int
+QUO_policy_distrib(QUO_context q,
+                   const QUO_policy_t *policy,
+                   int flags,
+                   int *out_selected,
+                   char **out_cbind);
+
+/**
+ * Binding plan construction routine. A binding plan holds precomputed phase
+ * information (the member set and every node process' cpuset) so that
+ * recurring phase switches do not have to pay for QUO_auto_distrib each time.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] nphases Number of phases that the plan will hold.
+ *
+ * @param[out] plan Reference to a new QUO_plan. Must be freed by a call to
+ *                  QUO_plan_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \note
+ * Phases are defined with QUO_plan_set_phase.
+ */
+int
+QUO_plan_create(QUO_context q,
+                int nphases,
+                QUO_plan *plan);
+
+/**
+ * Binding plan destruction routine.
+ *
+ * @param[in] plan Plan created by QUO_plan_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_plan_free(QUO_plan plan);
+
+/**
+ * Collective routine that computes a plan phase. The phase's members are the
+ * processes that QUO_auto_distrib selects given distrib_over_this and
+ * max_qids_per_res_type. Members will be bound to the distrib_over_this object
+ * that they were assigned to (see QUO_auto_distrib_assign). All other
+ * processes keep their current binding. Every node process' phase cpuset is exchanged
+ * and stored in the plan.
+ *
+ * @param[in] plan Plan created by QUO_plan_create.
+ *
+ * @param[in] phase Phase ID (base 0).
+ *
+ * @param[in] distrib_over_this See QUO_auto_distrib.
+ *
+ * @param[in] max_qids_per_res_type See QUO_auto_distrib.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \note
+ * Phases should be (re)computed before entering them whenever the process
+ * bindings they were computed from change. The phase that is currently entered
+ * cannot be redefined.
+ */
+int
+QUO_plan_set_phase(QUO_plan plan,
+                   int phase,
+                   QUO_obj_type_t distrib_over_this,
+                   int max_qids_per_res_type);
+
+/**
+ * Enters a precomputed phase. Members push their phase binding; all other
+ * processes are left untouched. No topology queries or shared-memory segment
+ * traffic are performed. If another phase is currently entered, it is left
+ * first.
+ *
+ * @param[in] plan Plan created by QUO_plan_create.
+ *
+ * @param[in] phase Phase ID (base 0) previously set by QUO_plan_set_phase.
+ *
+ * @param[in] sync If non-zero, perform a node barrier (see QUO_barrier) after
+ *                 the binding change. In that case all node processes must
+ *                 call this routine.
+ *
+ * @param[out] out_selected Flag indicating whether or not I am a member of the
+ *                          phase. May be NULL.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ * // once //
+ * QUO_plan plan = NULL;
+ * QUO_plan_create(q, 1, &plan);
+ * QUO_plan_set_phase(plan, 0, QUO_OBJ_SOCKET, 1);
+ * // every time step //
+ * int selected = 0;
+ * QUO_plan_enter(plan, 0, 1, &selected);
+ * if (selected) {
+ *     // threaded work //
+ * }
+ * QUO_plan_leave(plan, 1);
+ * \endcode
+ */
+int
+QUO_plan_enter(QUO_plan plan,
+               int phase,
+               int sync,
+               int *out_selected);
+
+/**
+ * Leaves the currently entered phase (if any), restoring the binding that was
+ * in place when the phase was entered. Anything pushed onto the bind stack
+ * after entering the phase must be popped first.
+ *
+ * @param[in] plan Plan created by QUO_plan_create.
+ *
+ * @param[in] sync If non-zero, perform a node barrier after the binding change.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the phase binding is no longer on top of the
+ *                           bind stack. Nothing is popped in that case, and the
+ *                           phase stays entered.
+ */
+int
+QUO_plan_leave(QUO_plan plan,
+               int sync);
+
+/**
+ * Returns the QIDs that are members of a plan phase.
+ *
+ * @param[in] plan Plan created by QUO_plan_create.
+ *
+ * @param[in] phase Phase ID (base 0).
+ *
+ * @param[out] out_nqids Number of members.
+ *
+ * @param[out] out_qids Sorted array of member QIDs. *out_qids must be freed by
+ *             a call to free(3).
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_plan_members(const QUO_plan_t *plan,
+                 int phase,
+                 int *out_nqids,
+                 int **out_qids);
+
+/**
+ * Similar to QUO_stringify_cbind, but returns the cpuset that a given node
+ * process will have in a plan phase.
+ *
+ * @param[in] plan Plan created by QUO_plan_create.
+ *
+ * @param[in] phase Phase ID (base 0).
+ *
+ * @param[in] qid QID of the node process in question.
+ *
+ * @param[out] cbind_str *cbind_str must be freed by call to free(3).
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_plan_stringify_cbind(const QUO_plan_t *plan,
+                         int phase,
+                         int qid,
+                         char **cbind_str);
+
+/**
+ * Compute node broadcast over shared memory: copies count elements of root's
+ * buffer into everyone else's. All context-initializing processes on a node
+ * MUST call this with the same count, datatype, and root.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in,out] buffer Data (input at root, output everywhere else).
+ *
+ * @param[in] count Number of elements in buffer.
+ *
+ * @param[in] datatype Element type.
+ *
+ * @param[in] root QID of the broadcasting process.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_node_bcast(QUO_context q,
+               void *buffer,
+               int count,
+               QUO_datatype_t datatype,
+               int root);
+
+/**
+ * Compute node reduction over shared memory: combines count elements of
+ * everyone's sendbuf with op into root's recvbuf. Partial results are combined
+ * up a tree in shared memory, so there are no MPI calls. All
+ * context-initializing processes on a node MUST call this with the same count,
+ * datatype, op, and root.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] sendbuf Input data.
+ *
+ * @param[out] recvbuf Result (only significant at root).
+ *
+ * @param[in] count Number of elements in sendbuf and recvbuf.
+ *
+ * @param[in] datatype Element type.
+ *
+ * @param[in] op Reduction operation.
+ *
+ * @param[in] root QID of the process that gets the result.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_node_reduce(QUO_context q,
+                const void *sendbuf,
+                void *recvbuf,
+                int count,
+                QUO_datatype_t datatype,
+                QUO_op_t op,
+                int root);
+
+/**
+ * Same as QUO_node_reduce, but everyone gets the result.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] sendbuf Input data.
+ *
+ * @param[out] recvbuf Result.
+ *
+ * @param[in] count Number of elements in sendbuf and recvbuf.
+ *
+ * @param[in] datatype Element type.
+ *
+ * @param[in] op Reduction operation.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ * // total amount of work on this node //
+ * double mine = my_work, total = 0.0;
+ * if (QUO_SUCCESS != QUO_node_allreduce(q, &mine, &total, 1, QUO_DOUBLE,
+ *                                       QUO_SUM)) {
+ *     // error handling //
+ * }
+ * \endcode
+ */
+int
+QUO_node_allreduce(QUO_context q,
+                   const void *sendbuf,
+                   void *recvbuf,
+                   int count,
+                   QUO_datatype_t datatype,
+                   QUO_op_t op);
+
+/**
+ * Subset construction routine. A subset is a group of node processes that can
+ * synchronize among themselves (see QUO_subset_barrier) without involving the
+ * rest of the node. Collective over the subset's members only: every member
+ * MUST call this with the same list. Cheap enough to be called repeatedly.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] nqids Length of qids.
+ *
+ * @param[in] qids The members' QIDs (in any order). Must include the caller.
+ *
+ * @param[out] subset Reference to a new QUO_subset. Must be freed by a call to
+ *                    QUO_subset_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if a QID is out of range or the caller isn't a
+ *                           member.
+ *
+ * @retval QUO_ERR_OOR if the subset's lowest QID is already a member of too
+ *                     many live subsets that it leads (8).
+ *
+ * \code{.c}
+ * QUO_subset workers = NULL;
+ * if (QUO_SUCCESS != QUO_subset_create(q, nworkers, worker_qids, &workers)) {
+ *     // error handling //
+ * }
+ * // ... //
+ * QUO_subset_barrier(workers);
+ * // ... //
+ * QUO_subset_free(workers);
+ * \endcode
+ */
+int
+QUO_subset_create(QUO_context q,
+                  int nqids,
+                  const int *qids,
+                  QUO_subset *subset);
+
+/**
+ * Similar to QUO_subset_create, but the members are the node processes whose
+ * current binding falls within the given hardware object (see
+ * QUO_qids_in_type). Collective over those processes only.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] type Hardware object type.
+ *
+ * @param[in] in_type_index type's ID (base 0).
+ *
+ * @param[out] subset Reference to a new QUO_subset. Must be freed by a call to
+ *                    QUO_subset_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller isn't bound within the object.
+ */
+int
+QUO_subset_create_in_type(QUO_context q,
+                          QUO_obj_type_t type,
+                          int in_type_index,
+                          QUO_subset *subset);
+
+/**
+ * Subset destruction routine. Collective over the subset's members.
+ *
+ * @param[in] subset Subset created by QUO_subset_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_subset_free(QUO_subset subset);
+
+/**
+ * Barrier over a subset's members. Waiters spin for a little while and then
+ * sleep.
+ *
+ * @param[in] subset Subset created by QUO_subset_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_subset_barrier(QUO_subset subset);
+
+/**
+ * Node-wide lock construction routine. The lock lives in the context's shared
+ * control region, is handed out in FIFO order, and can be used by every node
+ * process. Collective over the node.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[out] lock Reference to a new, unlocked, QUO_lock. Must be freed by a
+ *                  call to QUO_lock_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_OOR if the context is out of synchronization objects (256
+ *                     locks, semaphores, and counters may be live at once).
+ *
+ * \code{.c}
+ * QUO_lock lock = NULL;
+ * if (QUO_SUCCESS != QUO_lock_create(q, &lock)) {
+ *     // error handling //
+ * }
+ * QUO_lock_acquire(lock);
+ * // ... critical section ... //
+ * QUO_lock_release(lock);
+ * // ... //
+ * QUO_lock_free(lock);
+ * \endcode
+ */
+int
+QUO_lock_create(QUO_context q,
+                QUO_lock *lock);
+
+/**
+ * Node-wide lock destruction routine. Collective over the node. The lock must
+ * not be held.
+ *
+ * @param[in] lock Lock created by QUO_lock_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_lock_free(QUO_lock lock);
+
+/**
+ * Acquires a node-wide lock, waiting for it if needed. Waiters back off in
+ * proportion to the number of waiters ahead of them.
+ *
+ * @param[in] lock Lock created by QUO_lock_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_lock_acquire(QUO_lock lock);
+
+/**
+ * Acquires a node-wide lock only if that can be done without waiting.
+ *
+ * @param[in] lock Lock created by QUO_lock_create.
+ *
+ * @param[out] out_acquired Flag indicating whether or not the lock was
+ *                          acquired. 1 if so, 0 otherwise.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_lock_try(QUO_lock lock,
+             int *out_acquired);
+
+/**
+ * Releases a node-wide lock held by the caller.
+ *
+ * @param[in] lock Lock created by QUO_lock_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_lock_release(QUO_lock lock);
+
+/**
+ * Node-wide counting semaphore construction routine. Collective over the
+ * node: every node process MUST call this with the same value.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] value Initial value. Must not be negative.
+ *
+ * @param[out] sem Reference to a new QUO_sem. Must be freed by a call to
+ *                 QUO_sem_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_OOR if the context is out of synchronization objects.
+ */
+int
+QUO_sem_create(QUO_context q,
+               int value,
+               QUO_sem *sem);
+
+/**
+ * Node-wide counting semaphore destruction routine. Collective over the node.
+ *
+ * @param[in] sem Semaphore created by QUO_sem_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_sem_free(QUO_sem sem);
+
+/**
+ * Decrements a semaphore, waiting for it to become positive if needed.
+ * Waiters spin for a little while and then sleep.
+ *
+ * @param[in] sem Semaphore created by QUO_sem_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_sem_wait(QUO_sem sem);
+
+/**
+ * Decrements a semaphore only if it is positive.
+ *
+ * @param[in] sem Semaphore created by QUO_sem_create.
+ *
+ * @param[out] out_acquired Flag indicating whether or not the semaphore was
+ *                          decremented. 1 if so, 0 otherwise.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_sem_trywait(QUO_sem sem,
+                int *out_acquired);
+
+/**
+ * Increments a semaphore, waking up one waiter if there is one.
+ *
+ * @param[in] sem Semaphore created by QUO_sem_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_sem_post(QUO_sem sem);
+
+/**
+ * Node-wide counter construction routine. Collective over the node: every
+ * node process MUST call this with the same value.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] value Initial value.
+ *
+ * @param[out] counter Reference to a new QUO_counter. Must be freed by a call
+ *                     to QUO_counter_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_OOR if the context is out of synchronization objects.
+ *
+ * \code{.c}
+ * QUO_counter next = NULL;
+ * QUO_counter_create(q, 0, &next);
+ * int64_t task = 0;
+ * while (QUO_counter_fetch_add(next, 1, &task), task < ntasks) {
+ *     // ... work on task ... //
+ * }
+ * QUO_counter_free(next);
+ * \endcode
+ */
+int
+QUO_counter_create(QUO_context q,
+                   int64_t value,
+                   QUO_counter *counter);
+
+/**
+ * Node-wide counter destruction routine. Collective over the node.
+ *
+ * @param[in] counter Counter created by QUO_counter_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_counter_free(QUO_counter counter);
+
+/**
+ * Atomically adds to a counter.
+ *
+ * @param[in] counter Counter created by QUO_counter_create.
+ *
+ * @param[in] inc Amount to add (may be negative).
+ *
+ * @param[out] out_old The counter's value before the addition. May be NULL.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_counter_fetch_add(QUO_counter counter,
+                      int64_t inc,
+                      int64_t *out_old);
+
+/**
+ * Reads a counter's current value.
+ *
+ * @param[in] counter Counter created by QUO_counter_create.
+ *
+ * @param[out] out_value The counter's value.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_counter_load(QUO_counter counter,
+                 int64_t *out_value);
+
+/**
+ * Ring buffer construction routine. A ring is a bounded, lock-free queue in
+ * node-local shared memory that carries fixed-size elements from a producer
+ * process (or from any node process) to a consumer process. Collective over
+ * the node: every node process MUST call this with the same arguments.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] producer QID of the only process that may enqueue, or
+ *                     QUO_RING_ANY_PRODUCER. A single producer is cheaper.
+ *
+ * @param[in] consumer QID of the only process that may dequeue.
+ *
+ * @param[in] elem_size Size of an element in bytes.
+ *
+ * @param[in] capacity Minimum number of elements that the ring can hold
+ *                     (rounded up to a power of two).
+ *
+ * @param[out] ring Reference to a new QUO_ring. Must be freed by a call to
+ *                  QUO_ring_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * \code{.c}
+ * QUO_ring ring = NULL;
+ * if (QUO_SUCCESS != QUO_ring_create(q, 0, 1, sizeof(task_t), 1024, &ring)) {
+ *     // error handling //
+ * }
+ * if (0 == qid) {
+ *     int n = 0;
+ *     QUO_ring_enqueue(ring, tasks, ntasks, &n);
+ * }
+ * else if (1 == qid) {
+ *     int n = 0;
+ *     QUO_ring_dequeue_wait(ring, tasks, ntasks, &n);
+ * }
+ * QUO_ring_free(ring);
+ * \endcode
+ */
+int
+QUO_ring_create(QUO_context q,
+                int producer,
+                int consumer,
+                size_t elem_size,
+                int capacity,
+                QUO_ring *ring);
+
+/**
+ * Ring buffer destruction routine. Collective over the node.
+ *
+ * @param[in] ring Ring created by QUO_ring_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_ring_free(QUO_ring ring);
+
+/**
+ * Enqueues as many of the given elements as fit, in order, without waiting.
+ * Wakes up the consumer if it sleeps in QUO_ring_dequeue_wait.
+ *
+ * @param[in] ring Ring created by QUO_ring_create.
+ *
+ * @param[in] elems Elements to enqueue.
+ *
+ * @param[in] nelems Number of elements in elems.
+ *
+ * @param[out] out_nenqueued Number of elements enqueued (the first
+ *                           out_nenqueued of elems). 0 if the ring is full.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller isn't the ring's producer.
+ */
+int
+QUO_ring_enqueue(QUO_ring ring,
+                 const void *elems,
+                 int nelems,
+                 int *out_nenqueued);
+
+/**
+ * Dequeues up to nelems elements without waiting. Only the ring's consumer may
+ * call this.
+ *
+ * @param[in] ring Ring created by QUO_ring_create.
+ *
+ * @param[out] elems Buffer for at least nelems elements.
+ *
+ * @param[in] nelems Maximum number of elements to dequeue.
+ *
+ * @param[out] out_ndequeued Number of elements dequeued. 0 if the ring is
+ *                           empty.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if the caller isn't the ring's consumer.
+ */
+int
+QUO_ring_dequeue(QUO_ring ring,
+                 void *elems,
+                 int nelems,
+                 int *out_ndequeued);
+
+/**
+ * Similar to QUO_ring_dequeue, but waits until at least one element is
+ * available. Waiters spin for a little while and then sleep.
+ *
+ * @param[in] ring Ring created by QUO_ring_create.
+ *
+ * @param[out] elems Buffer for at least nelems elements.
+ *
+ * @param[in] nelems Maximum number of elements to dequeue. Must be positive.
+ *
+ * @param[out] out_ndequeued Number of elements dequeued.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_ring_dequeue_wait(QUO_ring ring,
+                      void *elems,
+                      int nelems,
+                      int *out_ndequeued);
+
+/**
+ * Work queue construction routine. A work queue hands out chunks of the task
+ * range [0, ntasks) to node processes on a first-come, first-served basis, so
+ * that processes that finish early take on more work. Collective over the
+ * node: every node process MUST call this with the same arguments.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] ntasks Number of tasks.
+ *
+ * @param[in] schedule How chunks are sized.
+ *
+ * @param[in] chunk_size Chunk size (QUO_WORKQ_DYNAMIC) or minimum chunk size
+ *                       (QUO_WORKQ_GUIDED). Must be positive.
+ *
+ * @param[in] flags QUO_WORKQ_NO_FLAGS or QUO_WORKQ_NUMA. With QUO_WORKQ_NUMA,
+ *                  the range is split over the NUMA nodes in proportion to
+ *                  the number of node processes bound inside of each, and a
+ *                  process only takes work from other NUMA nodes once its own
+ *                  is drained.
+ *
+ * @param[out] workq Reference to a new QUO_workq. Must be freed by a call to
+ *                   QUO_workq_free before the context is freed.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_OOR if the context is out of synchronization objects.
+ *
+ * \code{.c}
+ * QUO_workq wq = NULL;
+ * QUO_workq_create(q, ntasks, QUO_WORKQ_GUIDED, 4, QUO_WORKQ_NUMA, &wq);
+ * int64_t begin = 0, end = 0;
+ * while (QUO_workq_next(wq, &begin, &end), begin != end) {
+ *     for (int64_t t = begin; t < end; ++t) {
+ *         // ... work on task t ... //
+ *     }
+ * }
+ * QUO_workq_free(wq);
+ * \endcode
+ */
+int
+QUO_workq_create(QUO_context q,
+                 int64_t ntasks,
+                 QUO_workq_schedule_t schedule,
+                 int64_t chunk_size,
+                 int flags,
+                 QUO_workq *workq);
+
+/**
+ * Refills a work queue with the task range [0, ntasks). Collective over the
+ * node: waits for everyone to be done with the previous range.
+ *
+ * @param[in] workq Work queue created by QUO_workq_create.
+ *
+ * @param[in] ntasks Number of tasks.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_workq_reset(QUO_workq workq,
+                int64_t ntasks);
+
+/**
+ * Work queue destruction routine. Collective over the node.
+ *
+ * @param[in] workq Work queue created by QUO_workq_create.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_workq_free(QUO_workq workq);
+
+/**
+ * Takes the next chunk of tasks from a work queue.
+ *
+ * @param[in] workq Work queue created by QUO_workq_create.
+ *
+ * @param[out] out_begin First task of the chunk.
+ *
+ * @param[out] out_end One past the last task of the chunk. Equal to out_begin
+ *                     once all tasks have been handed out.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_workq_next(QUO_workq workq,
+               int64_t *out_begin,
+               int64_t *out_end);
+
+/**
+ * Returns a communicator of the node processes whose current bindings fall in
+ * the same target_type object (e.g., NUMA node, package, or L3 cache) as the
+ * caller's. Collective over the node.
+ *
+ * The underlying communicators are split once and reused until a node process
+ * changes its binding through libquo (e.g., QUO_bind_push or QUO_bind_pop).
+ * Node processes agree on whether to split again, so binding changes never
+ * make them disagree. A communicator reflects the bindings that node processes
+ * had when they made this call, though: to get one that matches new bindings
+ * everywhere, separate binding changes from these calls (e.g., with
+ * QUO_barrier).
+ * To skip the dup as well, see QUO_borrow_mpi_comm_by_type.
+ *
+ * \code{.c}
+ * MPI_Comm numa_comm;
+ * if (QUO_SUCCESS != QUO_get_mpi_comm_by_type(q, QUO_OBJ_NUMANODE,
+ *                                             &numa_comm)) {
+ *     // error handling
+ * }
+ * if (MPI_COMM_NULL != numa_comm) {
+ *     // NUMA-local work
+ *     MPI_Comm_free(&numa_comm);
+ * }
+ * \endcode
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] target_type Target hardware object type.
+ *
+ * @param[out] out_comm MPI_Comm_dup'd communicator containing processes that
+ *                      match the target request. MPI_COMM_NULL if the caller's
+ *                      binding does not fit in a single target_type object.
+ *                      Returned resources must be freed with a call to
+ *                      MPI_Comm_free.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_NOT_SUPPORTED if target_type is not a known type.
+ */
+int
+QUO_get_mpi_comm_by_type(QUO_context q,
+                         QUO_obj_type_t target_type,
+                         MPI_Comm *out_comm);
+
+/**
+ * Returns a communicator of one leader per target_type object (e.g., one
+ * process per node with QUO_OBJ_MACHINE, or one per socket with
+ * QUO_OBJ_SOCKET) across all the processes in the initializing communicator.
+ * Together with QUO_get_mpi_comm_by_type, this makes two-level collectives
+ * easy to write. Collective over the initializing communicator.
+ *
+ * Leaders are picked from the processes that share a target_type object (see
+ * QUO_get_mpi_comm_by_type). Processes whose bindings do not fit in a single
+ * target_type object lead themselves. Like QUO_get_mpi_comm_by_type, the
+ * underlying communicators are cached until a binding changes.
+ *
+ * \code{.c}
+ * // Two-level allreduce over sockets.
+ * MPI_Comm socket_comm, leader_comm;
+ * QUO_get_mpi_comm_by_type(q, QUO_OBJ_SOCKET, &socket_comm);
+ * QUO_get_mpi_leader_comm_by_type(q, QUO_OBJ_SOCKET, QUO_LEADER_LOWEST_QID,
+ *                                 &leader_comm);
+ * MPI_Reduce(&in, &part, 1, MPI_DOUBLE, MPI_SUM, 0, socket_comm);
+ * if (MPI_COMM_NULL != leader_comm) {
+ *     MPI_Allreduce(&part, &out, 1, MPI_DOUBLE, MPI_SUM, leader_comm);
+ * }
+ * MPI_Bcast(&out, 1, MPI_DOUBLE, 0, socket_comm);
+ * \endcode
+ *
+ * With QUO_LEADER_LOWEST_QID, leaders are rank 0 in their target_type
+ * communicator, as above. With QUO_LEADER_NIC_CLOSEST, they are whichever
+ * rank was bound closest to the network interface, so look it up (e.g., with
+ * an MPI_Allreduce of MPI_MAXLOC over the target_type communicator).
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] target_type Target hardware object type.
+ *
+ * @param[in] policy How leaders are picked. If no network interface is known,
+ *                   QUO_LEADER_NIC_CLOSEST behaves like QUO_LEADER_LOWEST_QID.
+ *
+ * @param[out] out_comm MPI_Comm_dup'd communicator containing the leaders,
+ *                      ordered by their rank in the initializing communicator.
+ *                      MPI_COMM_NULL if the caller is not a leader. Returned
+ *                      resources must be freed with a call to MPI_Comm_free.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_NOT_SUPPORTED if target_type is not a known type.
+ */
+int
+QUO_get_mpi_leader_comm_by_type(QUO_context q,
+                                QUO_obj_type_t target_type,
+                                QUO_leader_policy_t policy,
+                                MPI_Comm *out_comm);
+
+/**
+ * Like QUO_get_mpi_comm_by_type, but lends out the context's cached
+ * communicator instead of a dup, so repeated calls don't create communicators.
+ * Collective over the node.
+ *
+ * Borrowed communicators belong to the context: don't free them. Give them
+ * back with QUO_return_mpi_comm once done. A borrowed communicator stays
+ * usable after a binding change, even though later calls will return a new
+ * one, until it is given back.
+ *
+ * \code{.c}
+ * MPI_Comm numa_comm;
+ * for (int phase = 0; phase < nphases; ++phase) {
+ *     QUO_borrow_mpi_comm_by_type(q, QUO_OBJ_NUMANODE, &numa_comm);
+ *     if (MPI_COMM_NULL != numa_comm) {
+ *         // NUMA-local work
+ *     }
+ *     QUO_return_mpi_comm(q, &numa_comm);
+ * }
+ * \endcode
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] target_type Target hardware object type.
+ *
+ * @param[out] out_comm Borrowed communicator containing processes that match
+ *                      the target request. MPI_COMM_NULL if the caller's
+ *                      binding does not fit in a single target_type object.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_NOT_SUPPORTED if target_type is not a known type.
+ */
+int
+QUO_borrow_mpi_comm_by_type(QUO_context q,
+                            QUO_obj_type_t target_type,
+                            MPI_Comm *out_comm);
+
+/**
+ * Like QUO_get_mpi_leader_comm_by_type, but lends out the context's cached
+ * communicator instead of a dup (see QUO_borrow_mpi_comm_by_type). Collective
+ * over the initializing communicator.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] target_type Target hardware object type.
+ *
+ * @param[in] policy How leaders are picked.
+ *
+ * @param[out] out_comm Borrowed communicator containing the leaders.
+ *                      MPI_COMM_NULL if the caller is not a leader.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_NOT_SUPPORTED if target_type is not a known type.
+ */
+int
+QUO_borrow_mpi_leader_comm_by_type(QUO_context q,
+                                   QUO_obj_type_t target_type,
+                                   QUO_leader_policy_t policy,
+                                   MPI_Comm *out_comm);
+
+/**
+ * Gives back a communicator borrowed with QUO_borrow_mpi_comm_by_type or
+ * QUO_borrow_mpi_leader_comm_by_type. Not collective.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in,out] comm Borrowed communicator. Set to MPI_COMM_NULL on return.
+ *                     Giving back MPI_COMM_NULL does nothing.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_NOT_FOUND if comm was not borrowed from q.
+ */
+int
+QUO_return_mpi_comm(QUO_context q,
+                    MPI_Comm *comm);
+
+/**
+ * Returns a copy of the initializing communicator whose ranks are reordered so
+ * that neighbors that talk a lot share a socket (and then an L3 cache), with
+ * the communication graph attached (see MPI_Dist_graph_create_adjacent).
+ * Collective over the initializing communicator.
+ *
+ * Every process describes the subdomain that its rank in the initializing
+ * communicator stands for. In the returned communicator, a process' rank is
+ * the subdomain that it should work on, and its graph neighbors are that
+ * subdomain's. Ranks are only reordered among the processes of a node, so
+ * traffic between nodes is unchanged. Processes keep their bindings.
+ *
+ * \code{.c}
+ * MPI_Comm comm;
+ * QUO_reorder_info_t info;
+ * if (QUO_SUCCESS != QUO_reorder_comm_graph(q, degree, neighbors, weights,
+ *                                           &comm, &info)) {
+ *     // error handling
+ * }
+ * printf("cross-socket traffic: %lld -> %lld\n",
+ *        (long long)info.cross_socket_before,
+ *        (long long)info.cross_socket_after);
+ * \endcode
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] degree Number of neighbors of the caller's subdomain.
+ *
+ * @param[in] neighbors Ranks (in the initializing communicator) of the
+ *                      neighbors of the caller's subdomain. They are both
+ *                      sources and destinations in the attached graph.
+ *
+ * @param[in] weights Traffic to every neighbor, or NULL for 1 each. Either
+ *                    every process passes weights, or none does.
+ *
+ * @param[out] out_comm Reordered communicator. Returned resources must be
+ *                      freed with a call to MPI_Comm_free.
+ *
+ * @param[out] out_info Estimated traffic between sockets before and after
+ *                      reordering. May be NULL.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ *
+ * @retval QUO_ERR_INVLD_ARG if any process passed an invalid neighbor list.
+ *                           Errors on one process are returned everywhere, so
+ *                           nobody is left waiting.
+ */
+int
+QUO_reorder_comm_graph(QUO_context q,
+                       int degree,
+                       const int *neighbors,
+                       const int *weights,
+                       MPI_Comm *out_comm,
+                       QUO_reorder_info_t *out_info);
+
+/**
+ * Like QUO_reorder_comm_graph, for Cartesian grids. Every process' subdomain
+ * talks to its neighbors in every dimension with weight 1. Ranks are laid out
+ * in row-major order, like MPI_Cart_create, so a process' coordinates follow
+ * from its rank in the returned communicator. Collective over the initializing
+ * communicator.
+ *
+ * @param[in] q Constructed and initialized QUO_context.
+ *
+ * @param[in] ndims Number of dimensions.
+ *
+ * @param[in] dims Number of subdomains in every dimension. Their product must
+ *                 be the size of the initializing communicator.
+ *
+ * @param[in] periods Whether or not every dimension is periodic. NULL if none
+ *                    is.
+ *
+ * @param[out] out_comm Reordered communicator. Returned resources must be
+ *                      freed with a call to MPI_Comm_free.
+ *
+ * @param[out] out_info Estimated traffic between sockets before and after
+ *                      reordering. May be NULL.
+ *
+ * @retval QUO_SUCCESS if the operation completed successfully.
+ */
+int
+QUO_reorder_comm_cart(QUO_context q,
+                      int ndims,
+                      const int *dims,
+                      const int *periods,
+                      MPI_Comm *out_comm,
+                      QUO_reorder_info_t *out_info);
 
 #ifdef __cplusplus
 }
@@ -55,6 +55,72 @@ QUO_get_mpi_comm_by_type_f2c(QUO_t *q,
     return rc;
 }
 
+/**
+ * Simply a wrapper for our Fortran interface to C interface. No need to expose
+ * in quo.h header at this point, since it is only used by our Fortran module.
+ */
+int
+QUO_get_mpi_leader_comm_by_type_f2c(QUO_t *q,
+                                    QUO_obj_type_t target_type,
+                                    QUO_leader_policy_t policy,
+                                    MPI_Fint *out_comm)
+{
+    MPI_Comm c_comm;
+    int rc = QUO_get_mpi_leader_comm_by_type(q, target_type, policy, &c_comm);
+    *out_comm = MPI_Comm_c2f(c_comm);
+
+    return rc;
+}
+
+/**
+ * Simply a wrapper for our Fortran interface to C interface. No need to expose
+ * in quo.h header at this point, since it is only used by our Fortran module.
+ */
+int
+QUO_borrow_mpi_comm_by_type_f2c(QUO_t *q,
+                                QUO_obj_type_t target_type,
+                                MPI_Fint *out_comm)
+{
+    MPI_Comm c_comm;
+    int rc = QUO_borrow_mpi_comm_by_type(q, target_type, &c_comm);
+    *out_comm = MPI_Comm_c2f(c_comm);
+
+    return rc;
+}
+
+/**
+ * Simply a wrapper for our Fortran interface to C interface. No need to expose
+ * in quo.h header at this point, since it is only used by our Fortran module.
+ */
+int
+QUO_borrow_mpi_leader_comm_by_type_f2c(QUO_t *q,
+                                       QUO_obj_type_t target_type,
+                                       QUO_leader_policy_t policy,
+                                       MPI_Fint *out_comm)
+{
+    MPI_Comm c_comm;
+    int rc = QUO_borrow_mpi_leader_comm_by_type(q, target_type, policy,
+                                                &c_comm);
+    *out_comm = MPI_Comm_c2f(c_comm);
+
+    return rc;
+}
+
+/**
+ * Simply a wrapper for our Fortran interface to C interface. No need to expose
+ * in quo.h header at this point, since it is only used by our Fortran module.
+ */
+int
+QUO_return_mpi_comm_f2c(QUO_t *q,
+                        MPI_Fint *comm)
+{
+    MPI_Comm c_comm = MPI_Comm_f2c(*comm);
+    int rc = QUO_return_mpi_comm(q, &c_comm);
+    *comm = MPI_Comm_c2f(c_comm);
+
+    return rc;
+}
+
 /**
  * Used to free up allocated memory on the Fortran side - don't include in
  * quo.h.
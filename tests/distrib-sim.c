@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+#include "quo.h"
+#include "quo-set.h"
+#include "quo-distrib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * In-process simulator for the work distribution heuristics. Synthetic node
+ * tables (which node processes cover which resources) are fed to
+ * quo_distrib_assign and quo_distrib_assign_weighted, and the results are
+ * checked against the original QUO_auto_distrib selection code and against the
+ * max-per-resource invariant. Load balance is reported for weighted runs.
+ */
+
+/** A synthetic node: nres resources and nqid node processes. */
+typedef struct table_t {
+    int nres;
+    int nqid;
+    int *nranks_in_res;
+    int **rank_ids_in_res;
+} table_t;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static table_t *
+table_new(int nres,
+          int nqid)
+{
+    table_t *t = calloc(1, sizeof(*t));
+    t->nres = nres;
+    t->nqid = nqid;
+    t->nranks_in_res = calloc(nres, sizeof(int));
+    t->rank_ids_in_res = calloc(nres, sizeof(int *));
+    for (int r = 0; r < nres; ++r) {
+        t->rank_ids_in_res[r] = calloc(nqid, sizeof(int));
+    }
+    return t;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+table_free(table_t *t)
+{
+    for (int r = 0; r < t->nres; ++r) free(t->rank_ids_in_res[r]);
+    free(t->rank_ids_in_res);
+    free(t->nranks_in_res);
+    free(t);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Binds every node process to bind_width consecutive resources, starting at a
+ * block (packed) position. With probability pwide, a process is bound to
+ * everything instead (think: an unbound process).
+ */
+static table_t *
+table_build(int nres,
+            int nqid,
+            int bind_width,
+            double pwide)
+{
+    table_t *t = table_new(nres, nqid);
+    bool *covers = calloc((size_t)nres * nqid, sizeof(bool));
+    for (int qid = 0; qid < nqid; ++qid) {
+        if ((double)rand() / RAND_MAX < pwide) {
+            for (int r = 0; r < nres; ++r) covers[(size_t)r * nqid + qid] = true;
+            continue;
+        }
+        const int first = (int)(((long)qid * nres) / nqid);
+        for (int w = 0; w < bind_width; ++w) {
+            covers[(size_t)((first + w) % nres) * nqid + qid] = true;
+        }
+    }
+    for (int r = 0; r < nres; ++r) {
+        for (int qid = 0; qid < nqid; ++qid) {
+            if (covers[(size_t)r * nqid + qid]) {
+                t->rank_ids_in_res[r][t->nranks_in_res[r]++] = qid;
+            }
+        }
+    }
+    free(covers);
+    return t;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/** The original QUO_auto_distrib selection code, as seen by one process. */
+static int
+orig_selected(const table_t *t,
+              int my_smp_rank,
+              int max_qids_per_res_type)
+{
+    int selected = 0;
+    int *k_set_intersection = NULL, k_set_intersection_len = 0;
+
+    if (QUO_SUCCESS != quo_set_get_k_set_intersection(t->nres,
+                                                      t->nranks_in_res,
+                                                      t->rank_ids_in_res,
+                                                      &k_set_intersection,
+                                                      &k_set_intersection_len)) {
+        return -1;
+    }
+    if (0 == k_set_intersection_len) {
+        for (int rid = 0; rid < t->nres; ++rid) {
+            if (1 == selected) break;
+            for (int rank = 0; rank < t->nranks_in_res[rid]; ++rank) {
+                if (my_smp_rank == t->rank_ids_in_res[rid][rank] &&
+                    rank < max_qids_per_res_type) {
+                    selected = 1;
+                }
+            }
+        }
+    }
+    else if (t->nqid == k_set_intersection_len) {
+        if (my_smp_rank < max_qids_per_res_type * t->nres) selected = 1;
+    }
+    else {
+        int *big_htab = malloc(t->nqid * sizeof(int)), rmapped = 0;
+        (void)memset(big_htab, -1, t->nqid * sizeof(int));
+        for (int i = 0; i < k_set_intersection_len; ++i) {
+            big_htab[k_set_intersection[i]] = k_set_intersection[i];
+        }
+        for (int rid = 0; rid < t->nres; ++rid) {
+            if (1 == selected) break;
+            rmapped = 0;
+            for (int rank = 0; rank < t->nranks_in_res[rid]; ++rank) {
+                if (-1 != big_htab[t->rank_ids_in_res[rid][rank]]) continue;
+                if (my_smp_rank == t->rank_ids_in_res[rid][rank] &&
+                    rmapped < max_qids_per_res_type) {
+                        selected = 1;
+                        break;
+                }
+                ++rmapped;
+            }
+        }
+        free(big_htab);
+    }
+    free(k_set_intersection);
+    return selected;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Checks that no resource has more than max QIDs and, if need_cover, that
+ * every assigned QID covers its resource.
+ */
+static int
+check_invariants(const char *name,
+                 const table_t *t,
+                 int max,
+                 bool need_cover,
+                 const int *assign)
+{
+    int *count = calloc(t->nres, sizeof(int));
+    int rc = 0;
+
+    for (int qid = 0; qid < t->nqid; ++qid) {
+        const int r = assign[qid];
+        if (-1 == r) continue;
+        bool covered = false;
+        if (r < 0 || r >= t->nres) {
+            fprintf(stderr, "%s: qid %d has bogus resource %d\n", name, qid, r);
+            rc = 1;
+            break;
+        }
+        for (int i = 0; i < t->nranks_in_res[r]; ++i) {
+            if (qid == t->rank_ids_in_res[r][i]) covered = true;
+        }
+        if (need_cover && !covered) {
+            fprintf(stderr, "%s: qid %d doesn't cover resource %d\n",
+                    name, qid, r);
+            rc = 1;
+        }
+        if (++count[r] > max) {
+            fprintf(stderr, "%s: resource %d has more than %d qids\n",
+                    name, r, max);
+            rc = 1;
+        }
+    }
+    free(count);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static double
+max_load(const table_t *t,
+         const int *assign,
+         const double *weights)
+{
+    double *load = calloc(t->nres, sizeof(double)), res = 0.0;
+    for (int qid = 0; qid < t->nqid; ++qid) {
+        if (-1 != assign[qid]) load[assign[qid]] += weights[qid];
+    }
+    for (int r = 0; r < t->nres; ++r) {
+        if (load[r] > res) res = load[r];
+    }
+    free(load);
+    return res;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/** The classic heuristic must select exactly who the original code did. */
+static int
+run_classic(const char *name,
+            int nres,
+            int nqid,
+            int bind_width,
+            double pwide,
+            int max)
+{
+    int rc = 0;
+    table_t *t = table_build(nres, nqid, bind_width, pwide);
+    int *assign = calloc(nqid, sizeof(int));
+
+    if (QUO_SUCCESS != quo_distrib_assign(nres, nqid, t->nranks_in_res,
+                                          t->rank_ids_in_res, max, assign)) {
+        fprintf(stderr, "%s: quo_distrib_assign failed\n", name);
+        rc = 1;
+        goto out;
+    }
+    rc = check_invariants(name, t, max, false, assign);
+    int nselected = 0;
+    for (int qid = 0; qid < nqid; ++qid) {
+        if (orig_selected(t, qid, max) != (-1 != assign[qid])) {
+            fprintf(stderr, "%s: qid %d selection differs\n", name, qid);
+            rc = 1;
+        }
+        if (-1 != assign[qid]) ++nselected;
+    }
+    printf("%-32s nres=%4d nqid=%4d max=%d selected=%4d\n",
+           name, nres, nqid, max, nselected);
+out:
+    free(assign);
+    table_free(t);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Weighted distribution on skewed weights. Reports the heaviest resource load
+ * relative to the ideal (total weight / nres) for both heuristics.
+ */
+static int
+run_weighted(const char *name,
+             int nres,
+             int nqid,
+             int bind_width,
+             double pwide,
+             int max)
+{
+    int rc = 0;
+    table_t *t = table_build(nres, nqid, bind_width, pwide);
+    int *assign = calloc(nqid, sizeof(int));
+    int *classic = calloc(nqid, sizeof(int));
+    double *weights = calloc(nqid, sizeof(double));
+    double total = 0.0, wmax = 0.0;
+
+    for (int qid = 0; qid < nqid; ++qid) {
+        /* heavy tailed: most processes are light, a few are very heavy */
+        weights[qid] = 1.0 / (0.05 + (double)rand() / RAND_MAX);
+        total += weights[qid];
+        if (weights[qid] > wmax) wmax = weights[qid];
+    }
+    if (QUO_SUCCESS != quo_distrib_assign_weighted(nres, nqid,
+                                                   t->nranks_in_res,
+                                                   t->rank_ids_in_res, max,
+                                                   weights, assign) ||
+        QUO_SUCCESS != quo_distrib_assign(nres, nqid, t->nranks_in_res,
+                                          t->rank_ids_in_res, max, classic)) {
+        fprintf(stderr, "%s: distribution failed\n", name);
+        rc = 1;
+        goto out;
+    }
+    rc = check_invariants(name, t, max, true, assign);
+    /* with room for everyone and nobody pinned, greedy list scheduling is
+     * guaranteed to be within one (heaviest) weight of the ideal. */
+    const double ideal = total / nres;
+    const double wload = max_load(t, assign, weights);
+    if (1.0 == pwide && max >= nqid && wload > ideal + wmax) {
+        fprintf(stderr, "%s: weighted load %lf exceeds bound %lf\n",
+                name, wload, ideal + wmax);
+        rc = 1;
+    }
+    printf("%-32s nres=%4d nqid=%4d max=%d "
+           "max load/ideal: classic=%6.3lf weighted=%6.3lf\n",
+           name, nres, nqid, max,
+           max_load(t, classic, weights) / ideal, wload / ideal);
+out:
+    free(weights);
+    free(classic);
+    free(assign);
+    table_free(t);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check_errors(void)
+{
+    int nranks[1] = {2}, bad[2] = {0, 7}, good[2] = {0, 1}, assign[2];
+    int *ids[1] = {bad};
+    double weights[2] = {1.0, -1.0};
+
+    if (QUO_ERR_INVLD_ARG != quo_distrib_assign(1, 2, nranks, ids, 1, assign)) {
+        return 1;
+    }
+    ids[0] = good;
+    if (QUO_ERR_INVLD_ARG != quo_distrib_assign(1, 2, nranks, ids, 0, assign)) {
+        return 1;
+    }
+    if (QUO_ERR_INVLD_ARG != quo_distrib_assign_weighted(1, 2, nranks, ids, 1,
+                                                         weights, assign)) {
+        return 1;
+    }
+    weights[1] = NAN;
+    if (QUO_ERR_INVLD_ARG != quo_distrib_assign_weighted(1, 2, nranks, ids, 1,
+                                                         weights, assign)) {
+        return 1;
+    }
+    /* ties go to the lower QID */
+    weights[1] = 1.0;
+    if (QUO_SUCCESS != quo_distrib_assign_weighted(1, 2, nranks, ids, 1,
+                                                   weights, assign)) {
+        return 1;
+    }
+    if (0 != assign[0] || -1 != assign[1]) return 1;
+    return 0;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Work queue homes: processes bound within a NUMA node stay home, and unbound
+ * ones (no single NUMA node, so -1) are spread evenly over all of them.
+ */
+static int
+check_homes(void)
+{
+    enum { NRES = 4, NQID = 16 };
+    int nhomed[NRES] = {0};
+
+    for (int qid = 0; qid < NQID; ++qid) {
+        const int home = quo_distrib_home(NRES, qid, -1);
+        if (home < 0 || home >= NRES) return 1;
+        nhomed[home]++;
+    }
+    for (int i = 0; i < NRES; ++i) {
+        if (NQID / NRES != nhomed[i]) {
+            fprintf(stderr, "homes: %d unbound workers on queue %d\n",
+                    nhomed[i], i);
+            return 1;
+        }
+    }
+    if (2 != quo_distrib_home(NRES, 5, 2)) return 1;
+    /* out of range is as good as unbound */
+    if (1 != quo_distrib_home(NRES, 5, NRES)) return 1;
+    return 0;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(void)
+{
+    int nerrs = 0;
+
+    srand(42);
+    printf("### Starting work distribution simulations...\n");
+    nerrs += check_errors();
+    nerrs += check_homes();
+    /* classic: every selection case */
+    nerrs += run_classic("disjoint (1 per res)", 16, 16, 1, 0.0, 1);
+    nerrs += run_classic("disjoint (4 per res)", 16, 64, 1, 0.0, 2);
+    nerrs += run_classic("all overlap (unbound)", 8, 32, 1, 1.0, 3);
+    nerrs += run_classic("few overlap", 32, 64, 1, 0.1, 1);
+    nerrs += run_classic("wide bindings", 64, 64, 3, 0.0, 2);
+    nerrs += run_classic("wide bindings + unbound", 64, 256, 2, 0.05, 4);
+    /* weighted */
+    nerrs += run_weighted("unbound", 4, 64, 1, 1.0, 64);
+    nerrs += run_weighted("unbound (capped)", 4, 64, 1, 1.0, 8);
+    nerrs += run_weighted("packed, 4 per res", 16, 64, 1, 0.0, 4);
+    nerrs += run_weighted("packed, 2 wide", 16, 64, 2, 0.0, 4);
+    nerrs += run_weighted("sockets + unbound", 2, 32, 1, 0.25, 16);
+
+    if (nerrs) {
+        fprintf(stderr, "### work distribution simulations FAILED\n");
+        return EXIT_FAILURE;
+    }
+    printf("### work distribution simulations PASSED\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+#include "quo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "mpi.h"
+
+/**
+ * Checks node collectives and compares their latency against MPI collectives
+ * over the node communicator.
+ */
+
+#define N_TRIALS 1000
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check(QUO_context q,
+      int qid,
+      int nqids,
+      int count)
+{
+    int nerrs = 0;
+    double *dsend = calloc(count, sizeof(double));
+    double *drecv = calloc(count, sizeof(double));
+    int64_t *isend = calloc(count, sizeof(int64_t));
+    int64_t *irecv = calloc(count, sizeof(int64_t));
+    if (!dsend || !drecv || !isend || !irecv) return 1;
+
+    for (int i = 0; i < count; ++i) {
+        dsend[i] = (double)(qid + i);
+        isend[i] = (int64_t)qid * 1000 + i;
+    }
+    /* sum: n * i + sum(qid) */
+    if (QUO_SUCCESS != QUO_node_allreduce(q, dsend, drecv, count, QUO_DOUBLE,
+                                          QUO_SUM)) return 1;
+    for (int i = 0; i < count; ++i) {
+        const double expect = (double)nqids * i + nqids * (nqids - 1) / 2.0;
+        if (drecv[i] != expect) nerrs++;
+    }
+    /* max to the last process */
+    const int root = nqids - 1;
+    if (QUO_SUCCESS != QUO_node_reduce(q, isend, irecv, count, QUO_INT64,
+                                       QUO_MAX, root)) return 1;
+    if (qid == root) {
+        for (int i = 0; i < count; ++i) {
+            if (irecv[i] != (int64_t)root * 1000 + i) nerrs++;
+        }
+    }
+    /* broadcast the root's input */
+    if (QUO_SUCCESS != QUO_node_bcast(q, isend, count, QUO_INT64, root)) {
+        return 1;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (isend[i] != (int64_t)root * 1000 + i) nerrs++;
+    }
+    if (nerrs) fprintf(stderr, "qid %d: %d bad elements (count %d)\n",
+                       qid, nerrs, count);
+    free(dsend); free(drecv); free(isend); free(irecv);
+    return nerrs;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+bench(QUO_context q,
+      MPI_Comm node_comm,
+      int qid,
+      int count)
+{
+    double *send = calloc(count, sizeof(double));
+    double *recv = calloc(count, sizeof(double));
+    if (!send || !recv) return 1;
+
+    double qt = 0.0, mt = 0.0;
+    for (int i = 0; i < N_TRIALS; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_node_allreduce(q, send, recv, count, QUO_DOUBLE,
+                                              QUO_SUM)) return 1;
+        qt += MPI_Wtime() - start;
+    }
+    for (int i = 0; i < N_TRIALS; ++i) {
+        double start = MPI_Wtime();
+        if (MPI_SUCCESS != MPI_Allreduce(send, recv, count, MPI_DOUBLE,
+                                         MPI_SUM, node_comm)) return 1;
+        mt += MPI_Wtime() - start;
+    }
+    if (0 == qid) {
+        printf("allreduce %6d doubles: QUO_node_allreduce %8.3f us, "
+               "MPI_Allreduce %8.3f us\n", count,
+               qt / N_TRIALS * 1e6, mt / N_TRIALS * 1e6);
+    }
+    free(send); free(recv);
+    return 0;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(void)
+{
+    int nerrs = 0, qid = 0, nqids = 0;
+    QUO_context q = NULL;
+    MPI_Comm node_comm = MPI_COMM_NULL;
+    const int counts[] = {1, 8, 1024, 5000};
+    const int ncounts = sizeof(counts) / sizeof(counts[0]);
+
+    if (MPI_SUCCESS != MPI_Init(NULL, NULL)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_create(&q, MPI_COMM_WORLD)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_id(q, &qid)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_nqids(q, &nqids)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_get_mpi_comm_by_type(q, QUO_OBJ_MACHINE,
+                                                &node_comm)) {
+        return EXIT_FAILURE;
+    }
+    if (0 == qid) printf("### Starting node collective tests...\n");
+    for (int i = 0; i < ncounts; ++i) {
+        nerrs += check(q, qid, nqids, counts[i]);
+    }
+    for (int i = 0; i < ncounts; ++i) {
+        nerrs += bench(q, node_comm, qid, counts[i]);
+    }
+    int tot = 0;
+    MPI_Allreduce(&nerrs, &tot, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Comm_free(&node_comm);
+    QUO_free(q);
+    MPI_Finalize();
+    if (tot) {
+        if (0 == qid) fprintf(stderr, "### node collective tests FAILED\n");
+        return EXIT_FAILURE;
+    }
+    if (0 == qid) printf("### node collective tests PASSED\n");
+    return EXIT_SUCCESS;
+}
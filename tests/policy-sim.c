@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+#include "quo.h"
+#include "quo-policy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Evaluates hierarchical distribution policies against synthetic topologies
+ * and checks the resulting bindings.
+ */
+
+/* 2 packages x 2 NUMA nodes x 8 cores x 2 PUs: a package has 32 PUs, a NUMA
+ * node 16, and core c has PUs 2c and 2c + 1. */
+static const char *topo = "pack:2 numa:2 core:8 pu:2";
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+free_slots(int nslots,
+           char **slots)
+{
+    for (int i = 0; i < nslots; ++i) free(slots[i]);
+    free(slots);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check_slots(const char *name,
+            const QUO_policy_t *policy,
+            int nexpected,
+            const char *const *expected)
+{
+    int rc = 0, nslots = 0;
+    char **slots = NULL;
+
+    if (QUO_SUCCESS != quo_policy_eval_synthetic(topo, policy, 0, NULL,
+                                                 &nslots, &slots, NULL)) {
+        fprintf(stderr, "%s: evaluation failed\n", name);
+        return 1;
+    }
+    printf("%-28s", name);
+    for (int i = 0; i < nslots; ++i) printf(" [%s]", slots[i]);
+    printf("\n");
+    if (nslots != nexpected) {
+        fprintf(stderr, "%s: expected %d slots, got %d\n",
+                name, nexpected, nslots);
+        rc = 1;
+    }
+    for (int i = 0; i < nslots && i < nexpected; ++i) {
+        if (0 != strcmp(slots[i], expected[i])) {
+            fprintf(stderr, "%s: slot %d is %s, expected %s\n",
+                    name, i, slots[i], expected[i]);
+            rc = 1;
+        }
+    }
+    free_slots(nslots, slots);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check_policies(void)
+{
+    int nerrs = 0;
+    {
+        /* ppr:2:socket, spread over NUMA, packed onto 4 cores each */
+        const QUO_policy_level_t levels[] = {
+            {QUO_OBJ_NUMANODE, QUO_POLICY_SPREAD},
+            {QUO_OBJ_CORE, QUO_POLICY_PACK}
+        };
+        const QUO_policy_t p = {QUO_OBJ_SOCKET, 2, 2, levels, QUO_OBJ_CORE, 4};
+        const char *const expected[] = {"0-7", "16-23", "32-39", "48-55"};
+        nerrs += check_slots("spread numa, pack cores", &p, 4, expected);
+    }
+    {
+        /* same, but packed over NUMA */
+        const QUO_policy_level_t levels[] = {
+            {QUO_OBJ_NUMANODE, QUO_POLICY_PACK}
+        };
+        const QUO_policy_t p = {QUO_OBJ_SOCKET, 2, 1, levels, QUO_OBJ_CORE, 4};
+        const char *const expected[] = {"0-7", "8-15", "32-39", "40-47"};
+        nerrs += check_slots("pack numa", &p, 4, expected);
+    }
+    {
+        /* 2 per NUMA node, 2 cores each, spread out inside the NUMA node */
+        const QUO_policy_level_t levels[] = {
+            {QUO_OBJ_CORE, QUO_POLICY_SPREAD}
+        };
+        const QUO_policy_t p = {QUO_OBJ_NUMANODE, 2, 1, levels,
+                                QUO_OBJ_CORE, 2};
+        const char *const expected[] = {
+            "0-3", "8-11", "16-19", "24-27",
+            "32-35", "40-43", "48-51", "56-59"
+        };
+        nerrs += check_slots("spread cores in numa", &p, 8, expected);
+    }
+    {
+        /* one PU per process, no levels */
+        const QUO_policy_t p = {QUO_OBJ_CORE, 1, 0, NULL, QUO_OBJ_PU, 1};
+        int nslots = 0;
+        char **slots = NULL;
+        if (QUO_SUCCESS != quo_policy_eval_synthetic(topo, &p, 0, NULL,
+                                                     &nslots, &slots, NULL) ||
+            32 != nslots || 0 != strcmp(slots[1], "2")) {
+            fprintf(stderr, "ppr:1:core failed\n");
+            nerrs++;
+        }
+        free_slots(nslots, slots);
+    }
+    {
+        /* doesn't fit: 5 x 4 cores in a 16 core package */
+        const QUO_policy_t p = {QUO_OBJ_SOCKET, 5, 0, NULL, QUO_OBJ_CORE, 4};
+        int nslots = 0;
+        char **slots = NULL;
+        if (QUO_ERR_INVLD_ARG != quo_policy_eval_synthetic(topo, &p, 0, NULL,
+                                                           &nslots, &slots,
+                                                           NULL)) {
+            fprintf(stderr, "oversubscribed policy accepted\n");
+            nerrs++;
+        }
+    }
+    return nerrs;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check_matching(void)
+{
+    const QUO_policy_t p = {QUO_OBJ_SOCKET, 2, 0, NULL, QUO_OBJ_CORE, 4};
+    /* qid 0 already lives on the second package, and qid 3 on the first */
+    const char *const binds[] = {"40", NULL, NULL, "0-31", NULL};
+    const int expected[] = {2, 1, 3, 0, -1};
+    int slot_of_qid[5], nslots = 0, rc = 0;
+    char **slots = NULL;
+
+    if (QUO_SUCCESS != quo_policy_eval_synthetic(topo, &p, 5, binds, &nslots,
+                                                 &slots, slot_of_qid)) {
+        fprintf(stderr, "matching: evaluation failed\n");
+        return 1;
+    }
+    for (int qid = 0; qid < 5; ++qid) {
+        if (slot_of_qid[qid] != expected[qid]) {
+            fprintf(stderr, "matching: qid %d got slot %d, expected %d\n",
+                    qid, slot_of_qid[qid], expected[qid]);
+            rc = 1;
+        }
+    }
+    free_slots(nslots, slots);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check_containing(void)
+{
+    static const struct {
+        QUO_obj_type_t type;
+        const char *bind;
+        int expected;
+    } cases[] = {
+        {QUO_OBJ_SOCKET, "40", 1},
+        {QUO_OBJ_SOCKET, "0-31", 0},
+        {QUO_OBJ_NUMANODE, "16-17", 1},
+        {QUO_OBJ_CORE, "5", 2},
+        /* unbound: in every object, so in no single one */
+        {QUO_OBJ_SOCKET, NULL, -1},
+        {QUO_OBJ_NUMANODE, NULL, -1},
+        /* spans two packages, two NUMA nodes, two cores */
+        {QUO_OBJ_SOCKET, "31-32", -1},
+        {QUO_OBJ_NUMANODE, "15-16", -1},
+        {QUO_OBJ_CORE, "1-2", -1},
+        /* but everything is on the machine */
+        {QUO_OBJ_MACHINE, NULL, 0}
+    };
+    int rc = 0;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        int index = -2;
+        if (QUO_SUCCESS != quo_policy_obj_index_synthetic(topo, cases[i].type,
+                                                          cases[i].bind,
+                                                          &index)) {
+            fprintf(stderr, "containing: evaluation failed\n");
+            return 1;
+        }
+        if (index != cases[i].expected) {
+            fprintf(stderr, "containing: case %zu got %d, expected %d\n",
+                    i, index, cases[i].expected);
+            rc = 1;
+        }
+    }
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(void)
+{
+    int nerrs = 0;
+
+    printf("### Starting distribution policy tests...\n");
+    nerrs += check_policies();
+    nerrs += check_matching();
+    nerrs += check_containing();
+
+    if (nerrs) {
+        fprintf(stderr, "### distribution policy tests FAILED\n");
+        return EXIT_FAILURE;
+    }
+    printf("### distribution policy tests PASSED\n");
+    return EXIT_SUCCESS;
+}
@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -223,6 +224,70 @@ qbind_pop(
     return 0;
 }
 
+static int
+qbind_push_stats(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    QUO_bind_stats_t stats;
+    if (QUO_SUCCESS != QUO_bind_stats_reset(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_bind_stats_enable(c->quo, 1)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_bind_push(c->quo, QUO_BIND_PUSH_OBJ,
+                                         QUO_OBJ_MACHINE, -1)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_bind_stats_enable(c->quo, 0)) return 1;
+    if (QUO_SUCCESS != QUO_bind_stats(c->quo, &stats)) return 1;
+    // Every push and pop should have been recorded.
+    if (stats.npushes != (unsigned long long)n_trials ||
+        stats.npops != (unsigned long long)n_trials) return 1;
+    return 0;
+}
+
+static int
+qbind_push_cpuset(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    char *cbind = NULL;
+    if (QUO_SUCCESS != QUO_stringify_cbind(c->quo, &cbind)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_bind_push_cpuset(c->quo, cbind)) goto err;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        if (QUO_SUCCESS != QUO_bind_pop(c->quo)) goto err;
+    }
+    free(cbind);
+    return 0;
+err:
+    free(cbind);
+    return 1;
+}
+
+static int
+qbind_push_split(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_bind_push_split(c->quo, 2, c->rank % 2,
+                                               QUO_OBJ_CORE)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    }
+    return 0;
+}
+
 static int
 qauto_distrib(
     context_t *c,
@@ -243,6 +308,263 @@ qauto_distrib(
     return 0;
 }
 
+static int
+qauto_distrib_weighted(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int sel = 0;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_auto_distrib_weighted(c->quo, QUO_OBJ_PU,
+                                                     c->nranks,
+                                                     (double)(c->rank + 1),
+                                                     &sel)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    // Don't want compiler to optimize this away. Will never print.
+    if (c->rank == (c->nranks + 1)) printf("### NPUS: %d\n", sel);
+    return 0;
+}
+
+static int
+qauto_distrib_assign(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int qid = 0, nqids = 0, sel = 0, my_res = -1;
+    if (QUO_SUCCESS != QUO_id(c->quo, &qid)) return 1;
+    if (QUO_SUCCESS != QUO_nqids(c->quo, &nqids)) return 1;
+    int *assign = calloc(nqids, sizeof(int));
+    if (!assign) return 1;
+    if (QUO_SUCCESS != QUO_auto_distrib(c->quo, QUO_OBJ_PU,
+                                        c->nranks, &sel)) goto err;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_auto_distrib_assign(c->quo, QUO_OBJ_PU,
+                                                   c->nranks,
+                                                   QUO_AUTO_DISTRIB_BIND_PUSH,
+                                                   &my_res, assign)) goto err;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        // Must agree with QUO_auto_distrib and with the table.
+        if (sel != (-1 != my_res) || assign[qid] != my_res) goto err;
+        if (-1 != my_res) {
+            if (QUO_SUCCESS != QUO_bind_pop(c->quo)) goto err;
+        }
+    }
+    free(assign);
+    return 0;
+err:
+    free(assign);
+    return 1;
+}
+
+static int
+qglobal_place(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    // Everyone can be placed on the machine, so ask for all but one.
+    const int nworkers = (c->nranks > 1) ? c->nranks - 1 : 1;
+    int my_res = -1, wid = -1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_global_place(c->quo, QUO_OBJ_MACHINE,
+                                            c->nranks, nworkers,
+                                            QUO_AUTO_DISTRIB_NO_FLAGS,
+                                            &my_res, &wid)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    // Worker IDs must be exactly 0, 1, ..., nworkers - 1.
+    int *wids = calloc(c->nranks, sizeof(int));
+    if (!wids) return 1;
+    if (MPI_SUCCESS != MPI_Allgather(&wid, 1, MPI_INT, wids, 1, MPI_INT,
+                                     MPI_COMM_WORLD)) {
+        free(wids);
+        return 1;
+    }
+    int nseen = 0, sum = 0;
+    for (int r = 0; r < c->nranks; ++r) {
+        if (-1 != wids[r]) { ++nseen; sum += wids[r]; }
+    }
+    free(wids);
+    if (nseen != nworkers || sum != nworkers * (nworkers - 1) / 2) return 1;
+    return 0;
+}
+
+static int
+qpolicy_distrib(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    // One PU per process on the machine.
+    const QUO_policy_t policy = {QUO_OBJ_MACHINE, 1, 0, NULL, QUO_OBJ_PU, 1};
+    int sel = 0;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_policy_distrib(c->quo, &policy,
+                                              QUO_AUTO_DISTRIB_BIND_PUSH,
+                                              &sel, NULL)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        if (sel && QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    }
+    return 0;
+}
+
+static int
+qauto_distrib_rebound(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int sel = 0, sel0 = 0;
+    if (QUO_SUCCESS != QUO_auto_distrib(c->quo, QUO_OBJ_PU,
+                                        c->nranks, &sel0)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        // Change binding so that the cached result cannot be used.
+        if (QUO_SUCCESS != QUO_bind_push(c->quo, QUO_BIND_PUSH_OBJ,
+                                         QUO_OBJ_MACHINE, -1)) return 1;
+        if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_auto_distrib(c->quo, QUO_OBJ_PU,
+                                            c->nranks, &sel)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        // Same bindings, so we better get the same answer.
+        if (sel != sel0) return 1;
+    }
+    return 0;
+}
+
+// Number of objects of the given type that our binding touches.
+static int
+nobjs_touched(
+    context_t *c,
+    QUO_obj_type_t type,
+    int *n
+) {
+    int nobjs = 0;
+    *n = 0;
+    if (QUO_SUCCESS != QUO_nobjs_by_type(c->quo, type, &nobjs)) return 1;
+    for (int i = 0; i < nobjs; ++i) {
+        int in = 0;
+        if (QUO_SUCCESS != QUO_cpuset_in_type(c->quo, type, i, &in)) return 1;
+        *n += in;
+    }
+    return 0;
+}
+
+static int
+qplan_enter(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    QUO_plan plan = NULL;
+    int assigned = -1;
+    if (QUO_SUCCESS != QUO_plan_create(c->quo, 1, &plan)) return 1;
+    if (QUO_SUCCESS != QUO_plan_set_phase(plan, 0, QUO_OBJ_PU,
+                                          c->nranks)) return 1;
+    // Same arguments, so same assignment as the phase.
+    if (QUO_SUCCESS != QUO_auto_distrib_assign(c->quo, QUO_OBJ_PU, c->nranks,
+                                               QUO_AUTO_DISTRIB_NO_FLAGS,
+                                               &assigned, NULL)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_plan_enter(plan, 0, 0, NULL)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        // Members run on exactly the PU they were assigned.
+        if (-1 != assigned) {
+            int in = 0, touched = 0;
+            if (QUO_SUCCESS != QUO_cpuset_in_type(c->quo, QUO_OBJ_PU, assigned,
+                                                  &in)) return 1;
+            if (nobjs_touched(c, QUO_OBJ_PU, &touched)) return 1;
+            if (!in || 1 != touched) return 1;
+        }
+        if (QUO_SUCCESS != QUO_plan_leave(plan, 0)) return 1;
+    }
+    // Leaving never pops somebody else's binding.
+    if (QUO_SUCCESS != QUO_plan_enter(plan, 0, 0, NULL)) return 1;
+    if (QUO_SUCCESS != QUO_bind_push(c->quo, QUO_BIND_PUSH_OBJ,
+                                     QUO_OBJ_MACHINE, -1)) return 1;
+    const int expected = (-1 != assigned) ? QUO_ERR_INVLD_ARG : QUO_SUCCESS;
+    if (expected != QUO_plan_leave(plan, 0)) return 1;
+    if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_plan_leave(plan, 0)) return 1;
+    if (QUO_SUCCESS != QUO_plan_free(plan)) return 1;
+    return 0;
+}
+
+static int
+qrebind_poll(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int qid = 0, nqids = 0, rebound = 0;
+    char *cbind = NULL;
+    const char **cbinds = NULL;
+    if (QUO_SUCCESS != QUO_id(c->quo, &qid)) return 1;
+    if (QUO_SUCCESS != QUO_nqids(c->quo, &nqids)) return 1;
+    if (QUO_SUCCESS != QUO_stringify_cbind(c->quo, &cbind)) return 1;
+    if (NULL == (cbinds = calloc(nqids, sizeof(*cbinds)))) return 1;
+    // QID 0 rebinds everyone to its own binding.
+    for (int i = 0; i < nqids; ++i) cbinds[i] = cbind;
+    // Remote rebinds replace the top of the stack, so give them their own.
+    if (QUO_SUCCESS != QUO_bind_push_cpuset(c->quo, cbind)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        if (0 == qid) {
+            if (QUO_SUCCESS != QUO_rebind_node(c->quo, cbinds)) return 1;
+        }
+        if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_rebind_poll(c->quo, &rebound)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+    }
+    // Pushes other than QUO_bind_push* adopt pending rebinds first, too, so
+    // popping what they pushed gets us back to the new binding.
+    for (int i = 0; i < nqids; ++i) cbinds[i] = "0";
+    if (0 == qid) {
+        if (QUO_SUCCESS != QUO_rebind_node(c->quo, cbinds)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+    int res_index = -1;
+    if (QUO_SUCCESS != QUO_auto_distrib_assign(c->quo, QUO_OBJ_PU, nqids,
+                                               QUO_AUTO_DISTRIB_BIND_PUSH,
+                                               &res_index, NULL)) return 1;
+    if (-1 != res_index && QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    char *adopted = NULL;
+    if (QUO_SUCCESS != QUO_stringify_cbind(c->quo, &adopted)) return 1;
+    const int zero = (0 == strcmp(adopted, "0"));
+    free(adopted);
+    if (!zero) return 1;
+    // Popping undoes the rebinding together with our push.
+    if (0 == qid) {
+        if (QUO_SUCCESS != QUO_rebind_node(c->quo, cbinds)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    char *popped = NULL;
+    if (QUO_SUCCESS != QUO_stringify_cbind(c->quo, &popped)) return 1;
+    const int same = (0 == strcmp(popped, cbind));
+    free(popped);
+    if (!same) return 1;
+    free(cbinds);
+    free(cbind);
+    return 0;
+}
+
 static int
 qbarrier(
     context_t *c,
@@ -258,6 +580,490 @@ qbarrier(
     return 0;
 }
 
+static int
+qbarrier_split(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    for (int i = 0; i < n_trials; ++i) {
+        int done = 0;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_barrier_arrive(c->quo)) return 1;
+        if (QUO_SUCCESS != QUO_barrier_test(c->quo, &done)) return 1;
+        if (!done && QUO_SUCCESS != QUO_barrier_wait(c->quo)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    // Arriving twice without completing the phase is an error.
+    if (QUO_SUCCESS != QUO_barrier_arrive(c->quo)) return 1;
+    if (QUO_ERR_INVLD_ARG != QUO_barrier_arrive(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_barrier_wait(c->quo)) return 1;
+    return 0;
+}
+
+// Creates and frees subsets over the same and overlapping member lists, out
+// of order, and runs the leader out of barriers once.
+static int
+subset_reuse(
+    context_t *c,
+    int nqids,
+    const int *qids
+) {
+    // More than a leader can have at once.
+    enum { nmany = 9 };
+    int qid = 0, rc = QUO_SUCCESS;
+    const int pair[2] = {0, 1};
+    QUO_subset a = NULL, b = NULL, d = NULL, many[nmany] = {NULL};
+    if (QUO_SUCCESS != QUO_id(c->quo, &qid)) return 1;
+    const bool in_pair = (nqids >= 2 && qid < 2);
+    if (QUO_SUCCESS != QUO_subset_create(c->quo, nqids, qids, &a)) return 1;
+    if (QUO_SUCCESS != QUO_subset_create(c->quo, nqids, qids, &b)) return 1;
+    if (in_pair) {
+        if (QUO_SUCCESS != QUO_subset_create(c->quo, 2, pair, &d)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_subset_free(a)) return 1;
+    // Takes a's place, but must not be mistaken for b.
+    if (QUO_SUCCESS != QUO_subset_create(c->quo, nqids, qids, &a)) return 1;
+    if (in_pair) {
+        if (QUO_SUCCESS != QUO_subset_free(d)) return 1;
+        if (QUO_SUCCESS != QUO_subset_create(c->quo, 2, pair, &d)) return 1;
+        if (QUO_SUCCESS != QUO_subset_barrier(d)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_subset_barrier(a)) return 1;
+    if (QUO_SUCCESS != QUO_subset_barrier(b)) return 1;
+    if (QUO_SUCCESS != QUO_subset_free(b)) return 1;
+    if (QUO_SUCCESS != QUO_subset_free(a)) return 1;
+    if (in_pair && QUO_SUCCESS != QUO_subset_free(d)) return 1;
+    // Everyone must agree on the failure, and on what comes after it.
+    for (int i = 0; i < nmany; ++i) {
+        rc = QUO_subset_create(c->quo, nqids, qids, &many[i]);
+        if ((nmany - 1 == i ? QUO_ERR_OOR : QUO_SUCCESS) != rc) return 1;
+    }
+    for (int i = 0; i < nmany - 1; ++i) {
+        if (QUO_SUCCESS != QUO_subset_free(many[i])) return 1;
+    }
+    if (QUO_SUCCESS != QUO_subset_create(c->quo, nqids, qids, &a)) return 1;
+    if (QUO_SUCCESS != QUO_subset_barrier(a)) return 1;
+    if (QUO_SUCCESS != QUO_subset_free(a)) return 1;
+    return 0;
+}
+
+static int
+qsubset_create(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int nqids = 0, *qids = NULL;
+    if (QUO_SUCCESS != QUO_nqids(c->quo, &nqids)) return 1;
+    if (NULL == (qids = calloc(nqids, sizeof(*qids)))) return 1;
+    for (int i = 0; i < nqids; ++i) qids[i] = nqids - 1 - i;
+    for (int i = 0; i < n_trials; ++i) {
+        QUO_subset s = NULL;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_subset_create(c->quo, nqids, qids, &s)) {
+            return 1;
+        }
+        if (QUO_SUCCESS != QUO_subset_free(s)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    if (subset_reuse(c, nqids, qids)) return 1;
+    free(qids);
+    return 0;
+}
+
+static int
+qsubset_barrier(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int qid = 0;
+    QUO_subset all = NULL, self = NULL;
+    if (QUO_SUCCESS != QUO_id(c->quo, &qid)) return 1;
+    if (QUO_SUCCESS != QUO_subset_create_in_type(c->quo, QUO_OBJ_MACHINE, 0,
+                                                 &all)) return 1;
+    // Everyone also leads a subset of its own.
+    if (QUO_SUCCESS != QUO_subset_create(c->quo, 1, &qid, &self)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_subset_barrier(all)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        if (QUO_SUCCESS != QUO_subset_barrier(self)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_subset_free(self)) return 1;
+    if (QUO_SUCCESS != QUO_subset_free(all)) return 1;
+    return 0;
+}
+
+static int
+qlock(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    QUO_lock lock = NULL;
+    if (QUO_SUCCESS != QUO_lock_create(c->quo, &lock)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_lock_acquire(lock)) return 1;
+        if (QUO_SUCCESS != QUO_lock_release(lock)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    if (QUO_SUCCESS != QUO_lock_free(lock)) return 1;
+    return 0;
+}
+
+static int
+qsem(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    QUO_sem sem = NULL;
+    if (QUO_SUCCESS != QUO_sem_create(c->quo, 1, &sem)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_sem_wait(sem)) return 1;
+        if (QUO_SUCCESS != QUO_sem_post(sem)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    if (QUO_SUCCESS != QUO_sem_free(sem)) return 1;
+    return 0;
+}
+
+static int
+qcounter(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int nqids = 0;
+    int64_t total = 0;
+    QUO_counter counter = NULL;
+    if (QUO_SUCCESS != QUO_nqids(c->quo, &nqids)) return 1;
+    if (QUO_SUCCESS != QUO_counter_create(c->quo, 0, &counter)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_counter_fetch_add(counter, 1, NULL)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_counter_load(counter, &total)) return 1;
+    // Nobody's increments went missing.
+    if (total != (int64_t)nqids * n_trials) return 1;
+    if (QUO_SUCCESS != QUO_counter_free(counter)) return 1;
+    return 0;
+}
+
+static int
+qworkq(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    const int64_t ntasks = 100000;
+    QUO_workq wq = NULL;
+    if (QUO_SUCCESS != QUO_workq_create(c->quo, ntasks, QUO_WORKQ_GUIDED, 1,
+                                        QUO_WORKQ_NUMA, &wq)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        int64_t begin = 0, end = 0, mine = 0, total = 0;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_workq_next(wq, &begin, &end)) return 1;
+        double stop = MPI_Wtime();
+        res[i] = stop - start;
+        // Drain the rest, and make sure that every task was handed out once.
+        for (; begin != end; QUO_workq_next(wq, &begin, &end)) {
+            mine += end - begin;
+        }
+        if (QUO_SUCCESS != QUO_node_allreduce(c->quo, &mine, &total, 1,
+                                              QUO_INT64, QUO_SUM)) return 1;
+        if (total != ntasks) return 1;
+        if (QUO_SUCCESS != QUO_workq_reset(wq, ntasks)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_workq_free(wq)) return 1;
+    return 0;
+}
+
+static int
+qborrow(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    int qid = 0, nqids = 0;
+    if (QUO_SUCCESS != QUO_id(c->quo, &qid)) return 1;
+    if (QUO_SUCCESS != QUO_nqids(c->quo, &nqids)) return 1;
+    // Even QIDs lend, odd QIDs borrow from one lender each.
+    const int lender = (0 == qid % 2);
+    for (int i = 0; i < n_trials; ++i) {
+        int nborrowed = 0, total = 0;
+        if (lender && QUO_SUCCESS != QUO_lend(c->quo)) return 1;
+        if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+        double start = MPI_Wtime();
+        if (!lender && QUO_SUCCESS != QUO_borrow(c->quo, QUO_OBJ_MACHINE, 1,
+                                                 &nborrowed, NULL)) return 1;
+        if (QUO_SUCCESS != QUO_borrow_return(c->quo)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        // Don't take the cores back before the borrowers had a chance.
+        if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+        if (lender && QUO_SUCCESS != QUO_lend_reclaim(c->quo)) return 1;
+        if (QUO_SUCCESS != QUO_node_allreduce(c->quo, &nborrowed, &total, 1,
+                                              QUO_INT, QUO_SUM)) return 1;
+        // Every borrower found a lender, as long as there were enough.
+        if (total != nqids / 2) return 1;
+    }
+    // Borrowing near the caller's NUMA node(s) works whether or not the
+    // caller is bound within one, and QUO_borrow_return won't pop somebody
+    // else's binding.
+    int nborrowed = 0, total = 0;
+    if (lender && QUO_SUCCESS != QUO_lend(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+    if (!lender && QUO_SUCCESS != QUO_borrow(c->quo, QUO_OBJ_NUMANODE, 1,
+                                             &nborrowed, NULL)) return 1;
+    if (nborrowed > 0) {
+        if (QUO_SUCCESS != QUO_bind_push(c->quo, QUO_BIND_PUSH_OBJ,
+                                         QUO_OBJ_MACHINE, -1)) return 1;
+        if (QUO_ERR_POP != QUO_borrow_return(c->quo)) return 1;
+        if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_borrow_return(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+    if (lender && QUO_SUCCESS != QUO_lend_reclaim(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_node_allreduce(c->quo, &nborrowed, &total, 1,
+                                          QUO_INT, QUO_SUM)) return 1;
+    if (total != nqids / 2) return 1;
+    return 0;
+}
+
+static int
+qcomm_by_type(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    const QUO_obj_type_t types[] = {
+        QUO_OBJ_NUMANODE, QUO_OBJ_SOCKET, QUO_OBJ_CORE, QUO_OBJ_L3CACHE
+    };
+    const int ntypes = sizeof(types) / sizeof(types[0]);
+    MPI_Comm first[sizeof(types) / sizeof(types[0])];
+    // The first split isn't timed.
+    for (int t = 0; t < ntypes; ++t) {
+        if (QUO_SUCCESS != QUO_get_mpi_comm_by_type(c->quo, types[t],
+                                                    &first[t])) return 1;
+        // Only processes inside of a single object get a communicator:
+        // unbound processes and those that span objects get MPI_COMM_NULL.
+        int touched = 0;
+        if (nobjs_touched(c, types[t], &touched)) return 1;
+        if ((1 == touched) != (MPI_COMM_NULL != first[t])) return 1;
+    }
+    for (int i = 0; i < n_trials; ++i) {
+        const int t = i % ntypes;
+        MPI_Comm comm = MPI_COMM_NULL;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_get_mpi_comm_by_type(c->quo, types[t],
+                                                    &comm)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        // Same processes every time.
+        if ((MPI_COMM_NULL == comm) != (MPI_COMM_NULL == first[t])) return 1;
+        if (MPI_COMM_NULL == comm) continue;
+        int result = MPI_UNEQUAL;
+        MPI_Comm_compare(comm, first[t], &result);
+        MPI_Comm_free(&comm);
+        if (MPI_CONGRUENT != result) return 1;
+    }
+    for (int t = 0; t < ntypes; ++t) {
+        if (MPI_COMM_NULL != first[t]) MPI_Comm_free(&first[t]);
+    }
+    return 0;
+}
+
+static int
+qleader_comm_by_type(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    const QUO_obj_type_t types[] = {
+        QUO_OBJ_MACHINE, QUO_OBJ_NUMANODE, QUO_OBJ_SOCKET
+    };
+    const QUO_leader_policy_t policies[] = {
+        QUO_LEADER_LOWEST_QID, QUO_LEADER_NIC_CLOSEST
+    };
+    const int ntypes = sizeof(types) / sizeof(types[0]);
+    // The last round is run with everyone bound to the whole machine, so on
+    // machines with more than one of an object everyone spans them.
+    const int n_rounds = n_trials + 2 * ntypes;
+    for (int i = 0; i < n_rounds; ++i) {
+        const int t = i % ntypes;
+        const QUO_leader_policy_t p = policies[(i / ntypes) % 2];
+        MPI_Comm comm = MPI_COMM_NULL, leaders = MPI_COMM_NULL;
+        if (n_trials == i) {
+            if (QUO_SUCCESS != QUO_bind_push(c->quo, QUO_BIND_PUSH_OBJ,
+                                             QUO_OBJ_MACHINE, -1)) return 1;
+        }
+        if (QUO_SUCCESS != QUO_get_mpi_comm_by_type(c->quo, types[t],
+                                                    &comm)) return 1;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_get_mpi_leader_comm_by_type(
+                               c->quo, types[t], p, &leaders)) return 1;
+        double end = MPI_Wtime();
+        if (i < n_trials) res[i] = end - start;
+        // Exactly one leader per object. Those that don't fit in a single
+        // object lead themselves.
+        int leader = (MPI_COMM_NULL != leaders), nleaders = leader;
+        if (MPI_COMM_NULL != comm) {
+            MPI_Allreduce(&leader, &nleaders, 1, MPI_INT, MPI_SUM, comm);
+            MPI_Comm_free(&comm);
+        }
+        if (MPI_COMM_NULL != leaders) MPI_Comm_free(&leaders);
+        if (1 != nleaders) return 1;
+    }
+    if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    return 0;
+}
+
+static int
+qborrow_comm(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    MPI_Comm first = MPI_COMM_NULL, old = MPI_COMM_NULL;
+    if (QUO_SUCCESS != QUO_borrow_mpi_comm_by_type(c->quo, QUO_OBJ_NUMANODE,
+                                                   &first)) return 1;
+    for (int i = 0; i < n_trials; ++i) {
+        MPI_Comm comm = MPI_COMM_NULL;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_borrow_mpi_comm_by_type(c->quo, QUO_OBJ_NUMANODE,
+                                                       &comm)) return 1;
+        if (QUO_SUCCESS != QUO_return_mpi_comm(c->quo, &comm)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        // No new communicators until a binding changes.
+        if (MPI_COMM_NULL != comm) return 1;
+        if (QUO_SUCCESS != QUO_borrow_mpi_comm_by_type(c->quo, QUO_OBJ_NUMANODE,
+                                                       &comm)) return 1;
+        if (comm != first) return 1;
+        if (QUO_SUCCESS != QUO_return_mpi_comm(c->quo, &comm)) return 1;
+    }
+    // Change bindings while still borrowing: what we have keeps working.
+    // Nobody may still be looking at the old bindings, though.
+    if (QUO_SUCCESS != QUO_barrier(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_bind_push(c->quo, QUO_BIND_PUSH_OBJ,
+                                     QUO_OBJ_MACHINE, -1)) return 1;
+    if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    if (QUO_SUCCESS != QUO_borrow_mpi_comm_by_type(c->quo, QUO_OBJ_NUMANODE,
+                                                   &old)) return 1;
+    if (MPI_COMM_NULL != first) {
+        if (old == first) return 1;
+        if (MPI_SUCCESS != MPI_Barrier(first)) return 1;
+    }
+    if (QUO_SUCCESS != QUO_return_mpi_comm(c->quo, &first)) return 1;
+    if (QUO_SUCCESS != QUO_return_mpi_comm(c->quo, &old)) return 1;
+    // One process changing its binding between calls, without anyone
+    // waiting for it, must not leave the others behind.
+    for (int i = 0; i < 16; ++i) {
+        MPI_Comm comm = MPI_COMM_NULL;
+        if (0 == c->rank) {
+            if (QUO_SUCCESS != QUO_bind_push(c->quo, QUO_BIND_PUSH_OBJ,
+                                             QUO_OBJ_MACHINE, -1)) return 1;
+            if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+        }
+        if (QUO_SUCCESS != QUO_borrow_mpi_comm_by_type(c->quo, QUO_OBJ_NUMANODE,
+                                                       &comm)) return 1;
+        if (QUO_SUCCESS != QUO_return_mpi_comm(c->quo, &comm)) return 1;
+    }
+    // Can't give back what wasn't borrowed.
+    MPI_Comm self = MPI_COMM_SELF;
+    if (QUO_ERR_NOT_FOUND != QUO_return_mpi_comm(c->quo, &self)) return 1;
+    return 0;
+}
+
+static int
+qreorder_cart(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    // A ring of all the processes.
+    const int dims[1] = {c->nranks}, periods[1] = {1};
+    for (int i = 0; i < n_trials; ++i) {
+        MPI_Comm comm = MPI_COMM_NULL;
+        QUO_reorder_info_t info;
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_reorder_comm_cart(c->quo, 1, dims, periods,
+                                                 &comm, &info)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+        int size = 0;
+        MPI_Comm_size(comm, &size);
+        MPI_Comm_free(&comm);
+        if (size != c->nranks) return 1;
+        if (info.cross_socket_after > info.cross_socket_before) return 1;
+    }
+    // One bad neighbor list fails everyone, instead of leaving them behind.
+    const int nbr = (0 == c->rank) ? -1 : 0;
+    MPI_Comm comm = MPI_COMM_NULL;
+    if (QUO_ERR_INVLD_ARG != QUO_reorder_comm_graph(c->quo, 1, &nbr, NULL,
+                                                    &comm, NULL)) return 1;
+    if (MPI_COMM_NULL != comm) return 1;
+    return 0;
+}
+
+static int
+qquiesce(
+    context_t *c,
+    int n_trials,
+    double *res
+) {
+    for (int i = 0; i < n_trials; ++i) {
+        double start = MPI_Wtime();
+        if (QUO_SUCCESS != QUO_quiesce(c->quo, -1)) return 1;
+        double end = MPI_Wtime();
+        res[i] = end - start;
+    }
+    // Waiters parked on PU 0. Parking isn't a binding change, so cached
+    // communicators stay valid.
+    MPI_Comm before = MPI_COMM_NULL, after = MPI_COMM_NULL;
+    if (QUO_SUCCESS != QUO_borrow_mpi_comm_by_type(c->quo, QUO_OBJ_NUMANODE,
+                                                   &before)) return 1;
+    if (QUO_SUCCESS != QUO_quiesce(c->quo, 0)) return 1;
+    if (QUO_SUCCESS != QUO_borrow_mpi_comm_by_type(c->quo, QUO_OBJ_NUMANODE,
+                                                   &after)) return 1;
+    if (before != after) return 1;
+    if (QUO_SUCCESS != QUO_return_mpi_comm(c->quo, &before)) return 1;
+    if (QUO_SUCCESS != QUO_return_mpi_comm(c->quo, &after)) return 1;
+    // Waking up must not undo a rebinding that came in while parked.
+    int qid = 0, nqids = 0;
+    char *cbind = NULL;
+    const char **cbinds = NULL;
+    if (QUO_SUCCESS != QUO_id(c->quo, &qid)) return 1;
+    if (QUO_SUCCESS != QUO_nqids(c->quo, &nqids)) return 1;
+    if (QUO_SUCCESS != QUO_stringify_cbind(c->quo, &cbind)) return 1;
+    if (QUO_SUCCESS != QUO_bind_push_cpuset(c->quo, cbind)) return 1;
+    free(cbind);
+    if (NULL == (cbinds = calloc(nqids, sizeof(*cbinds)))) return 1;
+    for (int i = 1; i < nqids; ++i) cbinds[i] = "0";
+    if (0 == qid && QUO_SUCCESS != QUO_rebind_node(c->quo, cbinds)) return 1;
+    free(cbinds);
+    if (QUO_SUCCESS != QUO_quiesce(c->quo, 0)) return 1;
+    if (QUO_SUCCESS != QUO_stringify_cbind(c->quo, &cbind)) return 1;
+    const int moved = (0 == strcmp(cbind, "0"));
+    free(cbind);
+    if (0 != qid && !moved) return 1;
+    if (QUO_SUCCESS != QUO_bind_pop(c->quo)) return 1;
+    return 0;
+}
+
 /**
  *
  */
@@ -391,8 +1197,42 @@ main(void)
         {context, "QUO_qids_in_type", qquids_in_type, n_trials, 0, NULL},
         {context, "QUO_bind_push",    qbind_push,     n_trials, 0, NULL},
         {context, "QUO_bind_pop",     qbind_pop,      n_trials, 0, NULL},
+        {context, "QUO_bind_push (instrumented)", qbind_push_stats,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_bind_push_cpuset", qbind_push_cpuset,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_bind_push_split", qbind_push_split,
+                                                      n_trials, 0, NULL},
         {context, "QUO_auto_distrib", qauto_distrib,  n_trials, 0, NULL},
-        {context, "QUO_barrier",      qbarrier,       n_trials, 0, NULL}
+        {context, "QUO_auto_distrib (rebound)", qauto_distrib_rebound,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_auto_distrib_weighted", qauto_distrib_weighted,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_auto_distrib_assign (bind push)", qauto_distrib_assign,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_global_place", qglobal_place, n_trials, 0, NULL},
+        {context, "QUO_policy_distrib", qpolicy_distrib, n_trials, 0, NULL},
+        {context, "QUO_plan_enter",   qplan_enter,    n_trials, 0, NULL},
+        {context, "QUO_rebind_poll",  qrebind_poll,   n_trials, 0, NULL},
+        {context, "QUO_barrier",      qbarrier,       n_trials, 0, NULL},
+        {context, "QUO_barrier_arrive/wait", qbarrier_split,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_quiesce",      qquiesce,       n_trials, 0, NULL},
+        {context, "QUO_subset_create/free", qsubset_create,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_subset_barrier", qsubset_barrier, n_trials, 0, NULL},
+        {context, "QUO_lock_acquire/release", qlock,  n_trials, 0, NULL},
+        {context, "QUO_sem_wait/post", qsem,          n_trials, 0, NULL},
+        {context, "QUO_counter_fetch_add", qcounter,  n_trials, 0, NULL},
+        {context, "QUO_workq_next",   qworkq,         n_trials, 0, NULL},
+        {context, "QUO_borrow/return", qborrow,       n_trials, 0, NULL},
+        {context, "QUO_get_mpi_comm_by_type", qcomm_by_type,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_get_mpi_leader_comm_by_type", qleader_comm_by_type,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_borrow/return_mpi_comm", qborrow_comm,
+                                                      n_trials, 0, NULL},
+        {context, "QUO_reorder_comm_cart", qreorder_cart, n_trials, 0, NULL}
     };
 
     for (unsigned i = 0; i < sizeof(experiments)/sizeof(experiment_t); ++i) {
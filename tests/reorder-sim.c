@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+#include "quo.h"
+#include "quo-reorder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+ * Evaluates topology-aware rank reordering against synthetic node graphs and
+ * checks the resulting traffic between sockets.
+ */
+
+#define N 8
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+add_edge(int64_t *w,
+         int i,
+         int j,
+         int64_t weight)
+{
+    w[i * N + j] += weight;
+    w[j * N + i] += weight;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check(const char *name,
+      const int64_t *w,
+      const int *sockets,
+      const int *l3s,
+      int64_t expected_before,
+      int64_t expected_after)
+{
+    int rc = 0, owner[N], taken[N] = {0};
+    int64_t before = 0, after = 0;
+
+    if (QUO_SUCCESS != quo_reorder_assign(N, w, sockets, l3s, owner,
+                                          &before, &after)) {
+        fprintf(stderr, "%s: reordering failed\n", name);
+        return 1;
+    }
+    printf("%-28s cross-socket %lld -> %lld:", name,
+           (long long)before, (long long)after);
+    for (int i = 0; i < N; ++i) printf(" %d", owner[i]);
+    printf("\n");
+    for (int i = 0; i < N; ++i) {
+        if (owner[i] < 0 || owner[i] >= N || taken[owner[i]]++) {
+            fprintf(stderr, "%s: not a permutation\n", name);
+            rc = 1;
+        }
+    }
+    if (before != expected_before || after != expected_after) {
+        fprintf(stderr, "%s: expected %lld -> %lld\n", name,
+                (long long)expected_before, (long long)expected_after);
+        rc = 1;
+    }
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(void)
+{
+    int nerrs = 0;
+    /* round-robin over 2 sockets, 2 L3s per socket */
+    const int rr_sockets[N] = {0, 1, 0, 1, 0, 1, 0, 1};
+    const int rr_l3s[N] = {0, 2, 1, 3, 0, 2, 1, 3};
+    /* already packed */
+    const int packed_sockets[N] = {0, 0, 0, 0, 1, 1, 1, 1};
+    const int packed_l3s[N] = {0, 0, 1, 1, 2, 2, 3, 3};
+    /* half of the processes aren't bound to a single socket or L3 */
+    const int half_sockets[N] = {-1, -1, -1, -1, 0, 0, 0, 0};
+    const int half_l3s[N] = {-1, -1, -1, -1, 0, 0, 1, 1};
+    int64_t chain[N * N] = {0}, heavy[N * N] = {0}, none[N * N] = {0};
+
+    /* 1D stencil: every subdomain talks to the next one */
+    for (int i = 0; i + 1 < N; ++i) add_edge(chain, i, i + 1, 1);
+    /* pairs that talk a lot, far apart in rank order */
+    for (int i = 0; i < N / 2; ++i) add_edge(heavy, i, i + N / 2, 10);
+    add_edge(heavy, 0, 1, 1);
+
+    printf("### Starting rank reordering tests...\n");
+    nerrs += check("chain, round-robin", chain, rr_sockets, rr_l3s, 7, 1);
+    nerrs += check("chain, packed", chain, packed_sockets, packed_l3s, 1, 1);
+    nerrs += check("heavy pairs, packed", heavy, packed_sockets, packed_l3s,
+                   40, 0);
+    nerrs += check("heavy pairs, half unbound", heavy, half_sockets,
+                   half_l3s, 41, 20);
+    nerrs += check("no traffic", none, rr_sockets, rr_l3s, 0, 0);
+    {
+        /* nothing to gain, so nothing moves */
+        int owner[N];
+        if (QUO_SUCCESS != quo_reorder_assign(N, none, rr_sockets, rr_l3s,
+                                              owner, NULL, NULL)) nerrs++;
+        for (int i = 0; i < N; ++i) {
+            if (owner[i] != i) {
+                fprintf(stderr, "no traffic: subdomain %d moved\n", i);
+                nerrs++;
+            }
+        }
+    }
+    if (nerrs) {
+        fprintf(stderr, "### rank reordering tests FAILED\n");
+        return EXIT_FAILURE;
+    }
+    printf("### rank reordering tests PASSED\n");
+    return EXIT_SUCCESS;
+}
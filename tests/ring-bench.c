@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+#include "quo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sched.h>
+
+#include "mpi.h"
+
+/**
+ * Checks node-local ring buffers and compares their throughput against MPI
+ * point-to-point messages over the node communicator.
+ */
+
+#define N_MSGS 100000
+#define RING_CAPACITY 1024
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Moves N_MSGS messages per producer through the ring in batches. Every
+ * message carries its producer's QID and its position in that producer's
+ * stream, and the consumer checks that every stream arrives complete and in
+ * order.
+ */
+static int
+pump(QUO_ring ring,
+     int qid,
+     int nqids,
+     int producer,
+     int consumer,
+     int batch)
+{
+    int nerrs = 0;
+    const int nproducers = (QUO_RING_ANY_PRODUCER == producer) ? nqids : 1;
+    const int iproduce = (QUO_RING_ANY_PRODUCER == producer || qid == producer);
+    const int iconsume = (qid == consumer);
+    int64_t sent = iproduce ? 0 : N_MSGS;
+    int64_t recvd = iconsume ? 0 : (int64_t)N_MSGS * nproducers;
+    uint64_t *out = calloc(batch, sizeof(*out));
+    uint64_t *in = calloc(batch, sizeof(*in));
+    int64_t *next = calloc(nqids, sizeof(*next));
+    if (!out || !in || !next) return 1;
+
+    while (sent < N_MSGS || recvd < (int64_t)N_MSGS * nproducers) {
+        if (sent < N_MSGS) {
+            int n = (N_MSGS - sent < batch) ? (int)(N_MSGS - sent) : batch;
+            for (int i = 0; i < n; ++i) {
+                out[i] = ((uint64_t)qid << 32) | (uint64_t)(sent + i);
+            }
+            if (QUO_SUCCESS != QUO_ring_enqueue(ring, out, n, &n)) return 1;
+            sent += n;
+            // Full: let the consumer run.
+            if (0 == n && !iconsume) sched_yield();
+        }
+        if (recvd < (int64_t)N_MSGS * nproducers) {
+            int n = 0, rc = QUO_SUCCESS;
+            // Don't sleep on a ring that only we can fill.
+            if (iproduce && sent < N_MSGS) {
+                rc = QUO_ring_dequeue(ring, in, batch, &n);
+            }
+            else {
+                rc = QUO_ring_dequeue_wait(ring, in, batch, &n);
+            }
+            if (QUO_SUCCESS != rc) return 1;
+            for (int i = 0; i < n; ++i) {
+                const int from = (int)(in[i] >> 32);
+                if (from < 0 || from >= nqids ||
+                    (int64_t)(in[i] & 0xffffffffu) != next[from]++) nerrs++;
+            }
+            recvd += n;
+        }
+    }
+    free(out); free(in); free(next);
+    return nerrs;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+bench_ring(QUO_context q,
+           int qid,
+           int nqids,
+           int producer,
+           int batch)
+{
+    QUO_ring ring = NULL;
+    const int consumer = nqids - 1;
+    if (QUO_SUCCESS != QUO_ring_create(q, producer, consumer, sizeof(uint64_t),
+                                       RING_CAPACITY, &ring)) return 1;
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    int nerrs = pump(ring, qid, nqids, producer, consumer, batch);
+    double t = MPI_Wtime() - start;
+    if (nerrs) {
+        fprintf(stderr, "qid %d: %d bad messages\n", qid, nerrs);
+    }
+    if (qid == consumer) {
+        const int nproducers = (QUO_RING_ANY_PRODUCER == producer) ? nqids : 1;
+        printf("%s ring, batch %3d: %8.3f Mmsg/s\n",
+               (QUO_RING_ANY_PRODUCER == producer) ? "MPSC" : "SPSC", batch,
+               (double)N_MSGS * nproducers / t / 1e6);
+    }
+    if (QUO_SUCCESS != QUO_ring_free(ring)) return 1;
+    return nerrs;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+bench_mpi(MPI_Comm node_comm,
+          int qid,
+          int nqids,
+          int batch)
+{
+    const int producer = 0, consumer = nqids - 1;
+    uint64_t *buf = calloc(batch, sizeof(*buf));
+    if (!buf) return 1;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    for (int sent = 0; sent < N_MSGS; sent += batch) {
+        const int n = (N_MSGS - sent < batch) ? N_MSGS - sent : batch;
+        if (qid == producer) {
+            if (MPI_SUCCESS != MPI_Send(buf, n, MPI_UINT64_T, consumer, 0,
+                                        node_comm)) return 1;
+        }
+        else if (qid == consumer) {
+            if (MPI_SUCCESS != MPI_Recv(buf, n, MPI_UINT64_T, producer, 0,
+                                        node_comm, MPI_STATUS_IGNORE)) {
+                return 1;
+            }
+        }
+    }
+    double t = MPI_Wtime() - start;
+    if (qid == consumer) {
+        printf("MPI_Send/Recv, batch %3d: %8.3f Mmsg/s\n", batch,
+               (double)N_MSGS / t / 1e6);
+    }
+    free(buf);
+    return 0;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(void)
+{
+    int nerrs = 0, qid = 0, nqids = 0;
+    QUO_context q = NULL;
+    MPI_Comm node_comm = MPI_COMM_NULL;
+    const int batches[] = {1, 32};
+    const int nbatches = sizeof(batches) / sizeof(batches[0]);
+
+    if (MPI_SUCCESS != MPI_Init(NULL, NULL)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_create(&q, MPI_COMM_WORLD)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_id(q, &qid)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_nqids(q, &nqids)) return EXIT_FAILURE;
+    if (QUO_SUCCESS != QUO_get_mpi_comm_by_type(q, QUO_OBJ_MACHINE,
+                                                &node_comm)) {
+        return EXIT_FAILURE;
+    }
+    if (0 == qid) printf("### Starting ring buffer tests...\n");
+    for (int i = 0; i < nbatches; ++i) {
+        nerrs += bench_ring(q, qid, nqids, 0, batches[i]);
+        nerrs += bench_ring(q, qid, nqids, QUO_RING_ANY_PRODUCER, batches[i]);
+        if (nqids > 1) nerrs += bench_mpi(node_comm, qid, nqids, batches[i]);
+    }
+    int tot = 0;
+    MPI_Allreduce(&nerrs, &tot, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Comm_free(&node_comm);
+    QUO_free(q);
+    MPI_Finalize();
+    if (tot) {
+        if (0 == qid) fprintf(stderr, "### ring buffer tests FAILED\n");
+        return EXIT_FAILURE;
+    }
+    if (0 == qid) printf("### ring buffer tests PASSED\n");
+    return EXIT_SUCCESS;
+}
@@ -17,6 +17,12 @@ main() {
     tests=(\
         './trivial':'1 2'
         './quo-time':'1 2'
+        './set-bench':'1'
+        './distrib-sim':'1'
+        './policy-sim':'1'
+        './node-coll':'1 2'
+        './ring-bench':'1 2'
+        './reorder-sim':'1'
     )
 
     quo_tests_run "${tests[@]}"
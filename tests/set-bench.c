@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2013-2026 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the libquo project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+#include "quo.h"
+#include "quo-set.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Compares quo_set_get_k_set_intersection against the original naive
+ * all-pairs implementation: results must be identical, and we report timings.
+ */
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* The original all-pairs merge implementation (sans the sanity checks). */
+static int
+naive_k_set_intersection(int nsets,
+                         const int *set_lens,
+                         int **sets,
+                         int **res,
+                         int *res_len)
+{
+    int global_max = -1;
+    int *big_htab = NULL;
+    int ilen = 0;
+
+    *res = NULL; *res_len = 0;
+    for (int set = 0; set < nsets; ++set) {
+        for (int elem = 0; elem < set_lens[set]; ++elem) {
+            if (global_max < sets[set][elem]) global_max = sets[set][elem];
+        }
+    }
+    if (global_max < 0) return QUO_SUCCESS;
+    const size_t big_htab_size = (global_max + 1) * sizeof(*big_htab);
+    if (NULL == (big_htab = malloc(big_htab_size))) return QUO_ERR_OOR;
+    (void)memset(big_htab, -1, big_htab_size);
+    for (int seta = 0; seta < nsets; ++seta) {
+        for (int setb = 0; setb < nsets; ++setb) {
+            int i = 0, j = 0;
+            if (seta == setb) continue;
+            while (i < set_lens[seta] && j < set_lens[setb]) {
+                while (i < set_lens[seta] && sets[seta][i] < sets[setb][j]) ++i;
+                if (i == set_lens[seta]) break;
+                while (j < set_lens[setb] && sets[setb][j] < sets[seta][i]) ++j;
+                if (j == set_lens[setb]) break;
+                if (sets[seta][i] == sets[setb][j]) {
+                    if (-1 == big_htab[sets[seta][i]]) {
+                        big_htab[sets[seta][i]] = sets[seta][i];
+                        ++ilen;
+                    }
+                }
+                ++i; ++j;
+            }
+        }
+    }
+    if (ilen > 0) {
+        if (NULL == (*res = calloc(ilen, sizeof(int)))) {
+            free(big_htab);
+            return QUO_ERR_OOR;
+        }
+        for (int i = 0, j = 0; i < global_max + 1; ++i) {
+            if (-1 != big_htab[i]) (*res)[j++] = big_htab[i];
+        }
+    }
+    *res_len = ilen;
+    free(big_htab);
+    return QUO_SUCCESS;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static double
+wtime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/**
+ * Builds nsets sorted sets over [0, nvals). Every value is placed in one set
+ * and additionally, with probability pshare, in a second random set.
+ */
+static void
+build_sets(int nsets,
+           int nvals,
+           double pshare,
+           int *set_lens,
+           int **sets)
+{
+    bool *member = calloc((size_t)nsets * nvals, sizeof(bool));
+    for (int v = 0; v < nvals; ++v) {
+        member[(size_t)(v % nsets) * nvals + v] = true;
+        if ((double)rand() / RAND_MAX < pshare) {
+            member[(size_t)(rand() % nsets) * nvals + v] = true;
+        }
+    }
+    for (int s = 0; s < nsets; ++s) {
+        set_lens[s] = 0;
+        for (int v = 0; v < nvals; ++v) {
+            if (member[(size_t)s * nvals + v]) sets[s][set_lens[s]++] = v;
+        }
+    }
+    free(member);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+run_case(const char *name,
+         int nsets,
+         int nvals,
+         double pshare,
+         int n_trials)
+{
+    int rc = 0;
+    int *set_lens = calloc(nsets, sizeof(int));
+    int **sets = calloc(nsets, sizeof(int *));
+    for (int s = 0; s < nsets; ++s) sets[s] = calloc(nvals, sizeof(int));
+    build_sets(nsets, nvals, pshare, set_lens, sets);
+
+    double tnaive = 0.0, tbits = 0.0;
+    for (int t = 0; t < n_trials; ++t) {
+        int *a = NULL, alen = 0, *b = NULL, blen = 0;
+
+        double start = wtime();
+        if (QUO_SUCCESS != naive_k_set_intersection(nsets, set_lens, sets,
+                                                    &a, &alen)) rc = 1;
+        tnaive += wtime() - start;
+
+        start = wtime();
+        if (QUO_SUCCESS != quo_set_get_k_set_intersection(nsets, set_lens,
+                                                          sets, &b, &blen)) {
+            rc = 1;
+        }
+        tbits += wtime() - start;
+
+        if (alen != blen ||
+            (alen > 0 && 0 != memcmp(a, b, alen * sizeof(int)))) {
+            fprintf(stderr, "%s: results differ!\n", name);
+            rc = 1;
+        }
+        free(a);
+        free(b);
+        if (rc) break;
+    }
+    printf("%-28s nsets=%4d nvals=%4d naive=%10.3lf us bitset=%8.3lf us\n",
+           name, nsets, nvals, tnaive / n_trials * 1e6, tbits / n_trials * 1e6);
+
+    for (int s = 0; s < nsets; ++s) free(sets[s]);
+    free(sets);
+    free(set_lens);
+    return rc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+check_errors(void)
+{
+    int *res = NULL, res_len = 0;
+    int unsorted[] = {3, 1}, negative[] = {-1, 2};
+    int *sets[1] = {unsorted};
+    const int lens[1] = {2};
+
+    if (QUO_ERR_INVLD_ARG != quo_set_get_k_set_intersection(1, lens, sets,
+                                                            &res, &res_len)) {
+        return 1;
+    }
+    sets[0] = negative;
+    if (QUO_ERR_INVLD_ARG != quo_set_get_k_set_intersection(1, lens, sets,
+                                                            &res, &res_len)) {
+        return 1;
+    }
+    return 0;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(void)
+{
+    int nerrs = 0;
+    static const int n_trials = 20;
+
+    srand(42);
+    printf("### Starting k-set intersection tests...\n");
+    nerrs += check_errors();
+    nerrs += run_case("disjoint", 64, 64, 0.0, n_trials);
+    nerrs += run_case("few shared", 64, 256, 0.05, n_trials);
+    nerrs += run_case("many shared", 64, 256, 0.5, n_trials);
+    nerrs += run_case("disjoint (PUs x ranks)", 256, 256, 0.0, n_trials);
+    nerrs += run_case("few shared (PUs x ranks)", 256, 512, 0.05, n_trials);
+    nerrs += run_case("all shared (PUs x ranks)", 256, 512, 1.0, n_trials);
+
+    if (nerrs) {
+        fprintf(stderr, "### k-set intersection tests FAILED\n");
+        return EXIT_FAILURE;
+    }
+    printf("### k-set intersection tests PASSED\n");
+    return EXIT_SUCCESS;
+}